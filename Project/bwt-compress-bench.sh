@@ -0,0 +1,73 @@
+#!/bin/sh
+
+# Time the stages of fastq-compress and fastq-decompress on synthetic
+# Fastq files and write one CSV line per size, mode and stage to stdout.
+# The sizes, the modes and the options of the generator can be set by
+# the environment, e.g.
+#   SIZES="10M 100M" MODES="default none" GENERATE="-e 0.01" make bench
+
+set -e
+
+SIZES=${SIZES-"10M 100M 1G 10G"}
+MODES=${MODES-"default none full binned"}
+GENERATE=${GENERATE-""}
+THREADS=${THREADS-`getconf _NPROCESSORS_ONLN`}
+
+INPUT=`mktemp TMP.XXXXXX` || exit 1
+ARCHIVE=`mktemp TMP.XXXXXX` || exit 1
+STATS=`mktemp TMP.XXXXXX` || exit 1
+trap 'rm -f ${INPUT} ${INPUT}.out ${ARCHIVE} ${STATS}' 0
+
+# the time in seconds with nanoseconds
+now()
+{
+  date +%s.%N
+}
+
+# a CSV line for a whole program: prefix, stage, seconds, bytes, peak rss
+# and size of the archive
+total()
+{
+  echo "$1 $2 $3 $4 $5 $6" | awk '{printf "%s,%s,1,%.6f,%d,%.3f,,%s,%d\n",
+    $1, $2, $3, $4, ($3 > 0 ? $4 / ($3 * 1000000) : 0),
+    (NF == 6 ? $5 : ""), $NF}'
+}
+
+echo "size,inputbytes,mode,threads,stage,calls,seconds,bytes,mbps,allocated,peakrss,archivebytes"
+for size in ${SIZES}
+do
+  ./fastq-generate.x -s ${size} ${GENERATE} -o ${INPUT}
+  inputbytes=`wc -c < ${INPUT} | tr -d ' '`
+  for mode in ${MODES}
+  do
+    case ${mode} in
+      default) options="" ;;
+      none)    options="-V none" ;;
+      full)    options="-V full" ;;
+      binned)  options="-Q illumina8" ;;
+      *)       echo "$0: unknown mode ${mode}" >&2; exit 1 ;;
+    esac
+    ./fastq-compress.x -t ${THREADS} ${options} --stats=${STATS} \
+                       -o ${ARCHIVE} ${INPUT}
+    archivebytes=`wc -c < ${ARCHIVE} | tr -d ' '`
+    prefix="${size},${inputbytes},${mode},${THREADS}"
+    # runstats writes one stage per line
+    sed -n -e 's/.*"stage": "\([a-z]*\)", "calls": \([0-9]*\), "seconds": \([0-9.]*\), "bytes": \([0-9]*\), "mbps": \([0-9.]*\), "allocated": \([0-9]*\), "peakrss": \([0-9]*\).*/\1,\2,\3,\4,\5,\6,\7/p' ${STATS} |
+    while read stage
+    do
+      echo "${prefix},${stage},${archivebytes}"
+    done
+    walltime=`sed -n -e 's/.*"walltime": \([0-9.]*\).*/\1/p' ${STATS}`
+    peakrss=`sed -n -e 's/^  "peakrss": \([0-9]*\).*/\1/p' ${STATS}`
+    total "${prefix}" compress ${walltime} ${inputbytes} "${peakrss}" \
+          ${archivebytes}
+    start=`now`
+    ./fastq-decompress.x -t ${THREADS} -o ${INPUT}.out ${ARCHIVE}
+    end=`now`
+    # the binning of the quality values is lossy
+    test ${mode} = binned || cmp ${INPUT} ${INPUT}.out
+    rm -f ${INPUT}.out
+    total "${prefix}" decompress `echo "${start} ${end}" | awk '{print $2 - $1}'` \
+          ${inputbytes} "" ${archivebytes}
+  done
+done
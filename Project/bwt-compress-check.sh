@@ -2,12 +2,65 @@
 
 set -e -x
 
-export VALGRIND_OPTS="--quiet --tool=memcheck"
+# the programs run under valgrind if it is installed, set VALGRIND to the
+# empty string to run them without valgrind
+if test -z "${VALGRIND+set}"
+then
+  VALGRIND=`command -v valgrind || true`
+fi
+export VALGRIND_OPTS="--quiet --tool=memcheck --error-exitcode=1"
 
-TMPFILE=`mktemp TMP.XXXXXX` || exit 1
+ARCHIVE=`mktemp ${TMPDIR:-/tmp}/TMP.XXXXXX` || exit 1
+TMPFILE=`mktemp ${TMPDIR:-/tmp}/TMP.XXXXXX` || exit 1
+trap 'rm -f ${ARCHIVE} ${TMPFILE}' EXIT
 for filename in `ls fastq-files`
 do
-  exec `valgrind ./fastq-compress.x fastq-files/${filename} > ${TMPFILE}` 
-  #cmp -s fastq-files/${filename} ${TMPFILE}
+  case ${filename} in
+    reject_*)
+      # entries the archive can not restore exactly are rejected
+      if ${VALGRIND} ./fastq-compress.x -o ${ARCHIVE} fastq-files/${filename}
+      then
+        exit 1
+      fi
+      continue;;
+  esac
+  ${VALGRIND} ./fastq-compress.x -o ${ARCHIVE} fastq-files/${filename} > /dev/null
+  ${VALGRIND} ./fastq-decompress.x -t 2 -o ${TMPFILE} ${ARCHIVE}
+  cmp fastq-files/${filename} ${TMPFILE}
+  # the full verification does not change the archive
+  ${VALGRIND} ./fastq-compress.x -V full -o ${TMPFILE} fastq-files/${filename}
+  cmp ${ARCHIVE} ${TMPFILE}
 done
-rm -f ${TMPFILE}
+# the range of entries crosses the boundaries of the blocks
+${VALGRIND} ./fastq-compress.x -b 8K -o ${ARCHIVE} fastq-files/reads.fastq
+${VALGRIND} ./fastq-decompress.x -r 5-175 -o ${TMPFILE} ${ARCHIVE}
+sed -n 17,700p fastq-files/reads.fastq | cmp - ${TMPFILE}
+# a range past the last entry is an error
+if ${VALGRIND} ./fastq-decompress.x -r 5-332 -o ${TMPFILE} ${ARCHIVE}
+then
+  exit 1
+fi
+# an append adds the entries behind the previous index, which is skipped
+# when the archive is read as a stream
+${VALGRIND} ./fastq-compress.x -a ${ARCHIVE} fastq-files/10reads.fastq
+${VALGRIND} ./fastq-compress.x -a ${ARCHIVE} fastq-files/other10reads.fastq
+${VALGRIND} ./fastq-decompress.x -o ${TMPFILE} ${ARCHIVE}
+cat fastq-files/reads.fastq fastq-files/10reads.fastq \
+    fastq-files/other10reads.fastq | cmp - ${TMPFILE}
+cat ${ARCHIVE} | ${VALGRIND} ./fastq-decompress.x -o ${TMPFILE}
+cat fastq-files/reads.fastq fastq-files/10reads.fastq \
+    fastq-files/other10reads.fastq | cmp - ${TMPFILE}
+# an append to a binned archive requires the offset of its quality values
+${VALGRIND} ./fastq-compress.x -Q illumina8 -P 64 -o ${TMPFILE} \
+    fastq-files/70x_161nt_phred64.fastq
+if ${VALGRIND} ./fastq-compress.x -a ${TMPFILE} fastq-files/reads.fastq
+then
+  exit 1
+fi
+# an interrupted append, i.e. one without the new trailer, keeps the entries
+cp ${ARCHIVE} ${TMPFILE}
+${VALGRIND} ./fastq-compress.x -a ${TMPFILE} fastq-files/reads.fastq
+head -c `expr \`wc -c < ${TMPFILE}\` - 20` ${TMPFILE} > ${ARCHIVE}
+${VALGRIND} ./fastq-decompress.x -o ${TMPFILE} ${ARCHIVE}
+cat fastq-files/reads.fastq fastq-files/10reads.fastq \
+    fastq-files/other10reads.fastq | cmp - ${TMPFILE}
@@ -1,6 +1,3 @@
-#ifndef BWT_COMPRESS_H
-#define BWT_COMPRESS_H
-
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
@@ -8,6 +5,13 @@
 
 #include "gt-defs.h"
 #include "gt-alloc.h"
+#include "varint.h"
+#include "rle0.h"
+#include "huffman.h"
+#include "sk-sain.h"
+#include "sktimer.h"
+#include "runstats.h"
+#include "bwt-compress.h"
 
 /* The following function returns the BWT for a <sequence> of length
  <seqlength>.
@@ -24,7 +28,8 @@ GtUchar *bwt_encode(unsigned long *longest, const Uint *sa,
   unsigned long i;
   GtUchar * bwt = NULL;
 
-  bwt = gt_malloc((size_t) (seqlength + 1) * sizeof *bwt);
+  /* the decoding accesses the BWT at random */
+  bwt = gt_malloc_large((size_t) (seqlength + 1) * sizeof *bwt);
 
   for (i = 0; i <= seqlength; i++) {
     if (sa[i] > 0) {
@@ -56,8 +61,8 @@ GtUchar *bwt_decode(unsigned long seqlength, const GtUchar *bwt,
 
   occ = gt_calloc((size_t) numofchars, sizeof *occ);
   count = gt_calloc((size_t) numofchars, sizeof *count);
-  lf = gt_malloc((size_t) (seqlength + 1) * sizeof *lf);
-  rang = gt_malloc((size_t) (seqlength + 1) * sizeof *rang);
+  lf = gt_malloc_large((size_t) (seqlength + 1) * sizeof *lf);
+  rang = gt_malloc_large((size_t) (seqlength + 1) * sizeof *rang);
   sequence = gt_malloc((size_t) (seqlength + 1) * sizeof *sequence);
 
   for (i = 0; i < seqlength + 1; i++) {
@@ -89,10 +94,10 @@ GtUchar *bwt_decode(unsigned long seqlength, const GtUchar *bwt,
     }
   }
 
-  free(occ);
-  free(count);
-  free(lf);
-  free(rang);
+  gt_free(occ);
+  gt_free(count);
+  gt_free(lf);
+  gt_free(rang);
 
   return sequence;
 }
@@ -124,8 +129,8 @@ void bwt_check(const Uint *sa, const GtUchar *sequence, unsigned long seqlength,
     exit(EXIT_FAILURE);
   }
 
-  free(bwt);
-  free(bwt_seq);
+  gt_free(bwt);
+  gt_free(bwt_seq);
 }
 /* The following function computes the distribution of the length of the
  runs in the bwt for the given <sequence> of length <seqlength>.
@@ -164,7 +169,7 @@ GtUchar * mtf_alphabet(const GtUchar *sequence, unsigned long seqlength,
   alphabet = gt_realloc(alphabet,
       (size_t) ((*alphabetlength) * sizeof(*alphabet)));
 
-  free(cache);
+  gt_free(cache);
   return alphabet;
 }
 
@@ -236,7 +241,7 @@ GtUchar *mtf_encode(GtUchar * a, unsigned long *longest, const Uint *suftab,
     }
   }
 
-  free(bwt);
+  gt_free(bwt);
 
   return mft;
 }
@@ -244,10 +249,14 @@ GtUchar *mtf_encode(GtUchar * a, unsigned long *longest, const Uint *suftab,
  length <seqlength> over an alphabet of <numofchars> symbols. <longest>
  satisfying SUF[longest] = 0. The method works in-place that is the
  input (the MTF) is stored in the same memory area <codespace> as the
- output (the Bwt). */
+ output (the Bwt). The decoded sequence is returned. */
 
-GtUchar *mtf_decode(GtUchar * a, GtUchar *codespace, unsigned long longest,
-    unsigned long seqlength, unsigned long numofchars) {
+/**
+ * Replace the move-to-front code in <codespace>
+ * by the Bwt, without inverting the Bwt
+ */
+static void mtf_decode_bwt(GtUchar * a, GtUchar *codespace,
+    unsigned long longest, unsigned long seqlength, unsigned long numofchars) {
 
   unsigned long i;
 
@@ -259,7 +268,12 @@ GtUchar *mtf_decode(GtUchar * a, GtUchar *codespace, unsigned long longest,
       codespace[i] = c;
     }
   }
+}
+
+GtUchar *mtf_decode(GtUchar * a, GtUchar *codespace, unsigned long longest,
+    unsigned long seqlength, unsigned long numofchars) {
 
+  mtf_decode_bwt(a, codespace, longest, seqlength, numofchars);
   return bwt_decode(seqlength, codespace, longest, numofchars);
 }
 /* The following function checks that bwt_encode/mtf_encode and
@@ -327,9 +341,700 @@ void bwt_mtf_check(bool silent, bool verbose, const Uint *suftab,
     }
   }
 
-  free(alphabet_1);
-  free(alphabet_2);
-  free(bwt_mtf);
-  free(bwt_mtf_decoded);
+  gt_free(alphabet_1);
+  gt_free(alphabet_2);
+  gt_free(bwt_mtf);
+  gt_free(bwt_mtf_decoded);
+}
+
+#define BWT_COMPRESS_BITMAPSIZE ((UCHAR_MAX + 1) / CHAR_BIT)
+
+struct BwtContext {
+  const GtUchar * sequence;
+  unsigned long seqlength, numofchars, longest, alphabetlength;
+  const Uint * sa;
+  Uint * ownsa;      /* the suffix array if computed by the context */
+  GtUchar * bwt,
+          * alphabet,
+          * mtf;     /* without the undefined entry at row <longest> */
+};
+
+/* The following function creates a context for the <sequence> of
+ length <seqlength> over an alphabet of size <numofchars>. If <sa> is
+ not NULL, then it is the suffix array of <sequence>, which must live as
+ long as the context. Otherwise the suffix array is computed by the
+ context when it is first required. */
+
+BwtContext *bwt_context_new(const GtUchar *sequence, unsigned long seqlength,
+    unsigned long numofchars, const Uint *sa) {
+
+  BwtContext * context = gt_malloc(sizeof *context);
+
+  context->sequence = sequence;
+  context->seqlength = seqlength;
+  context->numofchars = numofchars;
+  context->longest = 0;
+  context->alphabetlength = 0;
+  context->sa = sa;
+  context->ownsa = NULL;
+  context->bwt = NULL;
+  context->alphabet = NULL;
+  context->mtf = NULL;
+  return context;
+}
+
+/* Deliver the suffix array of the sequence of <context>. */
+
+const Uint *bwt_context_sa(BwtContext *context) {
+  if (context->sa == NULL) {
+    RunstatsMark mark;
+
+    GT_SKTRACE_BEGIN("sa", context->seqlength);
+    runstats_mark(&mark);
+    context->ownsa = gt_sain_sorted_suffixes_new(context->sequence,
+        context->seqlength, context->numofchars);
+    context->sa = context->ownsa;
+    runstats_end(RUNSTATS_SA, &mark, context->seqlength);
+    GT_SKTRACE_END;
+  }
+  return context->sa;
+}
+
+/* Deliver the BWT of the sequence of <context> and store the row of
+ the longest suffix in <longest>, see bwt_encode. */
+
+const GtUchar *bwt_context_bwt(BwtContext *context, unsigned long *longest) {
+  if (context->bwt == NULL) {
+    const Uint * sa = bwt_context_sa(context);
+    RunstatsMark mark;
+
+    GT_SKTRACE_BEGIN("bwt", context->seqlength);
+    runstats_mark(&mark);
+    context->bwt = bwt_encode(&context->longest, sa, context->sequence,
+        context->seqlength);
+    runstats_end(RUNSTATS_BWT, &mark, context->seqlength);
+    GT_SKTRACE_END;
+  }
+  *longest = context->longest;
+  return context->bwt;
+}
+
+/* Deliver the characters occurring in the sequence of <context> in
+ ascending order and store their number in <alphabetlength>. */
+
+const GtUchar *bwt_context_alphabet(BwtContext *context,
+    unsigned long *alphabetlength) {
+  if (context->alphabet == NULL) {
+    context->alphabet = mtf_alphabet(context->sequence, context->seqlength,
+        context->numofchars, &context->alphabetlength);
+  }
+  *alphabetlength = context->alphabetlength;
+  return context->alphabet;
+}
+
+/* Deliver the move-to-front encoding of the BWT of the sequence of
+ <context>, starting with the alphabet as list. The undefined entry of
+ the BWT is skipped, so the encoding consists of <seqlength> ranks. */
+
+const GtUchar *bwt_context_mtf(BwtContext *context) {
+  if (context->mtf == NULL) {
+    unsigned long i, j, longest, alphabetlength;
+    const GtUchar * bwt = bwt_context_bwt(context, &longest);
+    const GtUchar * alphabet = bwt_context_alphabet(context, &alphabetlength);
+    GtUchar * a = NULL;
+    RunstatsMark mark;
+
+    GT_SKTRACE_BEGIN("mtf", context->seqlength);
+    runstats_mark(&mark);
+    a = gt_malloc((size_t) alphabetlength + 1);
+    memcpy(a, alphabet, (size_t) alphabetlength);
+    context->mtf = gt_malloc((size_t) context->seqlength + 1);
+    for (i = 0, j = 0; i <= context->seqlength; i++) {
+      if (i != longest) {
+        const GtUchar x = mtf_alphabet_position(a, alphabetlength,
+            (char) bwt[i]);
+
+        mtf_alphabet_move_to_front(a, alphabetlength, x);
+        context->mtf[j++] = x;
+      }
+    }
+    gt_free(a);
+    runstats_end(RUNSTATS_MTF, &mark, context->seqlength);
+    GT_SKTRACE_END;
+  }
+  return context->mtf;
+}
+
+/* Free the suffix array of <context>, if the context computed it. It
+ is computed again if it is required by a later stage. */
+
+void bwt_context_release_sa(BwtContext *context) {
+  gt_free(context->ownsa);
+  context->ownsa = NULL;
+  context->sa = NULL;
+}
+
+/* Free the BWT of <context>. It is computed again if it is required by
+ a later stage. */
+
+void bwt_context_release_bwt(BwtContext *context) {
+  gt_free(context->bwt);
+  context->bwt = NULL;
+}
+
+/* The following function checks that the BWT and its move-to-front
+ encoding stored in <context> are decoded to the sequence, like
+ bwt_check and bwt_mtf_check, but without computing them again. If any
+ difference occurs, the function reports this and exits with an exit
+ code different from 0. */
+
+void bwt_context_check(BwtContext *context) {
+
+  const unsigned long seqlength = context->seqlength;
+  unsigned long longest, alphabetlength;
+  const GtUchar * bwt = NULL;
+  const GtUchar * mtf = NULL;
+  const GtUchar * alphabet = NULL;
+  GtUchar * a = NULL;
+  GtUchar * codespace = NULL;
+  GtUchar * decoded = NULL;
+
+  if (seqlength == 0) {
+    return;
+  }
+  bwt = bwt_context_bwt(context, &longest);
+  decoded = bwt_decode(seqlength, bwt, longest, context->numofchars);
+  if (memcmp(context->sequence, decoded, (size_t) seqlength) != 0) {
+    fprintf(stderr, "%s: sequence decoded from the Bwt differs\n", __func__);
+    exit(EXIT_FAILURE);
+  }
+  gt_free(decoded);
+
+  /* the move-to-front decoding works in place on a copy with a gap at
+   the undefined row */
+  mtf = bwt_context_mtf(context);
+  alphabet = bwt_context_alphabet(context, &alphabetlength);
+  a = gt_malloc((size_t) alphabetlength + 1);
+  memcpy(a, alphabet, (size_t) alphabetlength);
+  codespace = gt_malloc((size_t) seqlength + 1);
+  memcpy(codespace, mtf, (size_t) longest);
+  codespace[longest] = 0;
+  memcpy(codespace + longest + 1, mtf + longest, (size_t) (seqlength
+      - longest));
+  mtf_decode_bwt(a, codespace, longest, seqlength, alphabetlength);
+  if (memcmp(codespace, bwt, (size_t) seqlength + 1) != 0) {
+    fprintf(stderr, "%s: Bwt decoded from the move-to-front code differs\n",
+        __func__);
+    exit(EXIT_FAILURE);
+  }
+  gt_free(a);
+  gt_free(codespace);
+}
+
+/* Report the size of the alphabet, the number of runs in the BWT and
+ the fraction of ranks 0 in the move-to-front encoding of the sequence
+ of <context> to <fp>. */
+
+void bwt_context_show(FILE *fp, BwtContext *context) {
+
+  const GtUchar * bwt = NULL;
+  const GtUchar * mtf = NULL;
+  unsigned long i, longest, alphabetlength, previous, numofruns = 0,
+      numofzeros = 0;
+
+  (void) bwt_context_alphabet(context, &alphabetlength);
+  if (context->seqlength == 0) {
+    return;
+  }
+  bwt = bwt_context_bwt(context, &longest);
+  mtf = bwt_context_mtf(context);
+  for (i = 0; i < context->seqlength; i++) {
+    if (mtf[i] == 0) {
+      numofzeros++;
+    }
+  }
+  for (i = 0, previous = UCHAR_MAX + 1; i <= context->seqlength; i++) {
+    if (i != longest && bwt[i] != previous) {
+      numofruns++;
+      previous = bwt[i];
+    }
+  }
+  fprintf(fp, "# BWT length %lu, alphabet %lu, runs %lu (%.2f per run), "
+      "move-to-front zeros %.2f%%\n", context->seqlength, alphabetlength,
+      numofruns, (double) context->seqlength / numofruns,
+      100.0 * numofzeros / context->seqlength);
+}
+
+/* Delete the <context> and all stages stored in it. */
+
+void bwt_context_delete(BwtContext *context) {
+  if (context == NULL) {
+    return;
+  }
+  gt_free(context->ownsa);
+  gt_free(context->bwt);
+  gt_free(context->alphabet);
+  gt_free(context->mtf);
+  gt_free(context);
+}
+
+/**
+ * Determine the rows of the BWT belonging to the suffixes starting
+ * at the <numofsamples> positions in <samples> by a single scan of
+ * the suffix array of <context>
+ */
+static unsigned long *bwt_context_rows(BwtContext *context,
+    const unsigned long *samples, unsigned long numofsamples) {
+
+  const unsigned long seqlength = context->seqlength;
+  const Uint * sa = seqlength == 0 ? NULL : bwt_context_sa(context);
+  GtBitsequence * marks = NULL;
+  unsigned long * rows = NULL;
+  unsigned long i;
+
+  /* mark the sampled positions, so that a single scan of the suffix
+   array finds their rows */
+  rows = gt_malloc((size_t) (numofsamples + 1) * sizeof *rows);
+  marks = gt_calloc((size_t) (seqlength / GT_INTWORDSIZE + 1),
+      sizeof *marks);
+  for (i = 0; i < numofsamples; i++) {
+    assert(samples[i] <= seqlength && (i == 0 || samples[i - 1] <= samples[i]));
+    marks[samples[i] >> GT_LOGWORDSIZE] |= (GtBitsequence) 1
+        << (samples[i] & (GT_INTWORDSIZE - 1));
+  }
+  for (i = 0; i <= seqlength; i++) {
+    const unsigned long suffix = seqlength == 0 ? 0 : sa[i];
+
+    if (marks[suffix >> GT_LOGWORDSIZE]
+        & ((GtBitsequence) 1 << (suffix & (GT_INTWORDSIZE - 1)))) {
+      unsigned long left = 0, right = numofsamples;
+
+      /* the first sample not smaller than <suffix>, positions may occur
+       more than once */
+      while (left < right) {
+        const unsigned long mid = left + (right - left) / 2;
+
+        if (samples[mid] < suffix) {
+          left = mid + 1;
+        } else {
+          right = mid;
+        }
+      }
+      for (/* Nothing */; left < numofsamples && samples[left] == suffix;
+          left++) {
+        rows[left] = i;
+      }
+    }
+  }
+  gt_free(marks);
+  return rows;
+}
+
+/* The following function compresses the sequence of <context> like
+ bwt_compress. It is the last stage of the pipeline: the suffix array
+ is released as soon as the BWT is computed and the BWT as soon as its
+ move-to-front encoding is computed. */
+
+GtUchar *bwt_context_compress(BwtContext *context,
+    unsigned long *codedlength) {
+
+  const unsigned long seqlength = context->seqlength;
+  const GtUchar * alphabet = NULL;
+  const GtUchar * mtf = NULL;
+  GtUchar * coded = NULL;
+  uint16_t * rle = NULL;
+  unsigned long i, pos, alphabet_length, numofsymbols, longest = 0;
+  RunstatsMark mark;
+
+  if (seqlength == 0) {
+    coded = gt_malloc((size_t) VARINT_MAXBYTES);
+    *codedlength = varint_put(coded, 0);
+    return coded;
+  }
+
+  alphabet = bwt_context_alphabet(context, &alphabet_length);
+  assert(alphabet_length <= (unsigned long) UCHAR_MAX + 1);
+
+  /* the alphabet is the initial state of the move-to-front list,
+   it is stored as a bitmap of the occurring characters */
+  coded = gt_calloc((size_t) 3 * VARINT_MAXBYTES + BWT_COMPRESS_BITMAPSIZE,
+      sizeof *coded);
+  pos = varint_put(coded, seqlength);
+  for (i = 0; i < alphabet_length; i++) {
+    coded[pos + alphabet[i] / CHAR_BIT] |= (GtUchar) (1U
+        << (alphabet[i] % CHAR_BIT));
+  }
+
+  (void) bwt_context_bwt(context, &longest);
+  bwt_context_release_sa(context);
+  mtf = bwt_context_mtf(context);
+  bwt_context_release_bwt(context);
+
+  /* the undefined entry at index <longest> is not encoded */
+  GT_SKTRACE_BEGIN("entropy", seqlength);
+  runstats_mark(&mark);
+  rle = rle0_encode(&numofsymbols, mtf, seqlength);
+
+  pos += BWT_COMPRESS_BITMAPSIZE;
+  pos += varint_put(coded + pos, longest);
+  pos += varint_put(coded + pos, numofsymbols);
+  coded = gt_realloc(coded,
+      (size_t) pos + huffman_encode_bound(numofsymbols, RLE0_NUMOFSYMBOLS));
+  pos += huffman_encode(coded + pos, rle, numofsymbols, RLE0_NUMOFSYMBOLS);
+
+  gt_free(rle);
+  runstats_end(RUNSTATS_ENTROPY, &mark, seqlength);
+  GT_SKTRACE_END;
+
+  *codedlength = pos;
+  return gt_realloc(coded, (size_t) pos);
+}
+
+/* The following function compresses the sequence of <context> like
+ bwt_compress_sampled. The rows of the samples are determined before
+ bwt_context_compress releases the suffix array. */
+
+GtUchar *bwt_context_compress_sampled(BwtContext *context,
+    unsigned long *codedlength, const unsigned long *samples,
+    unsigned long numofsamples) {
+
+  unsigned long * rows = bwt_context_rows(context, samples, numofsamples);
+  GtUchar * bwtcoded = NULL;
+  GtUchar * coded = NULL;
+  unsigned long i, pos, bwtcodedlength;
+
+  bwtcoded = bwt_context_compress(context, &bwtcodedlength);
+  coded = gt_malloc((size_t) (numofsamples + 1) * VARINT_MAXBYTES
+      + bwtcodedlength);
+  pos = varint_put(coded, numofsamples);
+  for (i = 0; i < numofsamples; i++) {
+    pos += varint_put(coded + pos, rows[i]);
+  }
+  memcpy(coded + pos, bwtcoded, (size_t) bwtcodedlength);
+  pos += bwtcodedlength;
+  gt_free(bwtcoded);
+  gt_free(rows);
+
+  *codedlength = pos;
+  return gt_realloc(coded, (size_t) pos);
+}
+
+/* The following function compresses the <sequence> of length <seqlength>
+ over an alphabet of size <numofchars>. The suffix array <sa> for
+ <sequence> is used to compute the move-to-front encoding of the BWT,
+ which is then zero-run encoded and finally Huffman encoded. The
+ returned memory area stores the code, its length is stored in
+ <codedlength>. The user is responsible to free the returned memory. */
+
+GtUchar *bwt_compress(unsigned long *codedlength, const Uint *sa,
+    const GtUchar *sequence, unsigned long seqlength,
+    unsigned long numofchars) {
+
+  BwtContext * context = bwt_context_new(sequence, seqlength, numofchars, sa);
+  GtUchar * coded = bwt_context_compress(context, codedlength);
+
+  bwt_context_delete(context);
+  return coded;
+}
+
+/**
+ * Decode the Bwt stored by bwt_compress in the <codedlength> bytes
+ * of <coded>, the row of the longest suffix is stored in <longest>.
+ * The returned memory area stores <seqlength>+1 characters, the
+ * character in row <longest> is 0. Exits if the code is corrupted.
+ */
+static GtUchar *bwt_decompress_bwt(unsigned long *seqlength,
+    unsigned long *longest, const GtUchar *coded, unsigned long codedlength) {
+
+  const GtUchar * ptr = coded;
+  const GtUchar * end = coded + codedlength;
+  GtUchar * alphabet = NULL;
+  GtUchar * codespace = NULL;
+  uint16_t * rle = NULL;
+
+  unsigned long i, alphabet_length = 0, numofsymbols;
+
+  if (!varint_get(&ptr, end, seqlength)) {
+    fprintf(stderr, "%s: corrupted sequence length\n", __func__);
+    exit(EXIT_FAILURE);
+  }
+  *longest = 0;
+  if (*seqlength == 0) {
+    return gt_calloc((size_t) 1, sizeof *codespace);
+  }
+
+  if (end - ptr < BWT_COMPRESS_BITMAPSIZE) {
+    fprintf(stderr, "%s: corrupted alphabet\n", __func__);
+    exit(EXIT_FAILURE);
+  }
+  alphabet = gt_malloc((size_t) (UCHAR_MAX + 1) * sizeof *alphabet);
+  for (i = 0; i <= UCHAR_MAX; i++) {
+    if (ptr[i / CHAR_BIT] & (1U << (i % CHAR_BIT))) {
+      alphabet[alphabet_length++] = (GtUchar) i;
+    }
+  }
+  ptr += BWT_COMPRESS_BITMAPSIZE;
+
+  if (alphabet_length == 0 || !varint_get(&ptr, end, longest)
+      || *longest > *seqlength || !varint_get(&ptr, end, &numofsymbols)
+      || numofsymbols > *seqlength) {
+    fprintf(stderr, "%s: corrupted header\n", __func__);
+    exit(EXIT_FAILURE);
+  }
+
+  rle = gt_malloc((size_t) numofsymbols * sizeof *rle);
+  codespace = gt_malloc((size_t) (*seqlength + 1) * sizeof *codespace);
+  if (!huffman_decode(rle, numofsymbols, ptr, (unsigned long) (end - ptr),
+      RLE0_NUMOFSYMBOLS)
+      || !rle0_decode(codespace, *seqlength, rle, numofsymbols)) {
+    fprintf(stderr, "%s: corrupted code\n", __func__);
+    exit(EXIT_FAILURE);
+  }
+  gt_free(rle);
+
+  for (i = 0; i < *seqlength; i++) {
+    if (codespace[i] >= alphabet_length) {
+      fprintf(stderr, "%s: corrupted move-to-front code\n", __func__);
+      exit(EXIT_FAILURE);
+    }
+  }
+  memmove(codespace + *longest + 1, codespace + *longest,
+      *seqlength - *longest);
+  codespace[*longest] = 0;
+
+  mtf_decode_bwt(alphabet, codespace, *longest, *seqlength, UCHAR_MAX + 1);
+  gt_free(alphabet);
+
+  return codespace;
+}
+
+/* The following function decodes the sequence compressed by
+ bwt_compress. The code is stored in <coded> and consists of
+ <codedlength> bytes. The length of the decoded sequence is stored
+ in <seqlength>. If the code is corrupted, then the function
+ reports this and exits with an exit code different from 0. */
+
+GtUchar *bwt_decompress(unsigned long *seqlength, const GtUchar *coded,
+    unsigned long codedlength) {
+
+  GtUchar * bwt = NULL;
+  GtUchar * sequence = NULL;
+  unsigned long longest;
+
+  bwt = bwt_decompress_bwt(seqlength, &longest, coded, codedlength);
+  if (*seqlength == 0) {
+    return bwt;
+  }
+  sequence = bwt_decode(*seqlength, bwt, longest, UCHAR_MAX + 1);
+  gt_free(bwt);
+
+  return sequence;
+}
+
+/* The following function compresses the <sequence> of length <seqlength>
+ like bwt_compress and stores in front of the code a sample of the
+ inverse suffix array: for each of the <numofsamples> positions in
+ <samples>, which are in ascending order and at most <seqlength>, the
+ row of the BWT belonging to the suffix starting at this position. The
+ user is responsible to free the returned memory. */
+
+GtUchar *bwt_compress_sampled(unsigned long *codedlength, const Uint *sa,
+    const GtUchar *sequence, unsigned long seqlength,
+    unsigned long numofchars, const unsigned long *samples,
+    unsigned long numofsamples) {
+
+  BwtContext * context = bwt_context_new(sequence, seqlength, numofchars, sa);
+  GtUchar * coded = bwt_context_compress_sampled(context, codedlength,
+      samples, numofsamples);
+
+  bwt_context_delete(context);
+  return coded;
+}
+
+/**
+ * Read the sample of the inverse suffix array in front of the
+ * code of bwt_compress_sampled, <rows> may be NULL to skip the
+ * samples. Returns the number of bytes of the samples or 0 if the
+ * code is corrupted.
+ */
+static unsigned long bwt_samples_get(unsigned long **rows,
+    unsigned long *numofsamples, const GtUchar *coded,
+    unsigned long codedlength) {
+
+  const GtUchar * ptr = coded;
+  const GtUchar * end = coded + codedlength;
+  unsigned long i, row;
+
+  if (!varint_get(&ptr, end, numofsamples)
+      || *numofsamples > codedlength) {
+    return 0;
+  }
+  if (rows != NULL) {
+    *rows = gt_malloc((size_t) (*numofsamples + 1) * sizeof **rows);
+  }
+  for (i = 0; i < *numofsamples; i++) {
+    if (!varint_get(&ptr, end, &row)) {
+      if (rows != NULL) {
+        gt_free(*rows);
+      }
+      return 0;
+    }
+    if (rows != NULL) {
+      (*rows)[i] = row;
+    }
+  }
+  return (unsigned long) (ptr - coded);
+}
+
+/* The following function decodes the sequence compressed by
+ bwt_compress_sampled, the samples are skipped. If the code is
+ corrupted, then the function reports this and exits with an exit code
+ different from 0. */
+
+GtUchar *bwt_decompress_sampled(unsigned long *seqlength,
+    const GtUchar *coded, unsigned long codedlength) {
+
+  unsigned long numofsamples;
+  const unsigned long skip = bwt_samples_get(NULL, &numofsamples, coded,
+      codedlength);
+
+  if (skip == 0) {
+    fprintf(stderr, "%s: corrupted samples\n", __func__);
+    exit(EXIT_FAILURE);
+  }
+  return bwt_decompress(seqlength, coded + skip, codedlength - skip);
+}
+
+#define BWT_INDEX_INTERVAL 64UL
+
+struct BwtIndex {
+  GtUchar * bwt,
+          code[UCHAR_MAX + 1]; /* dense code of the characters */
+  unsigned long seqlength, longest, numofsamples, alphabetsize,
+                * rows,
+                count[UCHAR_MAX + 1]; /* number of smaller characters */
+  uint32_t * occ; /* occurrences before every BWT_INDEX_INTERVAL-th row */
+};
+
+/* The following function creates an index for the code of
+ bwt_compress_sampled stored in the <codedlength> bytes of <coded>.
+ The BWT is decoded, but not inverted. Instead, the number of
+ occurrences of each character before every BWT_INDEX_INTERVAL-th row
+ is tabulated, so that the LF-mapping of a row is computed by a scan of
+ at most BWT_INDEX_INTERVAL characters. If the code is corrupted, then
+ the function reports this and exits with an exit code different
+ from 0. */
+
+BwtIndex *bwt_index_new(const GtUchar *coded, unsigned long codedlength) {
+
+  BwtIndex * index = gt_malloc(sizeof *index);
+  unsigned long i, c, skip, partialsum, numofcheckpoints;
+  unsigned long occ[UCHAR_MAX + 1] = { 0 };
+
+  skip = bwt_samples_get(&index->rows, &index->numofsamples, coded,
+      codedlength);
+  if (skip == 0) {
+    fprintf(stderr, "%s: corrupted samples\n", __func__);
+    exit(EXIT_FAILURE);
+  }
+  index->bwt = bwt_decompress_bwt(&index->seqlength, &index->longest,
+      coded + skip, codedlength - skip);
+  for (i = 0; i < index->numofsamples; i++) {
+    if (index->rows[i] > index->seqlength) {
+      fprintf(stderr, "%s: corrupted samples\n", __func__);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  for (i = 0; i <= index->seqlength; i++) {
+    if (i != index->longest) {
+      occ[index->bwt[i]]++;
+    }
+  }
+  index->alphabetsize = 0;
+  for (c = 0, partialsum = 0; c <= UCHAR_MAX; c++) {
+    index->count[c] = partialsum;
+    partialsum += occ[c];
+    index->code[c] = (GtUchar) index->alphabetsize;
+    if (occ[c] > 0) {
+      index->alphabetsize++;
+    }
+    occ[c] = 0;
+  }
+
+  numofcheckpoints = index->seqlength / BWT_INDEX_INTERVAL + 1;
+  index->occ = gt_malloc((size_t) numofcheckpoints * index->alphabetsize
+      * sizeof *index->occ + 1);
+  for (i = 0; i <= index->seqlength; i++) {
+    if (i % BWT_INDEX_INTERVAL == 0) {
+      uint32_t * checkpoint = index->occ
+          + (i / BWT_INDEX_INTERVAL) * index->alphabetsize;
+
+      for (c = 0; c < index->alphabetsize; c++) {
+        checkpoint[c] = (uint32_t) occ[c];
+      }
+    }
+    if (i != index->longest) {
+      occ[index->code[index->bwt[i]]]++;
+    }
+  }
+  return index;
+}
+
+/* Deliver the length of the sequence of <index>. */
+
+unsigned long bwt_index_seqlength(const BwtIndex *index) {
+  return index->seqlength;
+}
+
+/* Deliver the number of sampled positions of <index>. */
+
+unsigned long bwt_index_numofsamples(const BwtIndex *index) {
+  return index->numofsamples;
+}
+
+/* The following function stores in <dest> the <length> characters of
+ the sequence which end <skip> characters before the sampled position
+ with index <sample>. Starting with the row of the sample, the BWT is
+ walked backwards by the LF-mapping, so the time is proportional to
+ <skip> + <length> and independent of the length of the sequence. */
+
+void bwt_index_extract(GtUchar *dest, const BwtIndex *index,
+    unsigned long sample, unsigned long skip, unsigned long length) {
+
+  unsigned long row, step;
+
+  assert(sample < index->numofsamples);
+  row = index->rows[sample];
+  for (step = 0; step < skip + length; step++) {
+    const GtUchar c = index->bwt[row];
+    const unsigned long start = row - row % BWT_INDEX_INTERVAL;
+    unsigned long i, rank = index->occ[(row / BWT_INDEX_INTERVAL)
+        * index->alphabetsize + index->code[c]];
+
+    /* the row of the longest suffix would precede position 0 */
+    assert(row != index->longest);
+    for (i = start; i < row; i++) {
+      rank += index->bwt[i] == c;
+    }
+    if (index->longest >= start && index->longest < row
+        && index->bwt[index->longest] == c) {
+      rank--;
+    }
+    if (step >= skip) {
+      dest[skip + length - 1 - step] = c;
+    }
+    row = index->count[c] + rank;
+  }
+}
+
+/* Delete the <index>. */
+
+void bwt_index_delete(BwtIndex *index) {
+  if (index != NULL) {
+    gt_free(index->bwt);
+    gt_free(index->rows);
+    gt_free(index->occ);
+    gt_free(index);
+  }
 }
-#endif
@@ -1,6 +1,7 @@
 #ifndef BWT_COMPRESS_H
 #define BWT_COMPRESS_H
 
+#include <stdio.h>
 #include <stdbool.h>
 #include "gt-defs.h"
 
@@ -61,9 +62,9 @@ GtUchar *mtf_encode(GtUchar * a, unsigned long *longest,const Uint *suftab,
    length <seqlength> over an alphabet of <numofchars> symbols. <longest>
    satisfying SUF[longest] = 0. The method works in-place that is the
    input (the MTF) is stored in the same memory area <codespace> as the
-   output (the Bwt). */
+   output (the Bwt). The decoded sequence is returned. */
 
-void mtf_decode(GtUchar * a, GtUchar *codespace,
+GtUchar *mtf_decode(GtUchar * a, GtUchar *codespace,
                 unsigned long longest,
                 unsigned long seqlength,
                 unsigned long numofchars);
@@ -79,4 +80,184 @@ void bwt_mtf_check(bool silent,bool verbose,const Uint *suftab,
                    const GtUchar *sequence,unsigned long seqlength,
                    unsigned long numofchars);
 
+/* The class of a context which stores the stages of the pipeline for a
+   single sequence, so that each transform is computed once, no matter
+   how many of the stages encode, check and show consume it. Each stage
+   is computed from its predecessors when it is first required:
+
+     stage           bytes        required by
+     suffix array    4(n+1)       BWT, rows of the samples
+     BWT             n+1          move-to-front encoding, check, show
+     alphabet        <= 256       move-to-front encoding and decoding
+     move-to-front   n            compress, check, show
+
+   The sequence of n characters is not copied. The lifetime of the
+   stages is bounded by release calls: the suffix array is the largest
+   stage and is released as soon as the BWT and the rows of the samples
+   are computed, the BWT as soon as its move-to-front encoding is
+   computed and no check follows. bwt_context_compress does this, so
+   the check and the show of a stream must precede the compression.
+   This bounds the peak memory to the sequence, the suffix array and the
+   BWT, i.e. 6n+5 bytes, instead of the suffix array, the BWT and the
+   move-to-front encoding in flight at the same time. A released stage
+   is computed again if a later stage requires it. */
+
+typedef struct BwtContext BwtContext;
+
+/* The following function creates a context for the <sequence> of
+   length <seqlength> over an alphabet of size <numofchars>. If <sa> is
+   not NULL, then it is the suffix array of <sequence>, which must live as
+   long as the context. Otherwise the suffix array is computed by the
+   context when it is first required. */
+
+BwtContext *bwt_context_new(const GtUchar *sequence,unsigned long seqlength,
+                            unsigned long numofchars,const Uint *sa);
+
+/* Deliver the suffix array of the sequence of <context>. */
+
+const Uint *bwt_context_sa(BwtContext *context);
+
+/* Deliver the BWT of the sequence of <context> and store the row of
+   the longest suffix in <longest>, see bwt_encode. */
+
+const GtUchar *bwt_context_bwt(BwtContext *context,unsigned long *longest);
+
+/* Deliver the characters occurring in the sequence of <context> in
+   ascending order and store their number in <alphabetlength>. */
+
+const GtUchar *bwt_context_alphabet(BwtContext *context,
+                                    unsigned long *alphabetlength);
+
+/* Deliver the move-to-front encoding of the BWT of the sequence of
+   <context>, starting with the alphabet as list. The undefined entry of
+   the BWT is skipped, so the encoding consists of <seqlength> ranks. */
+
+const GtUchar *bwt_context_mtf(BwtContext *context);
+
+/* Free the suffix array of <context>, if the context computed it. It
+   is computed again if it is required by a later stage. */
+
+void bwt_context_release_sa(BwtContext *context);
+
+/* Free the BWT of <context>. It is computed again if it is required by
+   a later stage. */
+
+void bwt_context_release_bwt(BwtContext *context);
+
+/* The following function checks that the BWT and its move-to-front
+   encoding stored in <context> are decoded to the sequence, like
+   bwt_check and bwt_mtf_check, but without computing them again. If any
+   difference occurs, the function reports this and exits with an exit
+   code different from 0. */
+
+void bwt_context_check(BwtContext *context);
+
+/* Report the size of the alphabet, the number of runs in the BWT and
+   the fraction of ranks 0 in the move-to-front encoding of the sequence
+   of <context> to <fp>. */
+
+void bwt_context_show(FILE *fp,BwtContext *context);
+
+/* The following function compresses the sequence of <context> like
+   bwt_compress. It is the last stage of the pipeline: the suffix array
+   is released as soon as the BWT is computed and the BWT as soon as its
+   move-to-front encoding is computed. */
+
+GtUchar *bwt_context_compress(BwtContext *context,
+                              unsigned long *codedlength);
+
+/* The following function compresses the sequence of <context> like
+   bwt_compress_sampled. The rows of the samples are determined before
+   bwt_context_compress releases the suffix array. */
+
+GtUchar *bwt_context_compress_sampled(BwtContext *context,
+                                      unsigned long *codedlength,
+                                      const unsigned long *samples,
+                                      unsigned long numofsamples);
+
+/* Delete the <context> and all stages stored in it. */
+
+void bwt_context_delete(BwtContext *context);
+
+/* The following function compresses the <sequence> of length <seqlength>
+   over an alphabet of size <numofchars>. The suffix array <sa> for
+   <sequence> is used to compute the move-to-front encoding of the BWT,
+   which is then zero-run encoded and finally Huffman encoded. The
+   returned memory area stores the code, its length is stored in
+   <codedlength>. The user is responsible to free the returned memory. */
+
+GtUchar *bwt_compress(unsigned long *codedlength,const Uint *sa,
+                      const GtUchar *sequence,unsigned long seqlength,
+                      unsigned long numofchars);
+
+/* The following function decodes the sequence compressed by
+   bwt_compress. The code is stored in <coded> and consists of
+   <codedlength> bytes. The length of the decoded sequence is stored
+   in <seqlength>. If the code is corrupted, then the function
+   reports this and exits with an exit code different from 0. */
+
+GtUchar *bwt_decompress(unsigned long *seqlength,const GtUchar *coded,
+                        unsigned long codedlength);
+
+/* The following function compresses the <sequence> of length <seqlength>
+   like bwt_compress and stores in front of the code a sample of the
+   inverse suffix array: for each of the <numofsamples> positions in
+   <samples>, which are in ascending order and at most <seqlength>, the
+   row of the BWT belonging to the suffix starting at this position. The
+   user is responsible to free the returned memory. */
+
+GtUchar *bwt_compress_sampled(unsigned long *codedlength,const Uint *sa,
+                              const GtUchar *sequence,
+                              unsigned long seqlength,
+                              unsigned long numofchars,
+                              const unsigned long *samples,
+                              unsigned long numofsamples);
+
+/* The following function decodes the sequence compressed by
+   bwt_compress_sampled, the samples are skipped. If the code is
+   corrupted, then the function reports this and exits with an exit code
+   different from 0. */
+
+GtUchar *bwt_decompress_sampled(unsigned long *seqlength,
+                                const GtUchar *coded,
+                                unsigned long codedlength);
+
+/* The class of an index which allows to extract substrings of a
+   sequence from its BWT without decoding the whole sequence. */
+
+typedef struct BwtIndex BwtIndex;
+
+/* The following function creates an index for the code of
+   bwt_compress_sampled stored in the <codedlength> bytes of <coded>.
+   The BWT is decoded, but not inverted. Instead, the number of
+   occurrences of each character before every BWT_INDEX_INTERVAL-th row
+   is tabulated, so that the LF-mapping of a row is computed by a scan of
+   at most BWT_INDEX_INTERVAL characters. If the code is corrupted, then
+   the function reports this and exits with an exit code different
+   from 0. */
+
+BwtIndex *bwt_index_new(const GtUchar *coded,unsigned long codedlength);
+
+/* Deliver the length of the sequence of <index>. */
+
+unsigned long bwt_index_seqlength(const BwtIndex *index);
+
+/* Deliver the number of sampled positions of <index>. */
+
+unsigned long bwt_index_numofsamples(const BwtIndex *index);
+
+/* The following function stores in <dest> the <length> characters of
+   the sequence which end <skip> characters before the sampled position
+   with index <sample>. Starting with the row of the sample, the BWT is
+   walked backwards by the LF-mapping, so the time is proportional to
+   <skip> + <length> and independent of the length of the sequence. */
+
+void bwt_index_extract(GtUchar *dest,const BwtIndex *index,
+                       unsigned long sample,unsigned long skip,
+                       unsigned long length);
+
+/* Delete the <index>. */
+
+void bwt_index_delete(BwtIndex *index);
+
 #endif
@@ -17,49 +17,487 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#define GT_ALLOC_MMAP
+#endif
 #include "gt-alloc.h"
 
-void gt_free(void *ptr)
+/* Each block starts with a header, which keeps the alignment of malloc */
+typedef struct
 {
-  if (ptr != NULL)
+  size_t size;
+  unsigned int site,
+               magic;
+} GtAllocHeader;
+
+#define GT_ALLOC_HEADERSIZE 16
+/* the magic number tells how the block was allocated: by malloc or
+   mapped with a length which is a multiple of 2 MB or 1 GB */
+#define GT_ALLOC_MAGIC      0x6a6c6f63U
+#define GT_ALLOC_MAGIC2M    0x6a6c6f64U
+#define GT_ALLOC_MAGIC1G    0x6a6c6f65U
+#define GT_ALLOC_PAGE2M     (1UL << 21)
+#define GT_ALLOC_PAGE1G     (1UL << 30)
+/* the number of call sites recorded, a power of two */
+#define GT_ALLOC_MAXSITES   1024U
+#define GT_ALLOC_NOSITE     UINT_MAX
+/* the number of call sites reported if the limit is exceeded */
+#define GT_ALLOC_SHOWSITES  10UL
+
+typedef enum
+{
+  GT_ALLOC_SITEFREE,
+  GT_ALLOC_SITECLAIMED,
+  GT_ALLOC_SITEREADY
+} GtAllocSitestate;
+
+typedef struct
+{
+  const char *file;
+  int line,
+      state;
+  unsigned long calls,
+                total,
+                current,
+                peak;
+} GtAllocSite;
+
+/* the number of bytes requested and of the allocations by the current
+   thread */
+static __thread unsigned long gt_alloc_requested = 0,
+                              gt_alloc_numofcalls = 0;
+static unsigned long gt_alloc_inuse = 0,
+                     gt_alloc_maxinuse = 0,
+                     gt_alloc_maxbytes = 0;
+static bool gt_alloc_recording = false,
+            gt_alloc_usehuge = true,
+            gt_alloc_hugetlb2m = true, /* false after the first failure */
+            gt_alloc_hugetlb1g = true;
+static GtAllocSite gt_alloc_sites[GT_ALLOC_MAXSITES];
+
+static void gt_alloc_atexit(void)
+{
+  gt_alloc_show(stderr);
+}
+
+/* the environment is read before main is called */
+__attribute__((constructor))
+static void gt_alloc_init(void)
+{
+  const char *limit = getenv("GT_ALLOC_LIMIT"),
+             *hugepages = getenv("GT_ALLOC_HUGEPAGES");
+
+  if (getenv("GT_ALLOC_SUMMARY") != NULL)
+  {
+    gt_alloc_recording = true;
+    (void) atexit(gt_alloc_atexit);
+  }
+  if (limit != NULL)
+  {
+    char *end = NULL;
+    unsigned long maxbytes = strtoul(limit,&end,10);
+
+    switch (*end)
+    {
+      case 'G':
+        maxbytes <<= 10;
+        /* fall through */
+      case 'M':
+        maxbytes <<= 10;
+        /* fall through */
+      case 'K':
+        maxbytes <<= 10;
+        end++;
+        break;
+    }
+    if (end == limit || *end != '\0')
+    {
+      fprintf(stderr,"Illegal GT_ALLOC_LIMIT %s\n",limit);
+      exit(EXIT_FAILURE);
+    }
+    gt_alloc_maxbytes = maxbytes;
+  }
+  if (hugepages != NULL && strcmp(hugepages,"0") == 0)
   {
-    free(ptr);
+    gt_alloc_usehuge = false;
   }
 }
 
-void *gt_malloc(size_t size)
+/* the slot of a call site is claimed once by compare and swap, the
+   pointer to the file name identifies the call site with the line */
+static unsigned int gt_alloc_site(const char *file,int line)
 {
-  void *ptr = malloc(size);
+  unsigned int idx, probe;
 
-  if (ptr == NULL)
+  idx = (unsigned int) (((uintptr_t) file >> 4) * 31U + (unsigned int) line)
+        & (GT_ALLOC_MAXSITES - 1);
+  for (probe = 0; probe < GT_ALLOC_MAXSITES; probe++)
   {
-    fprintf(stderr,"%s(%lu) failed\n",__func__,(unsigned long) size);
-    exit(EXIT_FAILURE);
+    GtAllocSite *site = gt_alloc_sites + idx;
+    int state = __atomic_load_n(&site->state,__ATOMIC_ACQUIRE);
+
+    if (state == GT_ALLOC_SITEFREE)
+    {
+      if (__atomic_compare_exchange_n(&site->state,&state,
+                                      GT_ALLOC_SITECLAIMED,false,
+                                      __ATOMIC_ACQ_REL,__ATOMIC_ACQUIRE))
+      {
+        site->file = file;
+        site->line = line;
+        __atomic_store_n(&site->state,GT_ALLOC_SITEREADY,__ATOMIC_RELEASE);
+        return idx;
+      }
+    }
+    while (state == GT_ALLOC_SITECLAIMED)
+    {
+      state = __atomic_load_n(&site->state,__ATOMIC_ACQUIRE);
+    }
+    if (site->file == file && site->line == line)
+    {
+      return idx;
+    }
+    idx = (idx + 1) & (GT_ALLOC_MAXSITES - 1);
   }
-  return ptr;
+  return GT_ALLOC_NOSITE;
 }
 
-void *gt_calloc(size_t count,size_t size)
+static void gt_alloc_raise(unsigned long *peak,unsigned long value)
 {
-  void *ptr = calloc(count,size);
+  unsigned long previous = __atomic_load_n(peak,__ATOMIC_RELAXED);
 
-  if (ptr == NULL)
+  while (value > previous
+         && !__atomic_compare_exchange_n(peak,&previous,value,true,
+                                         __ATOMIC_RELAXED,__ATOMIC_RELAXED))
   {
-    fprintf(stderr,"%s(%lu,%lu) failed\n",__func__,(unsigned long) count,
-                                                   (unsigned long) size);
-    exit(EXIT_FAILURE);
+    /* Nothing */ ;
+  }
+}
+
+static int gt_alloc_compare_peak(const void *a,const void *b)
+{
+  const GtAllocSite *sa = *(const GtAllocSite * const *) a,
+                    *sb = *(const GtAllocSite * const *) b;
+
+  return sa->peak < sb->peak ? 1 : (sa->peak > sb->peak ? -1 : 0);
+}
+
+static void gt_alloc_show_sites(FILE *fp,unsigned long maxsites)
+{
+  const GtAllocSite *sites[GT_ALLOC_MAXSITES];
+  unsigned long idx, numofsites = 0;
+
+  for (idx = 0; idx < GT_ALLOC_MAXSITES; idx++)
+  {
+    if (__atomic_load_n(&gt_alloc_sites[idx].state,__ATOMIC_ACQUIRE)
+        == GT_ALLOC_SITEREADY)
+    {
+      sites[numofsites++] = gt_alloc_sites + idx;
+    }
+  }
+  qsort(sites,(size_t) numofsites,sizeof *sites,gt_alloc_compare_peak);
+  fprintf(fp,"# %lu bytes in use, peak %lu bytes\n",gt_alloc_current(),
+          gt_alloc_peak());
+  fprintf(fp,"# site\tcalls\ttotal\tcurrent\tpeak\n");
+  for (idx = 0; idx < numofsites && idx < maxsites; idx++)
+  {
+    fprintf(fp,"# %s:%d\t%lu\t%lu\t%lu\t%lu\n",sites[idx]->file,
+            sites[idx]->line,sites[idx]->calls,sites[idx]->total,
+            sites[idx]->current,sites[idx]->peak);
+  }
+}
+
+static void gt_alloc_fail(const char *func,const char *file,int line,
+                          unsigned long size,bool exceeded)
+{
+  if (exceeded)
+  {
+    fprintf(stderr,"%s(%lu) at %s:%d exceeds the limit of %lu bytes\n",
+            func,size,file,line,gt_alloc_maxbytes);
+  } else
+  {
+    fprintf(stderr,"%s(%lu) at %s:%d failed\n",func,size,file,line);
+  }
+  if (gt_alloc_recording)
+  {
+    gt_alloc_show_sites(stderr,GT_ALLOC_SHOWSITES);
+  } else
+  {
+    fprintf(stderr,"# %lu bytes in use, set GT_ALLOC_SUMMARY to show the "
+                   "call sites\n",gt_alloc_current());
+  }
+  exit(EXIT_FAILURE);
+}
+
+/* account the block <header> of <size> bytes, which was allocated at
+   <file>:<line> by <func> in the way given by <magic> */
+static void *gt_alloc_account(GtAllocHeader *header,size_t size,
+                              unsigned int magic,const char *func,
+                              const char *file,int line)
+{
+  unsigned long current;
+
+  if (header == NULL)
+  {
+    gt_alloc_fail(func,file,line,(unsigned long) size,false);
+  }
+  header->size = size;
+  header->magic = magic;
+  header->site = gt_alloc_recording ? gt_alloc_site(file,line)
+                                    : GT_ALLOC_NOSITE;
+  gt_alloc_requested += (unsigned long) size;
+  gt_alloc_numofcalls++;
+  current = __atomic_add_fetch(&gt_alloc_inuse,(unsigned long) size,
+                               __ATOMIC_RELAXED);
+  gt_alloc_raise(&gt_alloc_maxinuse,current);
+  if (header->site != GT_ALLOC_NOSITE)
+  {
+    GtAllocSite *site = gt_alloc_sites + header->site;
+
+    (void) __atomic_add_fetch(&site->calls,1UL,__ATOMIC_RELAXED);
+    (void) __atomic_add_fetch(&site->total,(unsigned long) size,
+                              __ATOMIC_RELAXED);
+    gt_alloc_raise(&site->peak,
+                   __atomic_add_fetch(&site->current,(unsigned long) size,
+                                      __ATOMIC_RELAXED));
   }
-  return ptr;
+  if (gt_alloc_maxbytes > 0 && current > gt_alloc_maxbytes)
+  {
+    gt_alloc_fail(func,file,line,(unsigned long) size,true);
+  }
+  return (char *) header + GT_ALLOC_HEADERSIZE;
 }
 
-void *gt_realloc(void *ptr,size_t size)
+/* remove the block of <ptr> from the accounts and deliver its header,
+   the way it was allocated is stored in <magic> */
+static GtAllocHeader *gt_alloc_release(void *ptr,unsigned int *magic,
+                                       const char *func,const char *file,
+                                       int line)
 {
-  ptr = realloc(ptr,size);
+  GtAllocHeader *header
+    = (GtAllocHeader *) ((char *) ptr - GT_ALLOC_HEADERSIZE);
 
-  if (ptr == NULL)
+  *magic = header->magic;
+  if (*magic != GT_ALLOC_MAGIC && *magic != GT_ALLOC_MAGIC2M
+      && *magic != GT_ALLOC_MAGIC1G)
   {
-    fprintf(stderr,"%s(%lu) failed\n",__func__,(unsigned long) size);
+    fprintf(stderr,"%s at %s:%d: memory was not allocated by gt_malloc, "
+                   "gt_calloc or gt_realloc or released before\n",
+            func,file,line);
     exit(EXIT_FAILURE);
   }
-  return ptr;
+  header->magic = 0;
+  (void) __atomic_sub_fetch(&gt_alloc_inuse,(unsigned long) header->size,
+                            __ATOMIC_RELAXED);
+  if (header->site != GT_ALLOC_NOSITE)
+  {
+    (void) __atomic_sub_fetch(&gt_alloc_sites[header->site].current,
+                              (unsigned long) header->size,__ATOMIC_RELAXED);
+  }
+  return header;
+}
+
+#ifdef GT_ALLOC_MMAP
+static size_t gt_alloc_roundup(size_t length,size_t pagesize)
+{
+  return (length + pagesize - 1) & ~(pagesize - 1);
+}
+
+/* map <length> bytes backed by huge pages if possible and store the
+   length of the pages in <magic>, returns NULL if the mapping fails */
+static void *gt_alloc_map(size_t length,unsigned int *magic)
+{
+  const int prot = PROT_READ | PROT_WRITE,
+            flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  size_t maplength;
+  char *ptr, *start;
+
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+  /* pages of 1 GB only if they waste at most an eighth of the length */
+  maplength = gt_alloc_roundup(length,GT_ALLOC_PAGE1G);
+  if (length >= GT_ALLOC_PAGE1G && maplength - length <= length / 8
+      && __atomic_load_n(&gt_alloc_hugetlb1g,__ATOMIC_RELAXED))
+  {
+    ptr = mmap(NULL,maplength,prot,flags | MAP_HUGETLB | (30 << MAP_HUGE_SHIFT),
+               -1,0);
+    if (ptr != MAP_FAILED)
+    {
+      *magic = GT_ALLOC_MAGIC1G;
+      return ptr;
+    }
+    __atomic_store_n(&gt_alloc_hugetlb1g,false,__ATOMIC_RELAXED);
+  }
+  maplength = gt_alloc_roundup(length,GT_ALLOC_PAGE2M);
+  if (__atomic_load_n(&gt_alloc_hugetlb2m,__ATOMIC_RELAXED))
+  {
+    ptr = mmap(NULL,maplength,prot,flags | MAP_HUGETLB | (21 << MAP_HUGE_SHIFT),
+               -1,0);
+    if (ptr != MAP_FAILED)
+    {
+      *magic = GT_ALLOC_MAGIC2M;
+      return ptr;
+    }
+    __atomic_store_n(&gt_alloc_hugetlb2m,false,__ATOMIC_RELAXED);
+  }
+#endif
+  /* transparent huge pages require a mapping aligned to 2 MB, so the
+     ends of a larger mapping are cut off */
+  maplength = gt_alloc_roundup(length,GT_ALLOC_PAGE2M);
+  ptr = mmap(NULL,maplength + GT_ALLOC_PAGE2M,prot,flags,-1,0);
+  if (ptr == MAP_FAILED)
+  {
+    return NULL;
+  }
+  start = (char *) gt_alloc_roundup((size_t) ptr,GT_ALLOC_PAGE2M);
+  if (start > ptr)
+  {
+    (void) munmap(ptr,(size_t) (start - ptr));
+  }
+  (void) munmap(start + maplength,
+                (size_t) (ptr + GT_ALLOC_PAGE2M - start));
+#ifdef MADV_HUGEPAGE
+  (void) madvise(start,maplength,MADV_HUGEPAGE);
+#endif
+  *magic = GT_ALLOC_MAGIC2M;
+  return start;
+}
+#endif
+
+/* free the block <header> allocated in the way given by <magic> */
+static void gt_alloc_unmap(GtAllocHeader *header,unsigned int magic,
+                           size_t size)
+{
+#ifdef GT_ALLOC_MMAP
+  if (magic != GT_ALLOC_MAGIC)
+  {
+    (void) munmap(header,
+                  gt_alloc_roundup(GT_ALLOC_HEADERSIZE + size,
+                                   magic == GT_ALLOC_MAGIC1G
+                                   ? GT_ALLOC_PAGE1G : GT_ALLOC_PAGE2M));
+    return;
+  }
+#endif
+  free(header);
+}
+
+unsigned long gt_alloc_thread_requested(void)
+{
+  return gt_alloc_requested;
+}
+
+unsigned long gt_alloc_thread_calls(void)
+{
+  return gt_alloc_numofcalls;
+}
+
+unsigned long gt_alloc_current(void)
+{
+  return __atomic_load_n(&gt_alloc_inuse,__ATOMIC_RELAXED);
+}
+
+unsigned long gt_alloc_peak(void)
+{
+  return __atomic_load_n(&gt_alloc_maxinuse,__ATOMIC_RELAXED);
+}
+
+void gt_alloc_limit(unsigned long limit)
+{
+  gt_alloc_maxbytes = limit;
+}
+
+void gt_alloc_hugepages(bool enable)
+{
+  gt_alloc_usehuge = enable;
+}
+
+void gt_alloc_show(FILE *fp)
+{
+  if (gt_alloc_recording)
+  {
+    gt_alloc_show_sites(fp,ULONG_MAX);
+  }
+}
+
+void gt_free_mem(void *ptr,const char *file,int line)
+{
+  if (ptr != NULL)
+  {
+    unsigned int magic;
+    GtAllocHeader *header = gt_alloc_release(ptr,&magic,"gt_free",file,line);
+
+    gt_alloc_unmap(header,magic,header->size);
+  }
+}
+
+void *gt_malloc_mem(size_t size,const char *file,int line)
+{
+  return gt_alloc_account(malloc(GT_ALLOC_HEADERSIZE + size),size,
+                          GT_ALLOC_MAGIC,"gt_malloc",file,line);
+}
+
+void *gt_calloc_mem(size_t count,size_t size,const char *file,int line)
+{
+  if (size > 0 && count > (SIZE_MAX - GT_ALLOC_HEADERSIZE) / size)
+  {
+    gt_alloc_fail("gt_calloc",file,line,ULONG_MAX,false);
+  }
+  return gt_alloc_account(calloc(1,GT_ALLOC_HEADERSIZE + count * size),
+                          count * size,GT_ALLOC_MAGIC,"gt_calloc",file,line);
+}
+
+void *gt_realloc_mem(void *ptr,size_t size,const char *file,int line)
+{
+  GtAllocHeader *header = NULL;
+  unsigned int magic = GT_ALLOC_MAGIC;
+
+  if (ptr != NULL)
+  {
+    header = (GtAllocHeader *) ((char *) ptr - GT_ALLOC_HEADERSIZE);
+    magic = header->magic;
+  }
+  /* a mapped block is copied to a new block of the same kind */
+  if (magic == GT_ALLOC_MAGIC2M || magic == GT_ALLOC_MAGIC1G)
+  {
+    void *newptr = gt_large_mem(1,size,false,file,line);
+
+    memcpy(newptr,ptr,header->size < size ? header->size : size);
+    gt_free_mem(ptr,file,line);
+    return newptr;
+  }
+  if (ptr != NULL)
+  {
+    header = gt_alloc_release(ptr,&magic,"gt_realloc",file,line);
+  }
+  return gt_alloc_account(realloc(header,GT_ALLOC_HEADERSIZE + size),size,
+                          GT_ALLOC_MAGIC,"gt_realloc",file,line);
+}
+
+void *gt_large_mem(size_t count,size_t size,bool clear,const char *file,
+                   int line)
+{
+  const char *func = clear ? "gt_calloc_large" : "gt_malloc_large";
+
+  if (size > 0 && count > (SIZE_MAX - GT_ALLOC_PAGE1G) / size)
+  {
+    gt_alloc_fail(func,file,line,ULONG_MAX,false);
+  }
+#ifdef GT_ALLOC_MMAP
+  if (count * size >= GT_ALLOC_LARGEMIN && gt_alloc_usehuge)
+  {
+    unsigned int magic;
+    void *header = gt_alloc_map(GT_ALLOC_HEADERSIZE + count * size,&magic);
+
+    /* the mapped memory is cleared */
+    if (header != NULL)
+    {
+      return gt_alloc_account(header,count * size,magic,func,file,line);
+    }
+  }
+#endif
+  return clear ? gt_calloc_mem(count,size,file,line)
+               : gt_malloc_mem(count * size,file,line);
 }
@@ -18,11 +18,71 @@
 #ifndef GT_ALLOC_H
 #define GT_ALLOC_H
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
 
-void gt_free(void *ptr);
-void *gt_malloc(size_t size);
-void *gt_calloc(size_t count,size_t size);
-void *gt_realloc(void *ptr,size_t size);
+/* The allocation functions keep account of the bytes in use and their
+   peak with atomic counters, so the memory allocated by them must be
+   released by gt_free or gt_realloc. The macros pass the call site, for
+   which the calls, the bytes in use and the peak are recorded if the
+   environment variable GT_ALLOC_SUMMARY is set; then a summary of the
+   call sites is shown on stderr at exit. If the environment variable
+   GT_ALLOC_LIMIT is set to a number of bytes with an optional suffix
+   K, M or G, an allocation exceeding it reports the call site, the
+   bytes in use and the call sites with the largest peaks, and exits. */
+
+#define gt_malloc(SIZE)       gt_malloc_mem(SIZE,__FILE__,__LINE__)
+#define gt_calloc(COUNT,SIZE) gt_calloc_mem(COUNT,SIZE,__FILE__,__LINE__)
+#define gt_realloc(PTR,SIZE)  gt_realloc_mem(PTR,SIZE,__FILE__,__LINE__)
+#define gt_free(PTR)          gt_free_mem(PTR,__FILE__,__LINE__)
+
+/* Large arrays accessed at random, e.g. suffix arrays, are mapped such
+   that they can be backed by huge pages, which reduces the misses of
+   the TLB: explicit 1 GB or 2 MB pages if the system reserved them,
+   otherwise transparent huge pages requested by madvise. If the
+   mapping fails or the array is smaller than GT_ALLOC_LARGEMIN bytes,
+   the memory is allocated by malloc. The memory is released by gt_free
+   and resized by gt_realloc. */
+
+#define GT_ALLOC_LARGEMIN     (2UL << 20)
+
+#define gt_malloc_large(SIZE) gt_large_mem(1,SIZE,false,__FILE__,__LINE__)
+#define gt_calloc_large(COUNT,SIZE)\
+        gt_large_mem(COUNT,SIZE,true,__FILE__,__LINE__)
+
+void gt_free_mem(void *ptr,const char *file,int line);
+void *gt_malloc_mem(size_t size,const char *file,int line);
+void *gt_calloc_mem(size_t count,size_t size,const char *file,int line);
+void *gt_realloc_mem(void *ptr,size_t size,const char *file,int line);
+void *gt_large_mem(size_t count,size_t size,bool clear,const char *file,
+                   int line);
+
+/* The number of bytes requested by gt_malloc, gt_calloc and gt_realloc
+   in the current thread so far */
+unsigned long gt_alloc_thread_requested(void);
+
+/* The number of calls of gt_malloc, gt_calloc and gt_realloc in the
+   current thread so far */
+unsigned long gt_alloc_thread_calls(void);
+
+/* The number of bytes allocated and not yet released */
+unsigned long gt_alloc_current(void);
+
+/* The maximum of gt_alloc_current so far */
+unsigned long gt_alloc_peak(void);
+
+/* Exit with a report if more than <limit> bytes are in use after an
+   allocation, 0 removes the limit */
+void gt_alloc_limit(unsigned long limit);
+
+/* Enable or disable the huge pages of gt_malloc_large and
+   gt_calloc_large, which are enabled unless the environment variable
+   GT_ALLOC_HUGEPAGES is 0 */
+void gt_alloc_hugepages(bool enable);
+
+/* Show the call sites, the bytes in use and the peaks on <fp>, if the
+   call sites are recorded */
+void gt_alloc_show(FILE *fp);
 
 #endif
@@ -0,0 +1,156 @@
+#include <stdlib.h>
+#include <string.h>
+#include "gt-alloc.h"
+#include "gt-arena.h"
+
+/* The chunks of an arena form a list in the order in which they are
+   used, the memory of a chunk follows its header */
+typedef struct GtArenaChunk
+{
+  struct GtArenaChunk *next;
+  size_t size,
+         used;
+} GtArenaChunk;
+
+#define GT_ARENA_ALIGNMENT  16UL
+#define GT_ARENA_ALIGN(N)   (((N) + GT_ARENA_ALIGNMENT - 1) \
+                             & ~(GT_ARENA_ALIGNMENT - 1))
+#define GT_ARENA_HEADERSIZE GT_ARENA_ALIGN(sizeof (GtArenaChunk))
+#define GT_ARENA_MEMORY(C)  ((char *) (C) + GT_ARENA_HEADERSIZE)
+
+struct GtArena
+{
+  GtArenaChunk *first,
+               *current; /* the chunks behind current are unused */
+  void *last;            /* the last allocation, which can be extended */
+  size_t chunksize;
+  GtArenaStats stats;
+};
+
+GtArena *gt_arena_new(size_t chunksize)
+{
+  GtArena *arena = gt_malloc(sizeof *arena);
+
+  arena->first = arena->current = NULL;
+  arena->last = NULL;
+  arena->chunksize = GT_ARENA_ALIGN(chunksize > 0 ? chunksize : 1UL);
+  memset(&arena->stats,0,sizeof arena->stats);
+  return arena;
+}
+
+void gt_arena_delete(GtArena *arena)
+{
+  if (arena != NULL)
+  {
+    GtArenaChunk *chunk, *next;
+
+    for (chunk = arena->first; chunk != NULL; chunk = next)
+    {
+      next = chunk->next;
+      gt_free(chunk);
+    }
+    gt_free(arena);
+  }
+}
+
+/* make the chunk following the current one, which provides at least
+   <size> bytes, the current chunk. An unused chunk is reused if it is
+   large enough, otherwise a new chunk is inserted */
+static void gt_arena_nextchunk(GtArena *arena,size_t size)
+{
+  GtArenaChunk *next = arena->current == NULL ? arena->first
+                                              : arena->current->next;
+
+  if (next == NULL || next->size < size)
+  {
+    const size_t chunksize = size > arena->chunksize ? size
+                                                     : arena->chunksize;
+    GtArenaChunk *chunk = gt_malloc(GT_ARENA_HEADERSIZE + chunksize);
+
+    chunk->size = chunksize;
+    chunk->next = next;
+    if (arena->current == NULL)
+    {
+      arena->first = chunk;
+    } else
+    {
+      arena->current->next = chunk;
+    }
+    arena->stats.numofchunks++;
+    arena->stats.reserved += (unsigned long) chunksize;
+    next = chunk;
+  }
+  next->used = 0;
+  arena->current = next;
+}
+
+void *gt_arena_alloc(GtArena *arena,size_t size)
+{
+  const size_t aligned = GT_ARENA_ALIGN(size);
+  GtArenaChunk *chunk = arena->current;
+
+  if (chunk == NULL || chunk->used + aligned > chunk->size)
+  {
+    gt_arena_nextchunk(arena,aligned);
+    chunk = arena->current;
+  }
+  arena->last = GT_ARENA_MEMORY(chunk) + chunk->used;
+  chunk->used += aligned;
+  arena->stats.allocations++;
+  arena->stats.inuse += (unsigned long) aligned;
+  if (arena->stats.inuse > arena->stats.peak)
+  {
+    arena->stats.peak = arena->stats.inuse;
+  }
+  return arena->last;
+}
+
+void *gt_arena_extend(GtArena *arena,void *ptr,size_t oldsize,
+                      size_t newsize)
+{
+  GtArenaChunk *chunk = arena->current;
+  void *newptr;
+
+  if (ptr != NULL && ptr == arena->last)
+  {
+    const size_t offset = (size_t) ((char *) ptr - GT_ARENA_MEMORY(chunk)),
+                 oldaligned = GT_ARENA_ALIGN(oldsize),
+                 newaligned = GT_ARENA_ALIGN(newsize);
+
+    if (offset + newaligned <= chunk->size)
+    {
+      chunk->used = offset + newaligned;
+      arena->stats.allocations++;
+      arena->stats.inuse += (unsigned long) newaligned;
+      arena->stats.inuse -= (unsigned long) oldaligned;
+      if (arena->stats.inuse > arena->stats.peak)
+      {
+        arena->stats.peak = arena->stats.inuse;
+      }
+      return ptr;
+    }
+  }
+  newptr = gt_arena_alloc(arena,newsize);
+  if (ptr != NULL)
+  {
+    memcpy(newptr,ptr,oldsize < newsize ? oldsize : newsize);
+  }
+  return newptr;
+}
+
+void gt_arena_reset(GtArena *arena)
+{
+  if (arena->first != NULL)
+  {
+    arena->current = arena->first;
+    arena->current->used = 0;
+  }
+  arena->last = NULL;
+  arena->stats.inuse = 0;
+  arena->stats.resets++;
+}
+
+void gt_arena_stats(const GtArena *arena,GtArenaStats *stats)
+{
+  *stats = arena->stats;
+}
@@ -0,0 +1,50 @@
+#ifndef GT_ARENA_H
+#define GT_ARENA_H
+
+#include <stddef.h>
+
+/* An arena hands out memory from chunks by incrementing a pointer. The
+   memory is not released piece by piece but all at once by
+   gt_arena_reset, which keeps the chunks for the following allocations,
+   so a loop which resets the arena in each iteration calls gt_malloc
+   only until the chunks suffice for one iteration. The chunks are
+   released by gt_arena_delete. An arena must only be used by one
+   thread. */
+
+typedef struct GtArena GtArena;
+
+typedef struct
+{
+  unsigned long numofchunks, /* the chunks allocated by gt_malloc */
+                reserved,    /* the bytes of these chunks */
+                allocations, /* the calls of gt_arena_alloc and
+                                gt_arena_extend */
+                resets,      /* the calls of gt_arena_reset */
+                inuse,       /* the bytes handed out since the last reset */
+                peak;        /* the maximum of inuse */
+} GtArenaStats;
+
+/* Create an arena whose chunks have at least <chunksize> bytes. */
+GtArena *gt_arena_new(size_t chunksize);
+
+/* Delete the <arena> with all its chunks. */
+void gt_arena_delete(GtArena *arena);
+
+/* Deliver <size> bytes of the <arena>, aligned like memory delivered by
+   malloc. */
+void *gt_arena_alloc(GtArena *arena,size_t size);
+
+/* Resize the memory <ptr> of <oldsize> bytes delivered by the <arena>
+   to <newsize> bytes and deliver the new address. The memory of the
+   last allocation is resized in place if the chunk provides the space,
+   otherwise the content is copied. <ptr> may be NULL. */
+void *gt_arena_extend(GtArena *arena,void *ptr,size_t oldsize,
+                      size_t newsize);
+
+/* Release all memory delivered by the <arena>. */
+void gt_arena_reset(GtArena *arena);
+
+/* Store the counters of the <arena> in <stats>. */
+void gt_arena_stats(const GtArena *arena,GtArenaStats *stats);
+
+#endif
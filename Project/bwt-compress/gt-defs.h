@@ -54,6 +54,12 @@ typedef uint32_t GtBitsequence;
 #define gt_assert(EXPR)  /* nothing */
 #endif
 
+/* A unit of a sequence over the alphabet {A,C,G,T} with two bits per
+   character, the first character is stored in the most significant
+   bits */
+typedef uint64_t GtTwobitencoding;
+#define GT_UNITSIN2BITENC 32
+
 typedef unsigned int Uint;
 typedef int Sint;
 
@@ -0,0 +1,361 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "gt-alloc.h"
+#include "huffman.h"
+
+#define HUFFMAN_SYMBOLBITS  9U
+#define HUFFMAN_LENGTHBITS  4U
+#define HUFFMAN_TABLESIZE   (1UL << HUFFMAN_MAXCODELENGTH)
+
+/* Store the bits of the code, most significant bit first */
+typedef struct HuffmanBitwriter {
+  GtUchar * dest;
+  unsigned long pos;
+  uint64_t bits;
+  unsigned int count;
+} HuffmanBitwriter;
+
+/* Read the bits of the code, the next bit is the most significant
+ bit of <bits> */
+typedef struct HuffmanBitreader {
+  const GtUchar * src;
+  unsigned long pos, length;
+  uint64_t bits;
+  unsigned int count;
+} HuffmanBitreader;
+
+/**
+ * Append the <numofbits> least significant
+ * bits of <value>
+ */
+static inline void huffman_bitwriter_put(HuffmanBitwriter *writer,
+    uint64_t value, unsigned int numofbits) {
+  writer->bits = (writer->bits << numofbits) | value;
+  writer->count += numofbits;
+  while (writer->count >= 8U) {
+    writer->count -= 8U;
+    writer->dest[writer->pos++] = (GtUchar) (writer->bits >> writer->count);
+  }
+}
+
+/**
+ * Write the remaining bits,
+ * padded with zeros
+ */
+static void huffman_bitwriter_flush(HuffmanBitwriter *writer) {
+  if (writer->count > 0) {
+    huffman_bitwriter_put(writer, 0, 8U - writer->count);
+  }
+}
+
+/**
+ * Make sure that at least 56 bits are available,
+ * bits behind the end of the code are zero
+ */
+static inline void huffman_bitreader_refill(HuffmanBitreader *reader) {
+  while (reader->count <= 56U) {
+    if (reader->pos < reader->length) {
+      reader->bits |= (uint64_t) reader->src[reader->pos] << (56U
+          - reader->count);
+    }
+    reader->pos++;
+    reader->count += 8U;
+  }
+}
+
+static inline unsigned long huffman_bitreader_get(HuffmanBitreader *reader,
+    unsigned int numofbits) {
+  const unsigned long value = (unsigned long) (reader->bits
+      >> (64U - numofbits));
+
+  reader->bits <<= numofbits;
+  reader->count -= numofbits;
+  huffman_bitreader_refill(reader);
+  return value;
+}
+
+/**
+ * Restore the heap property for
+ * the subtree rooted at <idx>
+ */
+static void huffman_heap_sift(unsigned long *heap, unsigned long heapsize,
+    const unsigned long *weight, unsigned long idx) {
+  while (true) {
+    unsigned long smallest = idx, left = 2 * idx + 1, right = 2 * idx + 2;
+
+    if (left < heapsize && weight[heap[left]] < weight[heap[smallest]]) {
+      smallest = left;
+    }
+    if (right < heapsize && weight[heap[right]] < weight[heap[smallest]]) {
+      smallest = right;
+    }
+    if (smallest == idx) {
+      break;
+    }
+    const unsigned long tmp = heap[idx];
+    heap[idx] = heap[smallest];
+    heap[smallest] = tmp;
+    idx = smallest;
+  }
+}
+
+/**
+ * Compute the length of the Huffman codes for the
+ * symbols with frequencies <freq>. If a code gets longer than
+ * HUFFMAN_MAXCODELENGTH, the frequencies are flattened
+ * and the codes are computed again.
+ */
+static void huffman_codelengths(unsigned int *lengths,
+    const unsigned long *freq, unsigned long alphabetsize) {
+
+  unsigned long weight[2 * HUFFMAN_MAXSYMBOLS], parent[2 * HUFFMAN_MAXSYMBOLS],
+      heap[HUFFMAN_MAXSYMBOLS];
+  unsigned int depth[2 * HUFFMAN_MAXSYMBOLS];
+  unsigned long i, numofleaves = 0;
+
+  for (i = 0; i < alphabetsize; i++) {
+    weight[i] = freq[i];
+    lengths[i] = 0;
+    if (freq[i] > 0) {
+      numofleaves++;
+    }
+  }
+  if (numofleaves == 0) {
+    return;
+  }
+  if (numofleaves == 1) {
+    for (i = 0; i < alphabetsize; i++) {
+      if (freq[i] > 0) {
+        lengths[i] = 1U;
+      }
+    }
+    return;
+  }
+
+  while (true) {
+    unsigned long heapsize = 0, nextnode = alphabetsize;
+    unsigned int maxlength = 0;
+
+    for (i = 0; i < alphabetsize; i++) {
+      if (weight[i] > 0) {
+        heap[heapsize++] = i;
+      }
+    }
+    for (i = heapsize / 2; i > 0; i--) {
+      huffman_heap_sift(heap, heapsize, weight, i - 1);
+    }
+    while (heapsize > 1) {
+      const unsigned long first = heap[0];
+      heap[0] = heap[--heapsize];
+      huffman_heap_sift(heap, heapsize, weight, 0);
+      const unsigned long second = heap[0];
+      weight[nextnode] = weight[first] + weight[second];
+      parent[first] = parent[second] = nextnode;
+      heap[0] = nextnode++;
+      huffman_heap_sift(heap, heapsize, weight, 0);
+    }
+
+    /* parents are created after their children, hence the
+       depths can be computed in one pass from the root */
+    depth[nextnode - 1] = 0;
+    for (i = nextnode - 1; i > alphabetsize; i--) {
+      depth[i - 1] = depth[parent[i - 1]] + 1U;
+    }
+    for (i = 0; i < alphabetsize; i++) {
+      if (weight[i] > 0) {
+        lengths[i] = depth[parent[i]] + 1U;
+        if (lengths[i] > maxlength) {
+          maxlength = lengths[i];
+        }
+      }
+    }
+    if (maxlength <= HUFFMAN_MAXCODELENGTH) {
+      break;
+    }
+    for (i = 0; i < alphabetsize; i++) {
+      if (weight[i] > 0) {
+        weight[i] = 1UL + (weight[i] >> 1);
+      }
+    }
+  }
+}
+
+/**
+ * Assign the canonical codes for the
+ * given code <lengths>
+ */
+static void huffman_canonicalcodes(unsigned long *codes,
+    const unsigned int *lengths, unsigned long alphabetsize) {
+
+  unsigned long count[HUFFMAN_MAXCODELENGTH + 1] = { 0 },
+      nextcode[HUFFMAN_MAXCODELENGTH + 1];
+  unsigned long i, code = 0;
+
+  for (i = 0; i < alphabetsize; i++) {
+    count[lengths[i]]++;
+  }
+  count[0] = 0;
+  for (i = 1; i <= HUFFMAN_MAXCODELENGTH; i++) {
+    code = (code + count[i - 1]) << 1;
+    nextcode[i] = code;
+  }
+  for (i = 0; i < alphabetsize; i++) {
+    if (lengths[i] > 0) {
+      codes[i] = nextcode[lengths[i]]++;
+    }
+  }
+}
+
+/* The following function returns the number of bytes which is
+ sufficient to store the Huffman code of <numofsymbols> symbols
+ over an alphabet of size <alphabetsize>. */
+
+unsigned long huffman_encode_bound(unsigned long numofsymbols,
+    unsigned long alphabetsize) {
+  const unsigned long numofblocks = (numofsymbols + HUFFMAN_BLOCKSIZE - 1)
+      / HUFFMAN_BLOCKSIZE;
+
+  return (numofsymbols * HUFFMAN_MAXCODELENGTH
+      + numofblocks * (HUFFMAN_SYMBOLBITS + alphabetsize * HUFFMAN_LENGTHBITS))
+      / 8 + 8;
+}
+
+/* The following function encodes the <numofsymbols> symbols in
+ <symbols>, each of which must be smaller than <alphabetsize>, which
+ itself must not be larger than HUFFMAN_MAXSYMBOLS. The code is written
+ to <dest> which must provide space for at least
+ huffman_encode_bound(<numofsymbols>,<alphabetsize>) bytes. The
+ function returns the number of bytes written. */
+
+unsigned long huffman_encode(GtUchar *dest, const uint16_t *symbols,
+    unsigned long numofsymbols, unsigned long alphabetsize) {
+
+  unsigned long freq[HUFFMAN_MAXSYMBOLS], codes[HUFFMAN_MAXSYMBOLS];
+  unsigned int lengths[HUFFMAN_MAXSYMBOLS];
+  unsigned long blockstart, i;
+  HuffmanBitwriter writer = { dest, 0, 0, 0 };
+
+  assert(alphabetsize <= HUFFMAN_MAXSYMBOLS);
+
+  for (blockstart = 0; blockstart < numofsymbols;
+      blockstart += HUFFMAN_BLOCKSIZE) {
+
+    const unsigned long blockend =
+        (numofsymbols - blockstart > HUFFMAN_BLOCKSIZE) ?
+            blockstart + HUFFMAN_BLOCKSIZE : numofsymbols;
+    unsigned long maxsymbol = 0;
+
+    memset(freq, 0, sizeof freq);
+    for (i = blockstart; i < blockend; i++) {
+      assert(symbols[i] < alphabetsize);
+      freq[symbols[i]]++;
+      if (symbols[i] > maxsymbol) {
+        maxsymbol = symbols[i];
+      }
+    }
+    huffman_codelengths(lengths, freq, alphabetsize);
+    huffman_canonicalcodes(codes, lengths, alphabetsize);
+
+    /* the per-block table: the largest symbol and the code length
+       of all symbols up to this symbol */
+    huffman_bitwriter_put(&writer, maxsymbol, HUFFMAN_SYMBOLBITS);
+    for (i = 0; i <= maxsymbol; i++) {
+      huffman_bitwriter_put(&writer, lengths[i], HUFFMAN_LENGTHBITS);
+    }
+    for (i = blockstart; i < blockend; i++) {
+      huffman_bitwriter_put(&writer, codes[symbols[i]], lengths[symbols[i]]);
+    }
+  }
+  huffman_bitwriter_flush(&writer);
+
+  return writer.pos;
+}
+
+/* The following function decodes <numofsymbols> symbols from the
+ <codedlength> bytes in <coded> and stores them in <symbols>. If
+ <coded> is not a valid code, then false is returned. */
+
+bool huffman_decode(uint16_t *symbols, unsigned long numofsymbols,
+    const GtUchar *coded, unsigned long codedlength,
+    unsigned long alphabetsize) {
+
+  unsigned long codes[HUFFMAN_MAXSYMBOLS];
+  unsigned int lengths[HUFFMAN_MAXSYMBOLS];
+  uint16_t * table = NULL;
+  unsigned long blockstart, i;
+  HuffmanBitreader reader = { coded, 0, codedlength, 0, 0 };
+  bool success = true;
+
+  table = gt_malloc(HUFFMAN_TABLESIZE * sizeof *table);
+  huffman_bitreader_refill(&reader);
+
+  for (blockstart = 0; success && blockstart < numofsymbols;
+      blockstart += HUFFMAN_BLOCKSIZE) {
+
+    const unsigned long blockend =
+        (numofsymbols - blockstart > HUFFMAN_BLOCKSIZE) ?
+            blockstart + HUFFMAN_BLOCKSIZE : numofsymbols;
+    const unsigned long maxsymbol = huffman_bitreader_get(&reader,
+        HUFFMAN_SYMBOLBITS);
+
+    if (maxsymbol >= alphabetsize) {
+      success = false;
+      break;
+    }
+    memset(lengths, 0, sizeof lengths);
+    for (i = 0; i <= maxsymbol; i++) {
+      lengths[i] = (unsigned int) huffman_bitreader_get(&reader,
+          HUFFMAN_LENGTHBITS);
+      if (lengths[i] > HUFFMAN_MAXCODELENGTH) {
+        success = false;
+      }
+    }
+    if (!success) {
+      break;
+    }
+    huffman_canonicalcodes(codes, lengths, maxsymbol + 1);
+
+    /* each entry stores the symbol and the length of its code,
+       entries not belonging to any code have length 0 */
+    memset(table, 0, HUFFMAN_TABLESIZE * sizeof *table);
+    for (i = 0; i <= maxsymbol; i++) {
+      if (lengths[i] > 0) {
+        const unsigned int shift = HUFFMAN_MAXCODELENGTH - lengths[i];
+        const unsigned long first = codes[i] << shift, last = (codes[i] + 1)
+            << shift;
+        unsigned long entry;
+
+        if (last > HUFFMAN_TABLESIZE) {
+          success = false;
+          break;
+        }
+        for (entry = first; entry < last; entry++) {
+          table[entry] = (uint16_t) ((i << 4) | lengths[i]);
+        }
+      }
+    }
+
+    for (i = blockstart; success && i < blockend; i++) {
+      const uint16_t entry = table[reader.bits >> (64U
+          - HUFFMAN_MAXCODELENGTH)];
+
+      if ((entry & 0xF) == 0) {
+        success = false;
+        break;
+      }
+      symbols[i] = entry >> 4;
+      reader.bits <<= entry & 0xF;
+      reader.count -= entry & 0xF;
+      if (reader.count < HUFFMAN_MAXCODELENGTH) {
+        huffman_bitreader_refill(&reader);
+      }
+    }
+  }
+
+  gt_free(table);
+  return success && reader.pos * 8 - reader.count <= codedlength * 8
+      ? true : false;
+}
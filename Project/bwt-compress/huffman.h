@@ -0,0 +1,45 @@
+#ifndef HUFFMAN_H
+#define HUFFMAN_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include "gt-defs.h"
+
+/* The symbols to be encoded are split into blocks of HUFFMAN_BLOCKSIZE
+   symbols. For each block a canonical Huffman code is computed from the
+   frequencies of the symbols in this block. The code lengths are
+   limited to HUFFMAN_MAXCODELENGTH bits, so that a symbol can be decoded
+   by a single table lookup. The code lengths of each block precede the
+   codes of the symbols of this block in the bitstream. */
+
+#define HUFFMAN_BLOCKSIZE     (1UL << 16)
+#define HUFFMAN_MAXCODELENGTH 12U
+#define HUFFMAN_MAXSYMBOLS    512UL
+
+/* The following function returns the number of bytes which is
+   sufficient to store the Huffman code of <numofsymbols> symbols
+   over an alphabet of size <alphabetsize>. */
+
+unsigned long huffman_encode_bound(unsigned long numofsymbols,
+                                   unsigned long alphabetsize);
+
+/* The following function encodes the <numofsymbols> symbols in
+   <symbols>, each of which must be smaller than <alphabetsize>, which
+   itself must not be larger than HUFFMAN_MAXSYMBOLS. The code is written
+   to <dest> which must provide space for at least
+   huffman_encode_bound(<numofsymbols>,<alphabetsize>) bytes. The
+   function returns the number of bytes written. */
+
+unsigned long huffman_encode(GtUchar *dest, const uint16_t *symbols,
+                             unsigned long numofsymbols,
+                             unsigned long alphabetsize);
+
+/* The following function decodes <numofsymbols> symbols from the
+   <codedlength> bytes in <coded> and stores them in <symbols>. If
+   <coded> is not a valid code, then false is returned. */
+
+bool huffman_decode(uint16_t *symbols, unsigned long numofsymbols,
+                    const GtUchar *coded, unsigned long codedlength,
+                    unsigned long alphabetsize);
+
+#endif
@@ -0,0 +1,418 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <limits.h>
+
+#include "gt-alloc.h"
+#include "varint.h"
+#include "qualcm.h"
+
+#define QUALCM_CONTEXTBITS   6U
+#define QUALCM_MAXCONTEXT    ((1U << QUALCM_CONTEXTBITS) - 1)
+#define QUALCM_NUMOFBUCKETS  16U
+#define QUALCM_NUMOFDELTAS   8U
+#define QUALCM_NUMOFMODELS   3U
+#define QUALCM_MAXBITS       8U
+#define QUALCM_ADAPTLIMIT    127U
+#define QUALCM_LEARNINGSHIFT 13
+#define QUALCM_BITMAPSIZE    ((UCHAR_MAX + 1) / CHAR_BIT)
+
+#define QUALCM_MIN(A,B) ((A) < (B) ? (A) : (B))
+
+/* The adaptive models and the mixer */
+typedef struct {
+  uint32_t * tables[QUALCM_NUMOFMODELS], /* probability of a 1-bit in the
+                                            upper 16 bits, number of
+                                            updates in the lower bits */
+           * rows[QUALCM_NUMOFMODELS];   /* rows for the current symbol */
+  int32_t weights[QUALCM_MAXBITS][QUALCM_NUMOFMODELS];
+  int stretched[QUALCM_NUMOFMODELS];
+  int probability;
+  unsigned int numofbits;
+} QualcmModel;
+
+/* The context of a symbol within its read */
+typedef struct {
+  unsigned long position, sum, changes;
+  unsigned int prev1, prev2;
+} QualcmContext;
+
+/* Binary arithmetic coder with 32 bit precision */
+typedef struct {
+  uint32_t low, high, code;
+  GtUchar * dest;
+  const GtUchar * src, * end;
+  unsigned long pos, allocated;
+} QualcmCoder;
+
+static int qualcm_stretchtable[4096], qualcm_squashtable[4095];
+static int qualcm_adaptrate[QUALCM_ADAPTLIMIT + 1];
+static pthread_once_t qualcm_tables_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Logistic function 4096/(1+exp(-d/256)),
+ * interpolated from 33 points
+ */
+static int qualcm_squash(int d) {
+  static const int points[33] = {
+    1, 2, 3, 6, 10, 16, 27, 45, 73, 120, 194, 310, 488, 747, 1101, 1546,
+    2047, 2549, 2994, 3348, 3607, 3785, 3901, 3975, 4022, 4050, 4068, 4079,
+    4085, 4089, 4092, 4093, 4094 };
+  int weight;
+
+  if (d > 2047) {
+    return 4095;
+  }
+  if (d < -2047) {
+    return 1;
+  }
+  weight = d & 127;
+  d = (d >> 7) + 16;
+  return (points[d] * (128 - weight) + points[d + 1] * weight + 64) >> 7;
+}
+
+/**
+ * The logistic function and its inverse are tabulated,
+ * the counters adapt with rate 1/(n+1.5) after n updates
+ */
+static void qualcm_tables_init(void) {
+  int x, idx, next = 0;
+
+  for (x = -2047; x <= 2047; x++) {
+    const int value = qualcm_squash(x);
+
+    qualcm_squashtable[x + 2047] = value;
+    for (idx = next; idx <= value; idx++) {
+      qualcm_stretchtable[idx] = x;
+    }
+    next = value + 1;
+  }
+  for (idx = next; idx < 4096; idx++) {
+    qualcm_stretchtable[idx] = 2047;
+  }
+  for (idx = 0; idx <= (int) QUALCM_ADAPTLIMIT; idx++) {
+    qualcm_adaptrate[idx] = (int) (65536.0 / (idx + 1.5));
+  }
+}
+
+static void qualcm_model_init(QualcmModel *model, unsigned int numofbits) {
+  const unsigned long sizes[QUALCM_NUMOFMODELS] = {
+      1UL << (2 * QUALCM_CONTEXTBITS),
+      (unsigned long) QUALCM_NUMOFBUCKETS << QUALCM_CONTEXTBITS,
+      (unsigned long) QUALCM_NUMOFBUCKETS * QUALCM_NUMOFDELTAS
+          << QUALCM_CONTEXTBITS };
+  unsigned long idx, m, bit;
+
+  pthread_once(&qualcm_tables_once, qualcm_tables_init);
+  model->numofbits = numofbits;
+  for (m = 0; m < QUALCM_NUMOFMODELS; m++) {
+    const unsigned long size = sizes[m] << numofbits;
+
+    model->tables[m] = gt_malloc(size * sizeof *model->tables[m]);
+    for (idx = 0; idx < size; idx++) {
+      model->tables[m][idx] = 1U << 31;
+    }
+    model->rows[m] = model->tables[m];
+  }
+  for (bit = 0; bit < QUALCM_MAXBITS; bit++) {
+    for (m = 0; m < QUALCM_NUMOFMODELS; m++) {
+      model->weights[bit][m] = (1 << 16) / 3;
+    }
+  }
+}
+
+static void qualcm_model_delete(QualcmModel *model) {
+  unsigned long m;
+
+  for (m = 0; m < QUALCM_NUMOFMODELS; m++) {
+    gt_free(model->tables[m]);
+  }
+}
+
+/**
+ * Select the rows of the models for the
+ * next symbol of a read
+ */
+static inline void qualcm_model_select(QualcmModel *model,
+    const QualcmContext *context) {
+
+  const unsigned int prev1 = QUALCM_MIN(context->prev1, QUALCM_MAXCONTEXT),
+      prev2 = QUALCM_MIN(context->prev2, QUALCM_MAXCONTEXT);
+  const unsigned long bucket = QUALCM_MIN(
+      context->position / QUALCM_POSITIONBUCKET,
+      (unsigned long) QUALCM_NUMOFBUCKETS - 1);
+  const unsigned long average = context->position == 0 ? 0 : QUALCM_MIN(
+      context->sum / context->position, (unsigned long) QUALCM_MAXCONTEXT)
+      >> (QUALCM_CONTEXTBITS - 4);
+  const unsigned long delta = QUALCM_MIN(context->changes / 2,
+      (unsigned long) QUALCM_NUMOFDELTAS - 1);
+
+  model->rows[0] = model->tables[0]
+      + ((((unsigned long) prev1 << QUALCM_CONTEXTBITS) | prev2)
+          << model->numofbits);
+  model->rows[1] = model->tables[1]
+      + (((bucket << QUALCM_CONTEXTBITS) | prev1) << model->numofbits);
+  model->rows[2] = model->tables[2]
+      + (((((average * QUALCM_NUMOFDELTAS) + delta) << QUALCM_CONTEXTBITS)
+          | prev1) << model->numofbits);
+}
+
+/**
+ * Mix the predictions for the node of
+ * the binary tree of the symbol
+ */
+static inline int qualcm_model_predict(QualcmModel *model, unsigned int bit,
+    unsigned int node) {
+
+  int64_t dot = 0;
+  unsigned long m;
+
+  for (m = 0; m < QUALCM_NUMOFMODELS; m++) {
+    model->stretched[m] = qualcm_stretchtable[model->rows[m][node] >> 20];
+    dot += (int64_t) model->weights[bit][m] * model->stretched[m];
+  }
+  dot >>= 16;
+  model->probability = dot > 2047 ? 4095 : dot < -2047 ? 1
+      : qualcm_squashtable[dot + 2047];
+  return model->probability;
+}
+
+static inline void qualcm_model_update(QualcmModel *model, unsigned int bit,
+    unsigned int node, unsigned int value) {
+
+  const int error = ((int) value << 12) - model->probability;
+  unsigned long m;
+
+  for (m = 0; m < QUALCM_NUMOFMODELS; m++) {
+    uint32_t *counter = model->rows[m] + node;
+    const uint32_t count = *counter & 0xFFFF;
+    const int probability = (int) (*counter >> 16);
+
+    model->weights[bit][m] += (model->stretched[m] * error)
+        >> QUALCM_LEARNINGSHIFT;
+    *counter = ((uint32_t) (probability
+        + (((((int) value << 16) - (int) value - probability)
+            * qualcm_adaptrate[count]) >> 16)) << 16)
+        | (count < QUALCM_ADAPTLIMIT ? count + 1 : count);
+  }
+}
+
+static inline void qualcm_context_reset(QualcmContext *context) {
+  context->position = 0;
+  context->sum = 0;
+  context->changes = 0;
+  context->prev1 = 0;
+  context->prev2 = 0;
+}
+
+static inline void qualcm_context_update(QualcmContext *context,
+    unsigned int rank) {
+  context->position++;
+  context->sum += rank;
+  if (context->position > 1 && rank != context->prev1) {
+    context->changes++;
+  }
+  context->prev2 = context->prev1;
+  context->prev1 = rank;
+}
+
+static inline void qualcm_encode_bit(QualcmCoder *coder, int probability,
+    unsigned int value) {
+
+  const uint32_t middle = coder->low
+      + ((coder->high - coder->low) >> 12) * (uint32_t) probability;
+
+  if (value) {
+    coder->high = middle;
+  } else {
+    coder->low = middle + 1;
+  }
+  while (((coder->low ^ coder->high) & 0xFF000000U) == 0) {
+    if (coder->pos == coder->allocated) {
+      coder->allocated = coder->allocated * 2 + 1024;
+      coder->dest = gt_realloc(coder->dest, (size_t) coder->allocated);
+    }
+    coder->dest[coder->pos++] = (GtUchar) (coder->high >> 24);
+    coder->low <<= 8;
+    coder->high = (coder->high << 8) | 0xFF;
+  }
+}
+
+static inline unsigned int qualcm_decode_bit(QualcmCoder *coder,
+    int probability) {
+
+  const uint32_t middle = coder->low
+      + ((coder->high - coder->low) >> 12) * (uint32_t) probability;
+  unsigned int value;
+
+  if (coder->code <= middle) {
+    coder->high = middle;
+    value = 1U;
+  } else {
+    coder->low = middle + 1;
+    value = 0;
+  }
+  while (((coder->low ^ coder->high) & 0xFF000000U) == 0) {
+    coder->low <<= 8;
+    coder->high = (coder->high << 8) | 0xFF;
+    coder->code = (coder->code << 8)
+        | (coder->src < coder->end ? *coder->src++ : 0);
+  }
+  return value;
+}
+
+/**
+ * The number of bits to
+ * represent the ranks
+ */
+static unsigned int qualcm_numofbits(unsigned long numofsymbols) {
+  unsigned int numofbits = 0;
+
+  while ((1UL << numofbits) < numofsymbols) {
+    numofbits++;
+  }
+  return numofbits;
+}
+
+/* The following function encodes the <length> quality values in
+ <qual>, which is the concatenation of the quality strings of
+ <numofreads> reads whose lengths are given by <readlengths>. The
+ code is returned and its length is stored in <codedlength>. The
+ user is responsible to free the returned memory. */
+
+GtUchar *qualcm_encode(unsigned long *codedlength, const GtUchar *qual,
+    unsigned long length, const unsigned long *readlengths,
+    unsigned long numofreads) {
+
+  GtUchar bitmap[QUALCM_BITMAPSIZE] = { 0 }, rank[UCHAR_MAX + 1];
+  unsigned long idx, read, numofsymbols = 0, pos = 0;
+  QualcmModel model;
+  QualcmContext context;
+  QualcmCoder coder;
+
+  for (idx = 0; idx < length; idx++) {
+    bitmap[qual[idx] / CHAR_BIT] |= (GtUchar) (1U << (qual[idx] % CHAR_BIT));
+  }
+  for (idx = 0; idx <= UCHAR_MAX; idx++) {
+    if (bitmap[idx / CHAR_BIT] & (1U << (idx % CHAR_BIT))) {
+      rank[idx] = (GtUchar) numofsymbols++;
+    }
+  }
+
+  coder.allocated = VARINT_MAXBYTES + QUALCM_BITMAPSIZE + length / 2 + 1024;
+  coder.dest = gt_malloc((size_t) coder.allocated);
+  coder.pos = varint_put(coder.dest, length);
+  memcpy(coder.dest + coder.pos, bitmap, QUALCM_BITMAPSIZE);
+  coder.pos += QUALCM_BITMAPSIZE;
+  coder.low = 0;
+  coder.high = 0xFFFFFFFFU;
+
+  qualcm_model_init(&model, qualcm_numofbits(numofsymbols));
+  for (read = 0; read < numofreads; read++) {
+    qualcm_context_reset(&context);
+    for (idx = 0; idx < readlengths[read]; idx++, pos++) {
+      const unsigned int value = rank[qual[pos]];
+      unsigned int bit, node = 1U;
+
+      assert(pos < length);
+      qualcm_model_select(&model, &context);
+      for (bit = model.numofbits; bit > 0; bit--) {
+        const unsigned int b = (value >> (bit - 1)) & 1U;
+
+        qualcm_encode_bit(&coder, qualcm_model_predict(&model, bit - 1, node),
+            b);
+        qualcm_model_update(&model, bit - 1, node, b);
+        node = (node << 1) | b;
+      }
+      qualcm_context_update(&context, value);
+    }
+  }
+  assert(pos == length);
+  qualcm_model_delete(&model);
+
+  /* flush the low end of the interval */
+  for (idx = 0; idx < 4UL; idx++) {
+    if (coder.pos == coder.allocated) {
+      coder.allocated += 4;
+      coder.dest = gt_realloc(coder.dest, (size_t) coder.allocated);
+    }
+    coder.dest[coder.pos++] = (GtUchar) (coder.low >> 24);
+    coder.low <<= 8;
+  }
+  *codedlength = coder.pos;
+  return coder.dest;
+}
+
+/* The following function decodes the <codedlength> bytes in <coded>
+ for the <numofreads> reads whose lengths are given by <readlengths>.
+ The number of decoded quality values is stored in <length>. The user
+ is responsible to free the returned memory. If <coded> is not a
+ valid code for the given read lengths, then NULL is returned. */
+
+GtUchar *qualcm_decode(unsigned long *length, const GtUchar *coded,
+    unsigned long codedlength, const unsigned long *readlengths,
+    unsigned long numofreads) {
+
+  const GtUchar * end = coded + codedlength;
+  GtUchar symbol[UCHAR_MAX + 1], * qual = NULL;
+  unsigned long idx, read, numofsymbols = 0, total = 0, pos = 0;
+  QualcmModel model;
+  QualcmContext context;
+  QualcmCoder coder;
+
+  for (read = 0; read < numofreads; read++) {
+    total += readlengths[read];
+  }
+  if (!varint_get(&coded, end, length) || *length != total
+      || coded + QUALCM_BITMAPSIZE > end) {
+    return NULL;
+  }
+  for (idx = 0; idx <= UCHAR_MAX; idx++) {
+    if (coded[idx / CHAR_BIT] & (1U << (idx % CHAR_BIT))) {
+      symbol[numofsymbols++] = (GtUchar) idx;
+    }
+  }
+  coded += QUALCM_BITMAPSIZE;
+  if (numofsymbols == 0 && total > 0) {
+    return NULL;
+  }
+
+  coder.src = coded;
+  coder.end = end;
+  coder.low = 0;
+  coder.high = 0xFFFFFFFFU;
+  coder.code = 0;
+  for (idx = 0; idx < 4UL; idx++) {
+    coder.code = (coder.code << 8) | (coder.src < end ? *coder.src++ : 0);
+  }
+
+  qual = gt_malloc((size_t) total + 1);
+  qualcm_model_init(&model, qualcm_numofbits(numofsymbols));
+  for (read = 0; read < numofreads; read++) {
+    qualcm_context_reset(&context);
+    for (idx = 0; idx < readlengths[read]; idx++, pos++) {
+      unsigned int bit, node = 1U;
+
+      qualcm_model_select(&model, &context);
+      for (bit = model.numofbits; bit > 0; bit--) {
+        const unsigned int b = qualcm_decode_bit(&coder,
+            qualcm_model_predict(&model, bit - 1, node));
+
+        qualcm_model_update(&model, bit - 1, node, b);
+        node = (node << 1) | b;
+      }
+      node -= 1U << model.numofbits;
+      if (node >= numofsymbols) {
+        qualcm_model_delete(&model);
+        gt_free(qual);
+        return NULL;
+      }
+      qual[pos] = symbol[node];
+      qualcm_context_update(&context, node);
+    }
+  }
+  qualcm_model_delete(&model);
+  return qual;
+}
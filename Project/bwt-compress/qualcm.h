@@ -0,0 +1,47 @@
+#ifndef QUALCM_H
+#define QUALCM_H
+
+#include "gt-defs.h"
+
+/* A context mixing coder for the quality values of a sequence of reads.
+   The quality values are mapped to their rank in the alphabet of the
+   input and each rank is coded bit by bit, most significant bit first,
+   with a binary arithmetic coder. The probability of each bit is the
+   logistic mix of the predictions of three adaptive models, whose
+   contexts are
+   - the two preceding quality values of the read (order 2),
+   - the position in the read (in buckets of QUALCM_POSITIONBUCKET
+     values) and the preceding quality value,
+   - the average of the preceding quality values of the read, the
+     number of changes of the quality value in the read so far and the
+     preceding quality value.
+   The weights of the mixer are selected by the bit position.
+
+   The read lengths are not part of the code, the same lengths must be
+   given to the encoder and the decoder. */
+
+#define QUALCM_POSITIONBUCKET 8UL
+
+/* The following function encodes the <length> quality values in
+   <qual>, which is the concatenation of the quality strings of
+   <numofreads> reads whose lengths are given by <readlengths>. The
+   code is returned and its length is stored in <codedlength>. The
+   user is responsible to free the returned memory. */
+
+GtUchar *qualcm_encode(unsigned long *codedlength, const GtUchar *qual,
+                       unsigned long length,
+                       const unsigned long *readlengths,
+                       unsigned long numofreads);
+
+/* The following function decodes the <codedlength> bytes in <coded>
+   for the <numofreads> reads whose lengths are given by <readlengths>.
+   The number of decoded quality values is stored in <length>. The user
+   is responsible to free the returned memory. If <coded> is not a
+   valid code for the given read lengths, then NULL is returned. */
+
+GtUchar *qualcm_decode(unsigned long *length, const GtUchar *coded,
+                       unsigned long codedlength,
+                       const unsigned long *readlengths,
+                       unsigned long numofreads);
+
+#endif
@@ -0,0 +1,369 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <limits.h>
+
+#include "gt-alloc.h"
+#include "varint.h"
+#include "rans.h"
+
+#define RANS_TOTAL        (1U << RANS_PRECISION)
+#define RANS_LOWERBOUND   (1U << 16)
+#define RANS_MAXHEADER    (VARINT_MAXBYTES + 1UL + (UCHAR_MAX + 1) * 3UL)
+
+/* An entry of the decoding table stores the frequency minus 1 (bits
+ 0..11), the difference of the slot and the cumulative frequency of the
+ symbol (bits 12..23) and the symbol itself (bits 24..31) */
+#define RANS_ENTRY(SYM,FREQ,BIAS)\
+        (((uint32_t) (SYM) << 24) | ((uint32_t) (BIAS) << RANS_PRECISION)\
+         | (uint32_t) ((FREQ) - 1))
+
+/**
+ * Scale the counts of the symbols such that the
+ * frequencies sum up to RANS_TOTAL and each occurring
+ * symbol has a frequency of at least 1
+ */
+static void rans_normalize(uint32_t *freq, const unsigned long *count,
+    unsigned long length) {
+
+  unsigned long sum = 0;
+  unsigned int sym, maxsym = 0;
+
+  for (sym = 0; sym <= UCHAR_MAX; sym++) {
+    if (count[sym] == 0) {
+      freq[sym] = 0;
+      continue;
+    }
+    freq[sym] = (uint32_t) ((count[sym] * (uint64_t) RANS_TOTAL) / length);
+    if (freq[sym] == 0) {
+      freq[sym] = 1;
+    }
+    if (count[sym] > count[maxsym]) {
+      maxsym = sym;
+    }
+    sum += freq[sym];
+  }
+  if (sum <= RANS_TOTAL) {
+    freq[maxsym] += RANS_TOTAL - sum;
+    return;
+  }
+  /* the rounding up of rare symbols overshoots: take the
+   difference from the most frequent symbols */
+  while (sum > RANS_TOTAL) {
+    unsigned int largest = 0;
+
+    for (sym = 0; sym <= UCHAR_MAX; sym++) {
+      if (freq[sym] > freq[largest]) {
+        largest = sym;
+      }
+    }
+    assert(freq[largest] > 1U);
+    freq[largest]--;
+    sum--;
+  }
+}
+
+/**
+ * Encode <sym> with the state <x>, the renormalization
+ * words are written backwards in front of <*ptr>
+ */
+static inline void rans_encode_symbol(uint32_t *x, GtUchar **ptr,
+    uint32_t start, uint32_t freq) {
+
+  uint32_t state = *x;
+
+  if ((uint64_t) state >= ((uint64_t) freq << (32U - RANS_PRECISION))) {
+    *ptr -= 2;
+    (*ptr)[0] = (GtUchar) state;
+    (*ptr)[1] = (GtUchar) (state >> 8);
+    state >>= 16;
+  }
+  *x = ((state / freq) << RANS_PRECISION) + state % freq + start;
+}
+
+/* The following function returns the number of bytes which is
+ sufficient to store the code of a sequence of length <length>. */
+
+unsigned long rans_encode_bound(unsigned long length) {
+  return RANS_MAXHEADER + RANS_NUMOFSTATES * 4UL + 2UL * length;
+}
+
+/* The following function encodes the <length> bytes in <src> and
+ returns the code, whose length is stored in <codedlength>. The user
+ is responsible to free the returned memory. */
+
+GtUchar *rans_encode(unsigned long *codedlength, const GtUchar *src,
+    unsigned long length) {
+
+  unsigned long count[UCHAR_MAX + 1] = { 0 };
+  uint32_t freq[UCHAR_MAX + 1], start[UCHAR_MAX + 1],
+      states[RANS_NUMOFSTATES];
+  GtUchar * coded = gt_malloc((size_t) rans_encode_bound(length));
+  GtUchar * words = NULL, * ptr = NULL;
+  unsigned long idx, pos, numofwords;
+  unsigned int sym, numofsymbols = 0;
+  uint32_t cumulative = 0;
+
+  pos = varint_put(coded, length);
+  if (length == 0) {
+    *codedlength = pos;
+    return coded;
+  }
+
+  for (idx = 0; idx < length; idx++) {
+    count[src[idx]]++;
+  }
+  rans_normalize(freq, count, length);
+  for (sym = 0; sym <= UCHAR_MAX; sym++) {
+    start[sym] = cumulative;
+    cumulative += freq[sym];
+    numofsymbols += freq[sym] > 0 ? 1U : 0;
+  }
+  assert(cumulative == RANS_TOTAL);
+  coded[pos++] = (GtUchar) numofsymbols;
+  for (sym = 0; sym <= UCHAR_MAX; sym++) {
+    if (freq[sym] > 0) {
+      coded[pos++] = (GtUchar) sym;
+      pos += varint_put(coded + pos, freq[sym]);
+    }
+  }
+
+  /* the symbols are encoded in reverse order, such that the decoder
+   reads the words in forward direction */
+  words = gt_malloc((size_t) 2 * length);
+  ptr = words + 2 * length;
+  for (idx = 0; idx < RANS_NUMOFSTATES; idx++) {
+    states[idx] = RANS_LOWERBOUND;
+  }
+  for (idx = length; idx > 0; idx--) {
+    const GtUchar cc = src[idx - 1];
+
+    rans_encode_symbol(states + (idx - 1) % RANS_NUMOFSTATES, &ptr,
+        start[cc], freq[cc]);
+  }
+
+  for (idx = 0; idx < RANS_NUMOFSTATES; idx++) {
+    unsigned long byte;
+
+    for (byte = 0; byte < 4UL; byte++) {
+      coded[pos++] = (GtUchar) (states[idx] >> (8 * byte));
+    }
+  }
+  numofwords = (unsigned long) (words + 2 * length - ptr) / 2;
+  memcpy(coded + pos, ptr, (size_t) 2 * numofwords);
+  pos += 2 * numofwords;
+  gt_free(words);
+
+  *codedlength = pos;
+  return gt_realloc(coded, (size_t) pos);
+}
+
+/**
+ * Portable decoder for the symbols <from>..<length>-1,
+ * returns false if the code is exhausted
+ */
+static bool rans_decode_portable(GtUchar *dest, unsigned long from,
+    unsigned long length, uint32_t *states, const uint32_t *table,
+    const GtUchar **ptr, const GtUchar *end) {
+
+  const GtUchar * words = *ptr;
+  unsigned long idx;
+
+  for (idx = from; idx < length; idx++) {
+    uint32_t * x = states + idx % RANS_NUMOFSTATES;
+    const uint32_t entry = table[*x & (RANS_TOTAL - 1)];
+
+    dest[idx] = (GtUchar) (entry >> 24);
+    *x = ((entry & (RANS_TOTAL - 1)) + 1) * (*x >> RANS_PRECISION)
+        + ((entry >> RANS_PRECISION) & (RANS_TOTAL - 1));
+    if (*x < RANS_LOWERBOUND) {
+      if (words + 2 > end) {
+        return false;
+      }
+      *x = (*x << 16) | words[0] | ((uint32_t) words[1] << 8);
+      words += 2;
+    }
+  }
+  *ptr = words;
+  return true;
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define RANS_AVX2
+
+/* For each mask of lanes which need a renormalization word, the
+ permutation which moves the next words into these lanes */
+static uint32_t rans_permutation[256][8];
+static pthread_once_t rans_permutation_once = PTHREAD_ONCE_INIT;
+
+static void rans_permutation_init(void) {
+  unsigned int mask, lane;
+
+  for (mask = 0; mask < 256U; mask++) {
+    uint32_t next = 0;
+
+    for (lane = 0; lane < 8U; lane++) {
+      rans_permutation[mask][lane] = next;
+      if (mask & (1U << lane)) {
+        next++;
+      }
+    }
+  }
+}
+
+/**
+ * Decode the 8 symbols for the states in <x>, which are
+ * returned in the lowest byte of the lanes of <*symbols>,
+ * and read the renormalization words from <*ptr>
+ */
+__attribute__((target("avx2")))
+static inline __m256i rans_decode_avx2_step(__m256i x, __m256i *symbols,
+    const uint32_t *table, const GtUchar **ptr) {
+
+  const __m256i slotmask = _mm256_set1_epi32(RANS_TOTAL - 1);
+  const __m256i below = _mm256_set1_epi32(RANS_LOWERBOUND - 1);
+  const __m256i entry = _mm256_i32gather_epi32((const int *) table,
+      _mm256_and_si256(x, slotmask), 4);
+  const __m256i freq = _mm256_add_epi32(_mm256_and_si256(entry, slotmask),
+      _mm256_set1_epi32(1));
+  const __m256i bias = _mm256_and_si256(
+      _mm256_srli_epi32(entry, RANS_PRECISION), slotmask);
+  __m256i renormalize, words;
+  int mask;
+
+  *symbols = _mm256_srli_epi32(entry, 24);
+  x = _mm256_add_epi32(
+      _mm256_mullo_epi32(freq, _mm256_srli_epi32(x, RANS_PRECISION)), bias);
+
+  /* lanes with x < RANS_LOWERBOUND read the next words in lane order */
+  renormalize = _mm256_cmpeq_epi32(_mm256_max_epu32(x, below), below);
+  mask = _mm256_movemask_ps(_mm256_castsi256_ps(renormalize));
+  words = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) *ptr));
+  words = _mm256_permutevar8x32_epi32(words,
+      _mm256_loadu_si256((const __m256i *) rans_permutation[mask]));
+  x = _mm256_blendv_epi8(x, _mm256_or_si256(_mm256_slli_epi32(x, 16), words),
+      renormalize);
+  *ptr += 2 * __builtin_popcount((unsigned int) mask);
+  return x;
+}
+
+/**
+ * AVX2 decoder, the states are kept in four registers of
+ * 8 lanes each. Returns the number of decoded symbols,
+ * which is a multiple of RANS_NUMOFSTATES
+ */
+__attribute__((target("avx2")))
+static unsigned long rans_decode_avx2(GtUchar *dest, unsigned long length,
+    uint32_t *states, const uint32_t *table, const GtUchar **ptr,
+    const GtUchar *end) {
+
+  __m256i x0 = _mm256_loadu_si256((const __m256i *) states),
+      x1 = _mm256_loadu_si256((const __m256i *) (states + 8)),
+      x2 = _mm256_loadu_si256((const __m256i *) (states + 16)),
+      x3 = _mm256_loadu_si256((const __m256i *) (states + 24));
+  /* packing the symbols interleaves the 4 byte groups of the lanes */
+  const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  const GtUchar * words = *ptr;
+  unsigned long idx;
+
+  /* each step reads at most 16 bytes */
+  for (idx = 0; idx + RANS_NUMOFSTATES <= length && words + 64 <= end;
+      idx += RANS_NUMOFSTATES) {
+    __m256i s0, s1, s2, s3;
+
+    x0 = rans_decode_avx2_step(x0, &s0, table, &words);
+    x1 = rans_decode_avx2_step(x1, &s1, table, &words);
+    x2 = rans_decode_avx2_step(x2, &s2, table, &words);
+    x3 = rans_decode_avx2_step(x3, &s3, table, &words);
+    s0 = _mm256_packus_epi16(_mm256_packus_epi32(s0, s1),
+        _mm256_packus_epi32(s2, s3));
+    _mm256_storeu_si256((__m256i *) (dest + idx),
+        _mm256_permutevar8x32_epi32(s0, order));
+  }
+  _mm256_storeu_si256((__m256i *) states, x0);
+  _mm256_storeu_si256((__m256i *) (states + 8), x1);
+  _mm256_storeu_si256((__m256i *) (states + 16), x2);
+  _mm256_storeu_si256((__m256i *) (states + 24), x3);
+  *ptr = words;
+  return idx;
+}
+#endif
+
+/* The following function decodes the <codedlength> bytes in <coded>.
+ The length of the decoded sequence is stored in <length>. The user is
+ responsible to free the returned memory. If <coded> is not a valid
+ code, then NULL is returned. */
+
+GtUchar *rans_decode(unsigned long *length, const GtUchar *coded,
+    unsigned long codedlength) {
+
+  const GtUchar * ptr = coded, * end = coded + codedlength;
+  uint32_t table[RANS_TOTAL], states[RANS_NUMOFSTATES];
+  GtUchar * dest = NULL;
+  unsigned long idx, numofsymbols, decoded = 0;
+  uint32_t cumulative = 0;
+
+  if (!varint_get(&ptr, end, length)) {
+    return NULL;
+  }
+  if (*length == 0) {
+    return gt_malloc(1);
+  }
+
+  /* the frequencies define the decoding table */
+  if (ptr >= end) {
+    return NULL;
+  }
+  numofsymbols = *ptr++;
+  if (numofsymbols == 0) {
+    numofsymbols = UCHAR_MAX + 1;
+  }
+  for (idx = 0; idx < numofsymbols; idx++) {
+    unsigned long sym, freq, slot;
+
+    if (ptr >= end) {
+      return NULL;
+    }
+    sym = *ptr++;
+    if (!varint_get(&ptr, end, &freq) || freq == 0
+        || cumulative + freq > RANS_TOTAL) {
+      return NULL;
+    }
+    for (slot = 0; slot < freq; slot++) {
+      table[cumulative + slot] = RANS_ENTRY(sym, freq, slot);
+    }
+    cumulative += (uint32_t) freq;
+  }
+  if (cumulative != RANS_TOTAL || ptr + 4 * RANS_NUMOFSTATES > end) {
+    return NULL;
+  }
+  for (idx = 0; idx < RANS_NUMOFSTATES; idx++) {
+    states[idx] = (uint32_t) ptr[0] | ((uint32_t) ptr[1] << 8)
+        | ((uint32_t) ptr[2] << 16) | ((uint32_t) ptr[3] << 24);
+    ptr += 4;
+  }
+
+  dest = gt_malloc((size_t) *length);
+#ifdef RANS_AVX2
+  if (__builtin_cpu_supports("avx2")) {
+    pthread_once(&rans_permutation_once, rans_permutation_init);
+    decoded = rans_decode_avx2(dest, *length, states, table, &ptr, end);
+  }
+#endif
+  if (!rans_decode_portable(dest, decoded, *length, states, table, &ptr, end)
+      || ptr != end) {
+    gt_free(dest);
+    return NULL;
+  }
+  /* the encoder started with all states at the lower bound */
+  for (idx = 0; idx < RANS_NUMOFSTATES; idx++) {
+    if (states[idx] != RANS_LOWERBOUND) {
+      gt_free(dest);
+      return NULL;
+    }
+  }
+  return dest;
+}
@@ -0,0 +1,46 @@
+#ifndef RANS_H
+#define RANS_H
+
+#include <stdbool.h>
+#include "gt-defs.h"
+
+/* An order-0 range asymmetric numeral system (rANS) coder for byte
+   sequences. The frequencies of the symbols are scaled to a total of
+   1 << RANS_PRECISION, so that a symbol is decoded by a single lookup
+   in a table with one entry per slot. The symbols are distributed in
+   a round robin fashion over RANS_NUMOFSTATES independent 32 bit
+   states, which are renormalized by 16 bit words. The decoder keeps
+   the states in four AVX2 registers of 8 lanes each if the processor
+   supports this and otherwise falls back to a portable
+   implementation. Both decoders deliver the same result.
+
+   The code consists of the length of the input (as varint), the
+   number of different symbols (1 byte, 0 meaning 256), for each of
+   them the symbol (1 byte) and its scaled frequency (as varint),
+   the final states (4 bytes each) and the renormalization words
+   (2 bytes each), all in little endian byte order. */
+
+#define RANS_PRECISION    12U
+#define RANS_NUMOFSTATES  32UL
+
+/* The following function returns the number of bytes which is
+   sufficient to store the code of a sequence of length <length>. */
+
+unsigned long rans_encode_bound(unsigned long length);
+
+/* The following function encodes the <length> bytes in <src> and
+   returns the code, whose length is stored in <codedlength>. The user
+   is responsible to free the returned memory. */
+
+GtUchar *rans_encode(unsigned long *codedlength, const GtUchar *src,
+                     unsigned long length);
+
+/* The following function decodes the <codedlength> bytes in <coded>.
+   The length of the decoded sequence is stored in <length>. The user is
+   responsible to free the returned memory. If <coded> is not a valid
+   code, then NULL is returned. */
+
+GtUchar *rans_decode(unsigned long *length, const GtUchar *coded,
+                     unsigned long codedlength);
+
+#endif
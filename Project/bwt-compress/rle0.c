@@ -0,0 +1,83 @@
+#include <limits.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "gt-alloc.h"
+#include "rle0.h"
+
+/* The following function computes the zero-run encoding of the
+ <length> values stored in <mtf>. The result is stored in an array of
+ at most <length> symbols which is returned. The number of symbols
+ is stored in <numofsymbols>. The user is responsible to free the
+ returned memory. */
+
+uint16_t *rle0_encode(unsigned long *numofsymbols, const GtUchar *mtf,
+    unsigned long length) {
+
+  unsigned long i, run = 0, j = 0;
+  uint16_t * rle = NULL;
+
+  rle = gt_malloc((size_t) (length + 1) * sizeof *rle);
+
+  for (i = 0; i <= length; i++) {
+    if (i < length && mtf[i] == 0) {
+      run++;
+      continue;
+    }
+    if (run > 0) {
+      /* a run of length r needs at most log2(r+1) digits, hence
+         the encoding never gets longer than the input */
+      run--;
+      while (true) {
+        rle[j++] = (run & 1UL) ? RLE0_RUNB : RLE0_RUNA;
+        if (run < 2UL) {
+          break;
+        }
+        run = (run - 2UL) >> 1;
+      }
+      run = 0;
+    }
+    if (i < length) {
+      rle[j++] = (uint16_t) (mtf[i] + 1);
+    }
+  }
+
+  *numofsymbols = j;
+  return rle;
+}
+
+/* The following function decodes the <numofsymbols> symbols in <rle>
+ and writes the values to <mtf> which provides space for <length>
+ values. If the decoded values do not fill exactly <length> entries,
+ then false is returned. */
+
+bool rle0_decode(GtUchar *mtf, unsigned long length, const uint16_t *rle,
+    unsigned long numofsymbols) {
+
+  unsigned long i, j = 0, run = 0, power = 1;
+
+  for (i = 0; i <= numofsymbols; i++) {
+    if (i < numofsymbols && rle[i] <= RLE0_RUNB) {
+      run += (rle[i] == RLE0_RUNA) ? power : (power << 1);
+      power <<= 1;
+      continue;
+    }
+    if (run > 0) {
+      if (run > length - j) {
+        return false;
+      }
+      memset(mtf + j, 0, (size_t) run);
+      j += run;
+      run = 0;
+      power = 1;
+    }
+    if (i < numofsymbols) {
+      if (j == length || rle[i] >= RLE0_NUMOFSYMBOLS) {
+        return false;
+      }
+      mtf[j++] = (GtUchar) (rle[i] - 1);
+    }
+  }
+
+  return j == length ? true : false;
+}
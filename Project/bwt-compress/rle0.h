@@ -0,0 +1,37 @@
+#ifndef RLE0_H
+#define RLE0_H
+
+#include <inttypes.h>
+#include <limits.h>
+#include <stdbool.h>
+#include "gt-defs.h"
+
+/* The zero-run encoding replaces each run of zeros in the output of the
+   move-to-front transformation by the binary representation of the run
+   length, written with the two digits RLE0_RUNA and RLE0_RUNB (bijective
+   base 2, least significant digit first). Any other value v is represented
+   by the symbol v+1. Hence the encoded symbols are in the range
+   0..RLE0_NUMOFSYMBOLS-1. */
+
+#define RLE0_RUNA 0
+#define RLE0_RUNB 1
+#define RLE0_NUMOFSYMBOLS (UCHAR_MAX + 2)
+
+/* The following function computes the zero-run encoding of the
+   <length> values stored in <mtf>. The result is stored in an array of
+   at most <length> symbols which is returned. The number of symbols
+   is stored in <numofsymbols>. The user is responsible to free the
+   returned memory. */
+
+uint16_t *rle0_encode(unsigned long *numofsymbols, const GtUchar *mtf,
+                      unsigned long length);
+
+/* The following function decodes the <numofsymbols> symbols in <rle>
+   and writes the values to <mtf> which provides space for <length>
+   values. If the decoded values do not fill exactly <length> entries,
+   then false is returned. */
+
+bool rle0_decode(GtUchar *mtf, unsigned long length, const uint16_t *rle,
+                 unsigned long numofsymbols);
+
+#endif
@@ -0,0 +1,225 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include "gt-alloc.h"
+#include "runstats.h"
+
+typedef struct {
+  unsigned long calls, length, requested, mallocs, peakrss,
+                heap; /* the maximum of the bytes in use at the ends */
+  double seconds, rsstime; /* time of the last query of the peak rss */
+} RunstatsCounts;
+
+/* the stages called once per entry query the peak rss at most once in
+ this period */
+#define RUNSTATS_RSSPERIOD 0.01
+
+typedef struct {
+  unsigned long calls, length, numofchars;
+  double seconds;
+} RunstatsLevel;
+
+static const char *runstats_names[RUNSTATS_NUMOFSTAGES] = {
+  "parse", "concat", "sa", "bwt", "mtf", "entropy", "verify"
+};
+
+static bool runstats_on = false;
+static double runstats_start;
+static pthread_mutex_t runstats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static RunstatsCounts runstats_counts[RUNSTATS_NUMOFSTAGES];
+static RunstatsLevel runstats_levels[RUNSTATS_MAXLEVELS];
+static GtArenaStats runstats_arenas;
+static unsigned long runstats_numofarenas = 0;
+
+/**
+ * The wall time in seconds
+ */
+static double runstats_now(void) {
+  struct timespec now;
+
+  (void) clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1000000000.0;
+}
+
+/**
+ * The peak resident set size of
+ * the process in bytes
+ */
+static unsigned long runstats_peakrss(void) {
+  struct rusage usage;
+
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  /* Linux reports kilobytes */
+  return (unsigned long) usage.ru_maxrss * 1024UL;
+}
+
+/* Enable the collection of the statistics. */
+
+void runstats_enable(void) {
+  memset(runstats_counts, 0, sizeof runstats_counts);
+  memset(runstats_levels, 0, sizeof runstats_levels);
+  runstats_start = runstats_now();
+  runstats_on = true;
+}
+
+/* Deliver true if the statistics are collected. */
+
+bool runstats_enabled(void) {
+  return runstats_on;
+}
+
+/* Store the start of a call of a stage in <mark>. */
+
+void runstats_mark(RunstatsMark *mark) {
+  if (runstats_on) {
+    mark->time = runstats_now();
+    mark->requested = gt_alloc_thread_requested();
+    mark->mallocs = gt_alloc_thread_calls();
+  }
+}
+
+/* Add the call of <stage> started at <mark>, which processed <length>
+ bytes, to the statistics. <mark> must be stored by the same
+ thread. */
+
+void runstats_end(RunstatsStage stage, const RunstatsMark *mark,
+    unsigned long length) {
+
+  if (runstats_on) {
+    const double now = runstats_now();
+    const unsigned long requested = gt_alloc_thread_requested()
+        - mark->requested, mallocs = gt_alloc_thread_calls()
+        - mark->mallocs, heap = gt_alloc_current();
+    RunstatsCounts * counts = runstats_counts + stage;
+
+    pthread_mutex_lock(&runstats_mutex);
+    counts->calls++;
+    counts->seconds += now - mark->time;
+    counts->length += length;
+    counts->requested += requested;
+    counts->mallocs += mallocs;
+    if (heap > counts->heap) {
+      counts->heap = heap;
+    }
+    if (now - counts->rsstime >= RUNSTATS_RSSPERIOD) {
+      const unsigned long peakrss = runstats_peakrss();
+
+      counts->rsstime = now;
+      if (peakrss > counts->peakrss) {
+        counts->peakrss = peakrss;
+      }
+    }
+    pthread_mutex_unlock(&runstats_mutex);
+  }
+}
+
+/* Add the sorting of a sequence of <length> symbols over an alphabet of
+ size <numofchars> on the given <level> of the recursion of the suffix
+ sorting started at <mark> to the statistics. The time includes the
+ deeper levels. */
+
+void runstats_sain_level(unsigned int level, const RunstatsMark *mark,
+    unsigned long length, unsigned long numofchars) {
+
+  if (runstats_on && level < RUNSTATS_MAXLEVELS) {
+    const double seconds = runstats_now() - mark->time;
+    RunstatsLevel * stats = runstats_levels + level;
+
+    pthread_mutex_lock(&runstats_mutex);
+    stats->calls++;
+    stats->seconds += seconds;
+    stats->length += length;
+    if (numofchars > stats->numofchars) {
+      stats->numofchars = numofchars;
+    }
+    pthread_mutex_unlock(&runstats_mutex);
+  }
+}
+
+/* Add the counters <stats> of an arena to the statistics, the peaks of
+ the arenas are added as well. */
+
+void runstats_arena(const GtArenaStats *stats) {
+
+  if (runstats_on) {
+    pthread_mutex_lock(&runstats_mutex);
+    runstats_numofarenas++;
+    runstats_arenas.numofchunks += stats->numofchunks;
+    runstats_arenas.reserved += stats->reserved;
+    runstats_arenas.allocations += stats->allocations;
+    runstats_arenas.resets += stats->resets;
+    runstats_arenas.peak += stats->peak;
+    pthread_mutex_unlock(&runstats_mutex);
+  }
+}
+
+/* Show the statistics as a JSON object on <fp>. The run processed
+ <inputlength> bytes of the file <inputname> with <numofthreads>
+ threads. */
+
+void runstats_show(FILE *fp, const char *inputname,
+    unsigned long inputlength, unsigned long numofthreads) {
+
+  const double walltime = runstats_now() - runstats_start;
+  const char * ptr;
+  unsigned long stage;
+  unsigned int level, numoflevels;
+
+  pthread_mutex_lock(&runstats_mutex);
+  fprintf(fp, "{\n  \"input\": \"");
+  for (ptr = inputname; *ptr != '\0'; ptr++) {
+    if (*ptr == '"' || *ptr == '\\') {
+      fputc('\\', fp);
+    }
+    fputc(*ptr, fp);
+  }
+  fprintf(fp, "\",\n  \"inputbytes\": %lu,\n  \"threads\": %lu,\n"
+      "  \"walltime\": %.6f,\n  \"mbps\": %.3f,\n  \"peakrss\": %lu,\n"
+      "  \"peakheap\": %lu,\n", inputlength, numofthreads, walltime,
+      walltime > 0.0 ? inputlength / (walltime * 1000000.0) : 0.0,
+      runstats_peakrss(), gt_alloc_peak());
+  fprintf(fp, "  \"arenas\": { \"arenas\": %lu, \"chunks\": %lu, "
+      "\"reserved\": %lu, \"allocations\": %lu, \"resets\": %lu, "
+      "\"peak\": %lu },\n  \"stages\": [\n", runstats_numofarenas,
+      runstats_arenas.numofchunks, runstats_arenas.reserved,
+      runstats_arenas.allocations, runstats_arenas.resets,
+      runstats_arenas.peak);
+  for (stage = 0; stage < RUNSTATS_NUMOFSTAGES; stage++) {
+    const RunstatsCounts * counts = runstats_counts + stage;
+
+    fprintf(fp, "    { \"stage\": \"%s\", \"calls\": %lu, \"seconds\": %.6f, "
+        "\"bytes\": %lu, \"mbps\": %.3f, \"allocated\": %lu, "
+        "\"peakrss\": %lu, \"heap\": %lu, \"mallocs\": %lu }%s\n",
+        runstats_names[stage], counts->calls, counts->seconds, counts->length,
+        counts->seconds > 0.0
+            ? counts->length / (counts->seconds * 1000000.0) : 0.0,
+        counts->requested, counts->peakrss, counts->heap, counts->mallocs,
+        stage + 1 < RUNSTATS_NUMOFSTAGES ? "," : "");
+  }
+
+  /* the time of a level without the deeper levels */
+  for (numoflevels = 0; numoflevels < RUNSTATS_MAXLEVELS
+      && runstats_levels[numoflevels].calls > 0; numoflevels++) {
+    /* Nothing */
+  }
+  fprintf(fp, "  ],\n  \"sainlevels\": [\n");
+  for (level = 0; level < numoflevels; level++) {
+    const RunstatsLevel * stats = runstats_levels + level;
+    const double deeper = level + 1 < numoflevels
+        ? runstats_levels[level + 1].seconds : 0.0;
+
+    fprintf(fp, "    { \"level\": %u, \"calls\": %lu, \"length\": %lu, "
+        "\"numofchars\": %lu, \"seconds\": %.6f, \"exclusive\": %.6f }%s\n",
+        level, stats->calls, stats->length, stats->numofchars,
+        stats->seconds, stats->seconds - deeper,
+        level + 1 < numoflevels ? "," : "");
+  }
+  fprintf(fp, "  ]\n}\n");
+  pthread_mutex_unlock(&runstats_mutex);
+}
@@ -0,0 +1,77 @@
+#ifndef RUNSTATS_H
+#define RUNSTATS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "gt-arena.h"
+
+/* Statistics of a run, which are collected per stage of the pipeline
+   if they are enabled: the number of calls, the wall time, the number
+   of bytes processed and allocated, the number of allocations, and the
+   peak resident set size of
+   the process and the bytes in use by gt-alloc observed at the end of a
+   call. The stages may be executed
+   by several threads at once, then the times of the threads are added.
+   In addition, the levels of the recursion of the suffix sorting are
+   recorded, and the counters of the arenas are added up. Without
+   runstats_enable, the functions only test a flag. */
+
+typedef enum {
+  RUNSTATS_PARSE,
+  RUNSTATS_CONCAT,
+  RUNSTATS_SA,
+  RUNSTATS_BWT,
+  RUNSTATS_MTF,
+  RUNSTATS_ENTROPY,
+  RUNSTATS_VERIFY,
+  RUNSTATS_NUMOFSTAGES
+} RunstatsStage;
+
+#define RUNSTATS_MAXLEVELS 64U
+
+/* The start of a call of a stage */
+typedef struct {
+  double time;
+  unsigned long requested, mallocs;
+} RunstatsMark;
+
+/* Enable the collection of the statistics. */
+
+void runstats_enable(void);
+
+/* Deliver true if the statistics are collected. */
+
+bool runstats_enabled(void);
+
+/* Store the start of a call of a stage in <mark>. */
+
+void runstats_mark(RunstatsMark *mark);
+
+/* Add the call of <stage> started at <mark>, which processed <length>
+   bytes, to the statistics. <mark> must be stored by the same
+   thread. */
+
+void runstats_end(RunstatsStage stage, const RunstatsMark *mark,
+                  unsigned long length);
+
+/* Add the sorting of a sequence of <length> symbols over an alphabet of
+   size <numofchars> on the given <level> of the recursion of the suffix
+   sorting started at <mark> to the statistics. The time includes the
+   deeper levels. */
+
+void runstats_sain_level(unsigned int level, const RunstatsMark *mark,
+                         unsigned long length, unsigned long numofchars);
+
+/* Add the counters <stats> of an arena to the statistics, the peaks of
+   the arenas are added as well. */
+
+void runstats_arena(const GtArenaStats *stats);
+
+/* Show the statistics as a JSON object on <fp>. The run processed
+   <inputlength> bytes of the file <inputname> with <numofthreads>
+   threads. */
+
+void runstats_show(FILE *fp, const char *inputname,
+                   unsigned long inputlength, unsigned long numofthreads);
+
+#endif
@@ -0,0 +1,405 @@
+/*
+  Copyright (c) 2012-2013 Stefan Kurtz <kurtz@zbh.uni-hamburg.de>
+  Copyright (c) 2012-2013 Center for Bioinformatics, University of Hamburg
+
+  Permission to use, copy, modify, and distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/* The induction of the first level of the suffix sorting of a
+   sequence over an alphabet of at most GT_SAIN_SIGMA characters. This
+   file is included by sk-sain.c once for each alphabet size and type of
+   sequence, which delivers the functions
+   gt_sain_<GT_SAIN_SEQ><GT_SAIN_SIGMA>_<name>. GT_SAIN_SEQ,
+   GT_SAIN_SEQTYPE, GT_SAIN_GETCC(SEQ,POS), which delivers the
+   character at position POS of SEQ and is only applied to arguments
+   without side effects, and GT_SAIN_CCADDR(SEQ,POS), which delivers the
+   address to prefetch for it, default to a plain sequence. As the size is
+   known at compile time, the bucket pointers and the round table are
+   arrays of the function, which the compiler keeps in registers or the
+   L1 cache, instead of the tables of the GtSainseq, whose bucket
+   pointers are written back whenever the bucket changes. The fill
+   pointers are not written back, since they are recomputed after each
+   induction. */
+
+#ifndef GT_SAIN_SIGMA
+#error "GT_SAIN_SIGMA must be defined before sk-sain-kernels.h is included"
+#endif
+
+#ifndef GT_SAIN_SEQ
+#define GT_SAIN_SEQ            PLAINSEQ
+#define GT_SAIN_SEQTYPE        GtUchar
+#define GT_SAIN_GETCC(SEQ,POS) ((unsigned long) (SEQ)[POS])
+#define GT_SAIN_CCADDR(SEQ,POS) GT_SAIN_PLAINCCADDR(SEQ,POS)
+#endif
+
+#define GT_SAIN_KERNELNAME2(SEQ,SIGMA,NAME)\
+        gt_sain_ ## SEQ ## SIGMA ## _ ## NAME
+#define GT_SAIN_KERNELNAME(SEQ,SIGMA,NAME)\
+        GT_SAIN_KERNELNAME2(SEQ,SIGMA,NAME)
+#define GT_SAIN_KERNEL(NAME)\
+        GT_SAIN_KERNELNAME(GT_SAIN_SEQ,GT_SAIN_SIGMA,NAME)
+
+static void GT_SAIN_KERNEL(fast_induceLtypesuffixes1)(GtSainseq *sainseq,
+                                                      const GT_SAIN_SEQTYPE
+                                                        *seq,
+                                                      Sint *suftab,
+                                                      unsigned long
+                                                        nonspecialentries)
+{
+  const unsigned long numofchars = sainseq->numofchars;
+  const Sint totallength = (Sint) sainseq->totallength;
+  unsigned long charidx, accesses = 0;
+  Uint currentround = 0, roundtable[GT_MULT2(GT_SAIN_SIGMA)];
+  Sint *suftabptr, position, *bucketptr[GT_SAIN_SIGMA];
+
+  gt_assert(sainseq->roundtable != NULL && numofchars <= GT_SAIN_SIGMA);
+  for (charidx = 0; charidx < numofchars; charidx++)
+  {
+    bucketptr[charidx] = suftab + sainseq->bucketfillptr[charidx];
+    roundtable[GT_MULT2(charidx)] = sainseq->roundtable[GT_MULT2(charidx)];
+    roundtable[GT_MULT2(charidx)+1]
+      = sainseq->roundtable[GT_MULT2(charidx)+1];
+  }
+  for (suftabptr = suftab; suftabptr < suftab + nonspecialentries;
+       suftabptr++)
+  {
+    GT_SAIN_PREFETCHFORWARD(GT_SAIN_CCADDR,seq,suftabptr,
+                            suftab + nonspecialentries,totallength);
+    if ((position = *suftabptr) > 0)
+    {
+      unsigned long currentcc;
+
+      if (position >= totallength)
+      {
+        currentround++;
+        position -= totallength;
+      }
+      currentcc = GT_SAIN_GETCC(seq,(unsigned long) position);
+      accesses++;
+      if (currentcc < numofchars)
+      {
+        if (position > 0)
+        {
+          unsigned long t, leftcontextcc;
+
+          position--;
+          leftcontextcc = GT_SAIN_GETCC(seq,(unsigned long) position);
+          accesses++;
+          t = (currentcc << 1) | (leftcontextcc < currentcc ? 1UL : 0);
+          gt_assert(currentcc > 0 && roundtable[t] <= currentround);
+          if (roundtable[t] < currentround)
+          {
+            position += totallength;
+            roundtable[t] = currentround;
+          }
+          /* negative => position does not derive L-suffix
+             positive => position may derive L-suffix */
+          gt_assert(suftabptr < bucketptr[currentcc]);
+          *bucketptr[currentcc]++ = (t & 1UL) ? ~position : position;
+          *suftabptr = 0;
+        }
+      } else
+      {
+        *suftabptr = 0;
+      }
+    } else
+    {
+      if (position < 0)
+      {
+        *suftabptr = ~position;
+      }
+    }
+  }
+  for (charidx = 0; charidx < GT_MULT2(numofchars); charidx++)
+  {
+    sainseq->roundtable[charidx] = roundtable[charidx];
+  }
+  sainseq->currentround = currentround;
+  randomcharaccess += accesses;
+}
+
+static void GT_SAIN_KERNEL(fast_induceStypesuffixes1)(GtSainseq *sainseq,
+                                                      const GT_SAIN_SEQTYPE
+                                                        *seq,
+                                                      Sint *suftab,
+                                                      unsigned long
+                                                        nonspecialentries)
+{
+  const unsigned long numofchars = sainseq->numofchars;
+  const Sint totallength = (Sint) sainseq->totallength;
+  unsigned long charidx, accesses = 0;
+  Uint currentround, roundtable[GT_MULT2(GT_SAIN_SIGMA)];
+  Sint *suftabptr, position, *bucketptr[GT_SAIN_SIGMA];
+
+  gt_assert(sainseq->roundtable != NULL && numofchars <= GT_SAIN_SIGMA);
+  gt_sain_special_singleSinduction1(sainseq,
+                                    suftab,
+                                    (Sint) (sainseq->totallength-1));
+  currentround = sainseq->currentround;
+  for (charidx = 0; charidx < numofchars; charidx++)
+  {
+    bucketptr[charidx] = suftab + sainseq->bucketfillptr[charidx];
+    roundtable[GT_MULT2(charidx)] = sainseq->roundtable[GT_MULT2(charidx)];
+    roundtable[GT_MULT2(charidx)+1]
+      = sainseq->roundtable[GT_MULT2(charidx)+1];
+  }
+  for (suftabptr = suftab + nonspecialentries - 1; suftabptr >= suftab;
+       suftabptr--)
+  {
+    GT_SAIN_PREFETCHBACKWARD(GT_SAIN_CCADDR,seq,suftabptr,suftab,totallength);
+    if ((position = *suftabptr) > 0)
+    {
+      if (position >= totallength)
+      {
+        currentround++;
+        position -= totallength;
+      }
+      if (position > 0)
+      {
+        unsigned long currentcc = GT_SAIN_GETCC(seq,(unsigned long) position);
+
+        accesses++;
+        if (currentcc < numofchars)
+        {
+          unsigned long t, leftcontextcc;
+
+          position--;
+          leftcontextcc = GT_SAIN_GETCC(seq,(unsigned long) position);
+
+          accesses++;
+          t = (currentcc << 1) | (leftcontextcc > currentcc ? 1UL : 0);
+          gt_assert(roundtable[t] <= currentround);
+          if (roundtable[t] < currentround)
+          {
+            position += totallength;
+            roundtable[t] = currentround;
+          }
+          gt_assert(bucketptr[currentcc] - 1 < suftabptr);
+          *(--bucketptr[currentcc]) = (t & 1UL) ? ~(position+1) : position;
+        }
+      }
+      *suftabptr = 0;
+    }
+  }
+  for (charidx = 0; charidx < GT_MULT2(numofchars); charidx++)
+  {
+    sainseq->roundtable[charidx] = roundtable[charidx];
+  }
+  sainseq->currentround = currentround;
+  randomcharaccess += accesses;
+}
+
+static void GT_SAIN_KERNEL(induceLtypesuffixes1)(GtSainseq *sainseq,
+                                                 const GT_SAIN_SEQTYPE *seq,
+                                                 Sint *suftab,
+                                                 unsigned long
+                                                   nonspecialentries)
+{
+  const unsigned long numofchars = sainseq->numofchars;
+  unsigned long charidx, accesses = 0;
+  Sint *suftabptr, position, *bucketptr[GT_SAIN_SIGMA];
+
+  gt_assert(sainseq->roundtable == NULL && numofchars <= GT_SAIN_SIGMA);
+  for (charidx = 0; charidx < numofchars; charidx++)
+  {
+    bucketptr[charidx] = suftab + sainseq->bucketfillptr[charidx];
+  }
+  for (suftabptr = suftab; suftabptr < suftab + nonspecialentries;
+       suftabptr++)
+  {
+    GT_SAIN_PREFETCHFORWARD(GT_SAIN_CCADDR,seq,suftabptr,
+                            suftab + nonspecialentries,sainseq->totallength);
+    if ((position = *suftabptr) > 0)
+    {
+      unsigned long currentcc = GT_SAIN_GETCC(seq,(unsigned long) position);
+
+      accesses++;
+      if (currentcc < numofchars)
+      {
+        unsigned long leftcontextcc;
+
+        /* negative => position does not derive L-suffix
+           positive => position may derive L-suffix */
+        gt_assert(suftabptr < bucketptr[currentcc]);
+        position--;
+        leftcontextcc = GT_SAIN_GETCC(seq,(unsigned long) position);
+        accesses++;
+        *bucketptr[currentcc]++ = (leftcontextcc < currentcc) ? ~position
+                                                              : position;
+      }
+      *suftabptr = 0;
+    } else
+    {
+      if (position < 0)
+      {
+        *suftabptr = ~position;
+      }
+    }
+  }
+  randomcharaccess += accesses;
+}
+
+static void GT_SAIN_KERNEL(induceStypesuffixes1)(GtSainseq *sainseq,
+                                                 const GT_SAIN_SEQTYPE *seq,
+                                                 Sint *suftab,
+                                                 unsigned long
+                                                   nonspecialentries)
+{
+  const unsigned long numofchars = sainseq->numofchars;
+  unsigned long charidx, accesses = 0;
+  Sint *suftabptr, position, *bucketptr[GT_SAIN_SIGMA];
+
+  gt_assert(sainseq->roundtable == NULL && numofchars <= GT_SAIN_SIGMA);
+  gt_sain_special_singleSinduction1(sainseq,
+                                    suftab,
+                                    (Sint) (sainseq->totallength-1));
+  for (charidx = 0; charidx < numofchars; charidx++)
+  {
+    bucketptr[charidx] = suftab + sainseq->bucketfillptr[charidx];
+  }
+  for (suftabptr = suftab + nonspecialentries - 1; suftabptr >= suftab;
+       suftabptr--)
+  {
+    GT_SAIN_PREFETCHBACKWARD(GT_SAIN_CCADDR,seq,suftabptr,suftab,
+                             sainseq->totallength);
+    if ((position = *suftabptr) > 0)
+    {
+      unsigned long currentcc = GT_SAIN_GETCC(seq,(unsigned long) position);
+
+      accesses++;
+      if (currentcc < numofchars)
+      {
+        unsigned long leftcontextcc;
+
+        gt_assert(bucketptr[currentcc] - 1 < suftabptr);
+        position--;
+        leftcontextcc = GT_SAIN_GETCC(seq,(unsigned long) position);
+        accesses++;
+        *(--bucketptr[currentcc]) = (leftcontextcc > currentcc)
+                                      ? ~(position+1) : position;
+      }
+      *suftabptr = 0;
+    }
+  }
+  randomcharaccess += accesses;
+}
+
+static void GT_SAIN_KERNEL(induceLtypesuffixes2)(const GtSainseq *sainseq,
+                                                 const GT_SAIN_SEQTYPE *seq,
+                                                 Sint *suftab,
+                                                 unsigned long
+                                                   nonspecialentries)
+{
+  const unsigned long numofchars = sainseq->numofchars;
+  unsigned long charidx, accesses = 0;
+  Sint *suftabptr, *bucketptr[GT_SAIN_SIGMA];
+  const Sint *endptr = suftab + nonspecialentries;
+
+  gt_assert(numofchars <= GT_SAIN_SIGMA);
+  for (charidx = 0; charidx < numofchars; charidx++)
+  {
+    bucketptr[charidx] = suftab + sainseq->bucketfillptr[charidx];
+  }
+  for (suftabptr = suftab; suftabptr < endptr; suftabptr++)
+  {
+    GT_SAIN_PREFETCHFORWARD(GT_SAIN_CCADDR,seq,suftabptr,
+                            suftab + nonspecialentries,sainseq->totallength);
+    Sint position = *suftabptr;
+
+    *suftabptr = ~position;
+    if (position > 0)
+    {
+      unsigned long currentcc;
+
+      position--;
+      currentcc = GT_SAIN_GETCC(seq,(unsigned long) position);
+      accesses++;
+      if (currentcc < numofchars)
+      {
+        gt_assert(currentcc > 0);
+        gt_assert(suftabptr < bucketptr[currentcc]);
+        if (position > 0)
+        {
+          accesses++;
+        }
+        *bucketptr[currentcc]++
+          = (0 < position &&
+             GT_SAIN_GETCC(seq,(unsigned long) (position-1)) < currentcc)
+            ? ~position : position;
+      }
+    }
+  }
+  randomcharaccess += accesses;
+}
+
+static void GT_SAIN_KERNEL(induceStypesuffixes2)(const GtSainseq *sainseq,
+                                                 const GT_SAIN_SEQTYPE *seq,
+                                                 Sint *suftab,
+                                                 unsigned long
+                                                   nonspecialentries)
+{
+  const unsigned long numofchars = sainseq->numofchars;
+  unsigned long charidx, accesses = 0;
+  Sint *suftabptr, *bucketptr[GT_SAIN_SIGMA];
+
+  gt_assert(numofchars <= GT_SAIN_SIGMA);
+  gt_sain_special_singleSinduction2(sainseq,
+                                    suftab,
+                                    (Sint) sainseq->totallength,
+                                    nonspecialentries);
+  for (charidx = 0; charidx < numofchars; charidx++)
+  {
+    bucketptr[charidx] = suftab + sainseq->bucketfillptr[charidx];
+  }
+  for (suftabptr = suftab + nonspecialentries - 1; suftabptr >= suftab;
+       suftabptr--)
+  {
+    GT_SAIN_PREFETCHBACKWARD(GT_SAIN_CCADDR,seq,suftabptr,suftab,
+                             sainseq->totallength);
+    Sint position;
+
+    if ((position = *suftabptr) > 0)
+    {
+      unsigned long currentcc;
+
+      position--;
+      currentcc = GT_SAIN_GETCC(seq,(unsigned long) position);
+      accesses++;
+      if (currentcc < numofchars)
+      {
+        gt_assert(bucketptr[currentcc] - 1 < suftabptr);
+        if (position > 0)
+        {
+          accesses++;
+        }
+        *(--bucketptr[currentcc])
+          = (position == 0 ||
+             GT_SAIN_GETCC(seq,(unsigned long) (position-1)) > currentcc)
+            ? ~position : position;
+      }
+    } else
+    {
+      *suftabptr = ~position;
+    }
+  }
+  randomcharaccess += accesses;
+}
+
+#undef GT_SAIN_KERNEL
+#undef GT_SAIN_KERNELNAME
+#undef GT_SAIN_KERNELNAME2
+#undef GT_SAIN_SIGMA
+#undef GT_SAIN_SEQ
+#undef GT_SAIN_SEQTYPE
+#undef GT_SAIN_GETCC
+#undef GT_SAIN_CCADDR
@@ -24,10 +24,15 @@
 #include "gt-defs.h"
 #include "sk-sain.h"
 #include "sktimer.h"
+#include "runstats.h"
 
 #define GT_MAXALPHABETCHARACTER UCHAR_MAX
 #define GT_COMPAREOFFSET        (GT_MAXALPHABETCHARACTER + 1)
 #define GT_UNIQUEINT(POS)       (GT_COMPAREOFFSET + (POS))
+#define GT_TWOBITCHAR(TBE,POS)\
+        ((unsigned long) ((TBE)[(POS) / GT_UNITSIN2BITENC] >>\
+                          GT_MULT2(GT_UNITSIN2BITENC - 1 -\
+                                   (POS) % GT_UNITSIN2BITENC)) & 3UL)
 
 #define SHOWTIMER(WHAT)\
         if (sktimer != NULL && outfp != NULL)\
@@ -51,9 +56,39 @@ static unsigned int gt_determinebitspervalue(unsigned long maxvalue)
 typedef enum
 {
   GT_SAIN_PLAINSEQ,
+  GT_SAIN_TWOBITSEQ,
   GT_SAIN_LONGSEQ
 } GtSainSeqtype;
 
+typedef struct
+{
+  unsigned long buf_size, numofchars, cachesize;
+  Uint *values, *fillptr, *suftab;
+  uint16_t *nextidx;
+  int log_bufsize;
+} GtSainbuffer;
+
+/* the buffer of a bucket holds 2^log_bufsize values, so the buffers of
+   all buckets have less than 2^GT_SAIN_LOGCACHESIZE values */
+#define GT_SAIN_LOGCACHESIZE (18 - (sizeof (Uint) == (size_t) 4 ? 1 : 2))
+
+/* The workspace of a suffix sorting is allocated once: the tables of
+   the first level and the buffers for the insertion of the S*-suffixes,
+   which are used on all levels, and the space for the tables of the
+   deeper levels which do not fit into the unused end of the suffix
+   table. The deeper levels share this space, as a level recomputes its
+   tables after the deeper levels returned. */
+typedef struct
+{
+  Uint *tables,
+       *levelspace,
+       *buffervalues;
+  unsigned long numofchars,
+                levelentries;
+  uint16_t *buffernextidx;
+  GtSainbuffer buffer;
+} GtSainworkspace;
+
 typedef struct
 {
   unsigned long totallength,
@@ -66,133 +101,245 @@ typedef struct
   union
   {
     const GtUchar *plainseq;
+    const GtTwobitencoding *twobitseq;
     const Uint *array;
   } seq;
   GtSainSeqtype seqtype;
-  bool bucketfillptrpoints2suftab,
-       bucketsizepoints2suftab,
-       roundtablepoints2suftab;
+  GtSainMethod method;
+  GtSainworkspace *workspace;
 } GtSainseq;
 
-static bool gt_sain_decideforfastmethod(unsigned long maxvalue,
+static bool gt_sain_decideforfastmethod(GtSainMethod method,
+                                        unsigned long maxvalue,
                                         unsigned long len,
                                         unsigned long numofchars)
 {
-  return maxvalue < (unsigned long) GT_FIRSTTWOBITS && len > 1024UL
-         && len >= GT_MULT2(numofchars)
-         ? true : false;
+  if (maxvalue >= (unsigned long) GT_FIRSTTWOBITS
+      || method == GT_SAIN_METHOD_SPACE)
+  {
+    return false;
+  }
+  return method == GT_SAIN_METHOD_FAST
+         || (len > 1024UL && len >= GT_MULT2(numofchars)) ? true : false;
+}
+
+static __thread unsigned long randomcharaccess = 0;
+static __thread unsigned long sequentialcharaccess = 0;
+
+static void gt_sainworkspace_init(GtSainworkspace *workspace,
+                                  unsigned long numofchars)
+{
+  workspace->numofchars = numofchars;
+  workspace->tables = (Uint *) gt_malloc(sizeof (*workspace->tables) *
+                                         (size_t) (numofchars +
+                                                   GT_MULT4(numofchars)));
+  workspace->levelspace = NULL;
+  workspace->levelentries = 0;
+  workspace->buffervalues
+    = (Uint *) gt_malloc(sizeof (*workspace->buffervalues) *
+                         (1UL << GT_SAIN_LOGCACHESIZE));
+  workspace->buffernextidx
+    = (uint16_t *) gt_malloc(sizeof (*workspace->buffernextidx) *
+                             (UCHAR_MAX+1));
+}
+
+static void gt_sainworkspace_wrap(GtSainworkspace *workspace)
+{
+  gt_free(workspace->tables);
+  gt_free(workspace->levelspace);
+  gt_free(workspace->buffervalues);
+  gt_free(workspace->buffernextidx);
+}
+
+/* the number of entries of the tables of a level with <numofchars>
+   characters which do not fit into the <unused> entries at the end of
+   the suffix table */
+static unsigned long gt_sain_levelentries(unsigned long unused,
+                                          unsigned long numofchars,
+                                          bool fast)
+{
+  unsigned long entries = 0;
+
+  if (unused < numofchars)
+  {
+    entries += numofchars;
+  }
+  if (unused < GT_MULT2(numofchars))
+  {
+    entries += numofchars;
+  }
+  if (fast && unused < GT_MULT4(numofchars))
+  {
+    entries += GT_MULT2(numofchars);
+  }
+  return entries;
 }
 
-static unsigned long randomcharaccess = 0;
-static unsigned long sequentialcharaccess = 0;
+/* allocate the space for the tables of the deeper levels for the
+   first of them which needs it, a level of length <len> requiring
+   <entries> entries. The next level sorts at most <len>/2 names, so its
+   tables and those of all deeper levels need at most <len> entries, or
+   twice as many if the fast method is enforced. Hence the space is
+   allocated at most once */
+static void gt_sainworkspace_levels(GtSainworkspace *workspace,
+                                    GtSainMethod method,
+                                    unsigned long len,
+                                    unsigned long entries,
+                                    unsigned long unused)
+{
+  const unsigned long deeper = method == GT_SAIN_METHOD_FAST
+                               ? GT_MULT2(len) : len;
+
+  gt_assert(workspace->levelspace == NULL);
+  if (deeper > unused && deeper > entries)
+  {
+    entries = deeper;
+  }
+  workspace->levelspace
+    = (Uint *) gt_malloc_large(sizeof (*workspace->levelspace) *
+                               (size_t) entries);
+  workspace->levelentries = entries;
+}
 
-static GtSainseq *gt_sainseq_new_from_plainseq(const GtUchar *plainseq,
-                                               unsigned long len,
-                                               unsigned long numofchars)
+static void gt_sainseq_init_from_plainseq(GtSainseq *sainseq,
+                                          GtSainworkspace *workspace,
+                                          const GtUchar *plainseq,
+                                          unsigned long len,
+                                          unsigned long numofchars,
+                                          GtSainMethod method)
 {
   const GtUchar *cptr;
-  GtSainseq *sainseq = (GtSainseq *) gt_malloc(sizeof *sainseq);
+  unsigned long charidx;
 
+  gt_assert(numofchars <= workspace->numofchars);
   sainseq->seqtype = GT_SAIN_PLAINSEQ;
+  sainseq->method = method;
+  sainseq->workspace = workspace;
   sainseq->seq.plainseq = plainseq;
   sainseq->totallength = len;
   sainseq->numofchars = numofchars;
-  sainseq->bucketsize = (Uint *) gt_calloc((size_t) sainseq->numofchars,
-                                           sizeof *sainseq->bucketsize);
-  sainseq->bucketfillptr = (Uint *) gt_malloc(sizeof (*sainseq->bucketfillptr) *
-                                              sainseq->numofchars);
-  if (gt_sain_decideforfastmethod(len+1,len,sainseq->numofchars))
-  {
-    sainseq->roundtable
-      = (Uint *) gt_malloc(sizeof (*sainseq->roundtable) *
-                           (size_t) GT_MULT2(sainseq->numofchars));
+  sainseq->bucketsize = workspace->tables;
+  sainseq->bucketfillptr = workspace->tables + numofchars;
+  sainseq->sstarfirstcharcount = workspace->tables + GT_MULT2(numofchars);
+  if (gt_sain_decideforfastmethod(method,len+1,len,sainseq->numofchars))
+  {
+    sainseq->roundtable = workspace->tables + numofchars +
+                          GT_MULT2(numofchars);
   } else
   {
     sainseq->roundtable = NULL;
   }
-  sainseq->sstarfirstcharcount
-    = (Uint *) gt_calloc((size_t) sainseq->numofchars,
-                         sizeof *sainseq->sstarfirstcharcount);
-  sainseq->bucketfillptrpoints2suftab = false;
-  sainseq->bucketsizepoints2suftab = false;
-  sainseq->roundtablepoints2suftab = false;
+  for (charidx = 0; charidx < numofchars; charidx++)
+  {
+    sainseq->bucketsize[charidx] = 0;
+    sainseq->sstarfirstcharcount[charidx] = 0;
+  }
   for (cptr = sainseq->seq.plainseq; cptr < sainseq->seq.plainseq + len; cptr++)
   {
     gt_assert(*cptr < numofchars);
     sainseq->bucketsize[*cptr]++;
     sequentialcharaccess++;
   }
-  return sainseq;
 }
 
-static GtSainseq *gt_sainseq_new_from_array(Uint *arr,
-                                            unsigned long len,
-                                            unsigned long numofchars,
-                                            Uint *suftab,
-                                            Uint firstusable,
-                                            unsigned long suftabentries)
+static void gt_sainseq_init_from_twobitseq(GtSainseq *sainseq,
+                                           GtSainworkspace *workspace,
+                                           const GtTwobitencoding *twobitseq,
+                                           unsigned long len,
+                                           GtSainMethod method)
+{
+  const unsigned long numofchars = 4UL;
+  unsigned long charidx, position;
+
+  gt_assert(numofchars <= workspace->numofchars);
+  sainseq->seqtype = GT_SAIN_TWOBITSEQ;
+  sainseq->method = method;
+  sainseq->workspace = workspace;
+  sainseq->seq.twobitseq = twobitseq;
+  sainseq->totallength = len;
+  sainseq->numofchars = numofchars;
+  sainseq->bucketsize = workspace->tables;
+  sainseq->bucketfillptr = workspace->tables + numofchars;
+  sainseq->sstarfirstcharcount = workspace->tables + GT_MULT2(numofchars);
+  if (gt_sain_decideforfastmethod(method,len+1,len,numofchars))
+  {
+    sainseq->roundtable = workspace->tables + numofchars +
+                          GT_MULT2(numofchars);
+  } else
+  {
+    sainseq->roundtable = NULL;
+  }
+  for (charidx = 0; charidx < numofchars; charidx++)
+  {
+    sainseq->bucketsize[charidx] = 0;
+    sainseq->sstarfirstcharcount[charidx] = 0;
+  }
+  for (position = 0; position < len; position++)
+  {
+    sainseq->bucketsize[GT_TWOBITCHAR(twobitseq,position)]++;
+    sequentialcharaccess++;
+  }
+}
+
+/* the tables of a deeper level are stored at the end of the suffix table
+   as far as it is unused, otherwise in the space of the workspace for
+   the deeper levels */
+static void gt_sainseq_init_from_array(GtSainseq *sainseq,
+                                       GtSainworkspace *workspace,
+                                       Uint *arr,
+                                       unsigned long len,
+                                       unsigned long numofchars,
+                                       GtSainMethod method,
+                                       Uint *suftab,
+                                       Uint firstusable,
+                                       unsigned long suftabentries)
 {
+  const unsigned long unused = suftabentries - firstusable;
+  const bool fast = gt_sain_decideforfastmethod(method,len+1,len,numofchars);
+  const unsigned long entries = gt_sain_levelentries(unused,numofchars,fast);
   unsigned long charidx;
-  Uint *cptr;
-  GtSainseq *sainseq = (GtSainseq *) gt_malloc(sizeof *sainseq);
+  Uint *cptr, *levelspace;
 
   sainseq->seqtype = GT_SAIN_LONGSEQ;
+  sainseq->method = method;
+  sainseq->workspace = workspace;
   sainseq->seq.array = arr;
   sainseq->totallength = len;
   sainseq->numofchars = numofchars;
   gt_assert((unsigned long) firstusable < suftabentries);
-  /*
-  printf("can use %lu entries, divided by numofchars=%lu => %.2f\n",
-           suftabentries - firstusable,numofchars,(double)
-           (suftabentries - firstusable)/numofchars);
-  */
-  if (suftabentries - firstusable >= numofchars)
-  {
-    /*printf("bucketsize: reclaim suftab[%lu,%lu]\n",
-            suftabentries - numofchars,suftabentries-1);*/
+  if (entries > 0 && workspace->levelspace == NULL)
+  {
+    gt_sainworkspace_levels(workspace,method,len,entries,unused);
+  }
+  gt_assert(entries <= workspace->levelentries);
+  levelspace = workspace->levelspace;
+  if (unused >= numofchars)
+  {
     sainseq->bucketsize = suftab + suftabentries - numofchars;
-    sainseq->bucketsizepoints2suftab = true;
   } else
   {
-    printf("bucketsize requires %lu entries and only %lu are left\n",
-           numofchars,(unsigned long) (suftabentries - firstusable));
-    sainseq->bucketsizepoints2suftab = false;
-    sainseq->bucketsize
-      = (Uint *) gt_malloc(sizeof (*sainseq->bucketsize) * numofchars);
+    sainseq->bucketsize = levelspace;
+    levelspace += numofchars;
   }
-  if (suftabentries - firstusable >= GT_MULT2(numofchars))
+  if (unused >= GT_MULT2(numofchars))
   {
-    /*printf("bucketfillptr: reclaim suftab[%lu,%lu]\n",
-            suftabentries - GT_MULT2(numofchars),
-            suftabentries - numofchars -1);*/
     sainseq->bucketfillptr = suftab + suftabentries - GT_MULT2(numofchars);
-    sainseq->bucketfillptrpoints2suftab = true;
   } else
   {
-    /*printf("bucketfillptr requires %lu entries and only %lu are left\n",
-           numofchars,suftabentries - firstusable);*/
-    sainseq->bucketfillptrpoints2suftab = false;
-    sainseq->bucketfillptr
-      = (Uint *) gt_malloc(sizeof (*sainseq->bucketfillptr) * numofchars);
+    sainseq->bucketfillptr = levelspace;
+    levelspace += numofchars;
   }
-  if (gt_sain_decideforfastmethod(len+1,len,sainseq->numofchars))
+  if (fast)
   {
-    if (suftabentries - firstusable >= GT_MULT4(numofchars))
+    if (unused >= GT_MULT4(numofchars))
     {
-      /*printf("roundtable: reclaim suftab[%lu,%lu]\n",
-              suftabentries - GT_MULT4(numofchars),
-              suftabentries - GT_MULT2(numofchars) - 1);*/
       sainseq->roundtable = suftab + suftabentries - GT_MULT4(numofchars);
-      sainseq->roundtablepoints2suftab = true;
     } else
     {
-      sainseq->roundtablepoints2suftab = false;
-      sainseq->roundtable = (Uint *) gt_malloc(sizeof (*sainseq->roundtable) *
-                                               GT_MULT2(numofchars));
+      sainseq->roundtable = levelspace;
     }
   } else
   {
-    sainseq->roundtablepoints2suftab = false;
     sainseq->roundtable = NULL;
   }
   sainseq->sstarfirstcharcount = NULL;
@@ -205,44 +352,24 @@ static GtSainseq *gt_sainseq_new_from_array(Uint *arr,
     gt_assert(*cptr < numofchars);
     sainseq->bucketsize[*cptr]++;
   }
-  return sainseq;
-}
-
-static void gt_sainseq_delete(GtSainseq *sainseq)
-{
-  if (sainseq != NULL)
-  {
-    if (!sainseq->bucketfillptrpoints2suftab)
-    {
-      gt_free(sainseq->bucketfillptr);
-    }
-    if (!sainseq->bucketsizepoints2suftab)
-    {
-      gt_free(sainseq->bucketsize);
-    }
-    if (!sainseq->roundtablepoints2suftab)
-    {
-      gt_free(sainseq->roundtable);
-    }
-    if (sainseq->seqtype != GT_SAIN_LONGSEQ)
-    {
-      gt_free(sainseq->sstarfirstcharcount);
-    }
-    gt_free(sainseq);
-  }
 }
 
 static unsigned long gt_sainseq_getchar(const GtSainseq *sainseq,
                                         unsigned long position)
 {
   gt_assert(position < sainseq->totallength);
-  if (sainseq->seqtype == GT_SAIN_PLAINSEQ)
+  switch (sainseq->seqtype)
   {
-    randomcharaccess++;
+    case GT_SAIN_PLAINSEQ:
+      randomcharaccess++;
+      return (unsigned long) sainseq->seq.plainseq[position];
+    case GT_SAIN_TWOBITSEQ:
+      randomcharaccess++;
+      return GT_TWOBITCHAR(sainseq->seq.twobitseq,position);
+    case GT_SAIN_LONGSEQ:
+      break;
   }
-  return (sainseq->seqtype == GT_SAIN_PLAINSEQ)
-         ? (unsigned long) sainseq->seq.plainseq[position]
-         : (unsigned long) sainseq->seq.array[position];
+  return (unsigned long) sainseq->seq.array[position];
 }
 
 static void gt_sain_endbuckets(GtSainseq *sainseq)
@@ -271,38 +398,37 @@ static void gt_sain_startbuckets(GtSainseq *sainseq)
   }
 }
 
-typedef struct
-{
-  unsigned long buf_size, numofchars, cachesize;
-  Uint *values, *fillptr, *suftab;
-  uint16_t *nextidx;
-  int log_bufsize;
-  size_t size;
-} GtSainbuffer;
-
-static GtSainbuffer *gt_sainbuffer_new(Uint *suftab,
+static GtSainbuffer *gt_sainbuffer_new(GtSainworkspace *workspace,
+                                       Uint *suftab,
                                        Uint *fillptr,
                                        unsigned long numofchars)
 {
   if (numofchars <= UCHAR_MAX+1)
   {
-    GtSainbuffer *buf = (GtSainbuffer *) gt_malloc(sizeof *buf);
+    GtSainbuffer *buf = &workspace->buffer;
+    unsigned long charidx;
 
-    buf->size = sizeof *buf;
     buf->fillptr = fillptr;
     buf->suftab = suftab;
-    buf->log_bufsize = 18 - (sizeof (Uint) == (size_t) 4 ? 1 : 2) -
-                             (int) gt_determinebitspervalue(numofchars);
+    buf->log_bufsize = (int) GT_SAIN_LOGCACHESIZE -
+                       (int) gt_determinebitspervalue(numofchars);
+    /* the indexes of the buffers of the remapped small alphabets must fit
+       into 16 bits */
+    if (buf->log_bufsize > 15)
+    {
+      buf->log_bufsize = 15;
+    }
     buf->buf_size = 1UL << buf->log_bufsize;
     buf->numofchars = numofchars;
     gt_assert(buf->buf_size <= UINT16_MAX);
     buf->cachesize = numofchars << buf->log_bufsize;
-    buf->values = (Uint *)
-                  gt_malloc(sizeof (*buf->values) * buf->cachesize);
-    buf->size += sizeof (*buf->values) * buf->cachesize;
-    buf->nextidx = (uint16_t *)
-                   gt_calloc((size_t) numofchars,sizeof *buf->nextidx);
-    buf->size += sizeof (*buf->nextidx) * numofchars;
+    gt_assert(buf->cachesize <= 1UL << GT_SAIN_LOGCACHESIZE);
+    buf->values = workspace->buffervalues;
+    buf->nextidx = workspace->buffernextidx;
+    for (charidx = 0; charidx < numofchars; charidx++)
+    {
+      buf->nextidx[charidx] = 0;
+    }
     return buf;
   } else
   {
@@ -363,16 +489,6 @@ static void gt_sainbuffer_flushall(GtSainbuffer *buf)
   }
 }
 
-static void gt_sainbuffer_delete(GtSainbuffer *buf)
-{
-  if (buf != NULL)
-  {
-    gt_free(buf->values);
-    gt_free(buf->nextidx);
-    gt_free(buf);
-  }
-}
-
 #define GT_SAINUPDATEBUCKETPTR(CURRENTCC)\
         if (bucketptr != NULL)\
         {\
@@ -386,6 +502,52 @@ static void gt_sainbuffer_delete(GtSainbuffer *buf)
           bucketptr = suftab + fillptr[lastupdatecc = CURRENTCC];\
         }
 
+/* The inductions scan the suffix table and access the characters
+   preceding the suffixes in random order. While the characters of the
+   current entry are read, those of the suffix stored GT_SAIN_PREFETCHDIST
+   entries ahead are prefetched, whose entry may still change until the
+   scan reaches it. The value of the entry may be negative or increased
+   by the length of the sequence. */
+#define GT_SAIN_PREFETCHDIST 16
+
+#define GT_SAIN_PREFETCHSUFFIX(CCADDR,SEQ,VALUE,TOTALLENGTH)\
+        {\
+          Sint prefetchpos = VALUE;\
+          if (prefetchpos >= (Sint) (TOTALLENGTH))\
+          {\
+            prefetchpos -= (Sint) (TOTALLENGTH);\
+          }\
+          if (prefetchpos > 0)\
+          {\
+            __builtin_prefetch(CCADDR(SEQ,prefetchpos-1));\
+          }\
+        }
+
+/* the values of the second pass are no rounds */
+#define GT_SAIN_NOROUNDS INT_MAX
+
+#define GT_SAIN_PLAINCCADDR(SEQ,POS)  ((SEQ) + (POS))
+#define GT_SAIN_TWOBITCCADDR(SEQ,POS) ((SEQ) + (POS) / GT_UNITSIN2BITENC)
+
+/* prefetch ahead of <SUFTABPTR> in the scan from left to right ending
+   before <ENDPTR> */
+#define GT_SAIN_PREFETCHFORWARD(CCADDR,SEQ,SUFTABPTR,ENDPTR,TOTALLENGTH)\
+        if ((SUFTABPTR) + GT_SAIN_PREFETCHDIST < (ENDPTR))\
+        {\
+          GT_SAIN_PREFETCHSUFFIX(CCADDR,SEQ,(SUFTABPTR)[GT_SAIN_PREFETCHDIST],\
+                                 TOTALLENGTH);\
+        }
+
+/* prefetch ahead of <SUFTABPTR> in the scan from right to left ending
+   at <STARTPTR> */
+#define GT_SAIN_PREFETCHBACKWARD(CCADDR,SEQ,SUFTABPTR,STARTPTR,TOTALLENGTH)\
+        if ((SUFTABPTR) >= (STARTPTR) + GT_SAIN_PREFETCHDIST)\
+        {\
+          GT_SAIN_PREFETCHSUFFIX(CCADDR,SEQ,\
+                                 *((SUFTABPTR) - GT_SAIN_PREFETCHDIST),\
+                                 TOTALLENGTH);\
+        }
+
 static void gt_sain_special_singleSinduction1(GtSainseq *sainseq,
                                               Sint *suftab,
                                               Sint position);
@@ -404,8 +566,8 @@ static unsigned long gt_sain_PLAINSEQ_insertSstarsuffixes(GtSainseq *sainseq,
                 nextcc = GT_UNIQUEINT(sainseq->totallength),
                 countSstartype = 0;
   Uint *fillptr = sainseq->bucketfillptr;
-  GtSainbuffer *sainbuffer = gt_sainbuffer_new(suftab,fillptr,
-                                               sainseq->numofchars);
+  GtSainbuffer *sainbuffer = gt_sainbuffer_new(sainseq->workspace,suftab,
+                                               fillptr,sainseq->numofchars);
   bool nextisStype = true;
 
   gt_sain_endbuckets(sainseq);
@@ -440,7 +602,6 @@ static unsigned long gt_sain_PLAINSEQ_insertSstarsuffixes(GtSainseq *sainseq,
     }
   }
   gt_sainbuffer_flushall(sainbuffer);
-  gt_sainbuffer_delete(sainbuffer);
   gt_assert(GT_MULT2(countSstartype) <= sainseq->totallength);
   return countSstartype;
 }
@@ -458,6 +619,8 @@ static void gt_sain_PLAINSEQ_fast_induceLtypesuffixes1(GtSainseq *sainseq,
   for (suftabptr = suftab, sainseq->currentround = 0;
        suftabptr < suftab + nonspecialentries; suftabptr++)
   {
+    GT_SAIN_PREFETCHFORWARD(GT_SAIN_PLAINCCADDR,plainseq,suftabptr,
+                            suftab + nonspecialentries,sainseq->totallength);
     if ((position = *suftabptr) > 0)
     {
       unsigned long currentcc;
@@ -523,6 +686,8 @@ static void gt_sain_PLAINSEQ_induceLtypesuffixes1(GtSainseq *sainseq,
   gt_assert(sainseq->roundtable == NULL);
   for (suftabptr = suftab; suftabptr < suftab + nonspecialentries; suftabptr++)
   {
+    GT_SAIN_PREFETCHFORWARD(GT_SAIN_PLAINCCADDR,plainseq,suftabptr,
+                            suftab + nonspecialentries,sainseq->totallength);
     if ((position = *suftabptr) > 0)
     {
       unsigned long currentcc = plainseq[position];
@@ -574,6 +739,8 @@ static void gt_sain_PLAINSEQ_fast_induceStypesuffixes1(GtSainseq *sainseq,
   for (suftabptr = suftab + nonspecialentries - 1; suftabptr >= suftab;
        suftabptr--)
   {
+    GT_SAIN_PREFETCHBACKWARD(GT_SAIN_PLAINCCADDR,plainseq,suftabptr,suftab,
+                             sainseq->totallength);
     if ((position = *suftabptr) > 0)
     {
       if (position >= (Sint) sainseq->totallength)
@@ -628,6 +795,8 @@ static void gt_sain_PLAINSEQ_induceStypesuffixes1(GtSainseq *sainseq,
   for (suftabptr = suftab + nonspecialentries - 1; suftabptr >= suftab;
        suftabptr--)
   {
+    GT_SAIN_PREFETCHBACKWARD(GT_SAIN_PLAINCCADDR,plainseq,suftabptr,suftab,
+                             sainseq->totallength);
     if ((position = *suftabptr) > 0)
     {
       unsigned long currentcc = plainseq[(unsigned long) position];
@@ -666,6 +835,8 @@ static void gt_sain_PLAINSEQ_induceLtypesuffixes2(Uint *fillptr,
 
   for (suftabptr = suftab; suftabptr < endptr; suftabptr++)
   {
+    GT_SAIN_PREFETCHFORWARD(GT_SAIN_PLAINCCADDR,plainseq,suftabptr,
+                            suftab + nonspecialentries,GT_SAIN_NOROUNDS);
     Sint position = *suftabptr;
     *suftabptr = ~position;
     if (position > 0)
@@ -710,6 +881,8 @@ static void gt_sain_PLAINSEQ_induceStypesuffixes2(const GtSainseq *sainseq,
   for (suftabptr = suftab + nonspecialentries - 1; suftabptr >= suftab;
        suftabptr--)
   {
+    GT_SAIN_PREFETCHBACKWARD(GT_SAIN_PLAINCCADDR,plainseq,suftabptr,suftab,
+                             GT_SAIN_NOROUNDS);
     Sint position;
 
     if ((position = *suftabptr) > 0)
@@ -779,6 +952,106 @@ static void gt_sain_PLAINSEQ_expandorder2original(GtSainseq *sainseq,
   }
 }
 
+#define GT_SAIN_SIGMA 8
+#include "sk-sain-kernels.h"
+#define GT_SAIN_SIGMA 64
+#include "sk-sain-kernels.h"
+#define GT_SAIN_SIGMA 256
+#include "sk-sain-kernels.h"
+
+static unsigned long gt_sain_TWOBITSEQ_insertSstarsuffixes(GtSainseq *sainseq,
+                                         const GtTwobitencoding *twobitseq,
+                                         Uint *suftab)
+{
+  unsigned long position,
+                nextcc = GT_UNIQUEINT(sainseq->totallength),
+                countSstartype = 0;
+  Uint *fillptr = sainseq->bucketfillptr;
+  GtSainbuffer *sainbuffer = gt_sainbuffer_new(sainseq->workspace,suftab,
+                                               fillptr,sainseq->numofchars);
+  bool nextisStype = true;
+
+  gt_sain_endbuckets(sainseq);
+  for (position = sainseq->totallength-1; /* Nothing */; position--)
+  {
+    unsigned long currentcc = GT_TWOBITCHAR(twobitseq,position);
+
+    sequentialcharaccess++;
+    bool currentisStype = (currentcc < nextcc ||
+                           (currentcc == nextcc && nextisStype)) ? true : false;
+    if (!currentisStype && nextisStype)
+    {
+      countSstartype++;
+      sainseq->sstarfirstcharcount[nextcc]++;
+      gt_sainbuffer_update(sainbuffer,nextcc,position);
+    }
+    nextisStype = currentisStype;
+    nextcc = currentcc;
+    if (position == 0)
+    {
+      break;
+    }
+  }
+  gt_sainbuffer_flushall(sainbuffer);
+  gt_assert(GT_MULT2(countSstartype) <= sainseq->totallength);
+  return countSstartype;
+}
+
+static void gt_sain_TWOBITSEQ_expandorder2original(GtSainseq *sainseq,
+                                         const GtTwobitencoding *twobitseq,
+                                         unsigned long numberofsuffixes,
+                                         Uint *suftab)
+{
+  Uint *suftabptr, position,
+       *sstarsuffixes = suftab + GT_MULT2(numberofsuffixes);
+  unsigned long nextcc = GT_UNIQUEINT(sainseq->totallength);
+  bool nextisStype = true;
+
+  for (position = sainseq->totallength-1; /* Nothing */; position--)
+  {
+    unsigned long currentcc = GT_TWOBITCHAR(twobitseq,position);
+
+    sequentialcharaccess++;
+    bool currentisStype = (currentcc < nextcc ||
+                           (currentcc == nextcc && nextisStype)) ? true : false;
+
+    if (!currentisStype && nextisStype)
+    {
+      *--sstarsuffixes = position+1;
+    }
+    nextisStype = currentisStype;
+    nextcc = currentcc;
+    if (position == 0)
+    {
+      break;
+    }
+  }
+  for (suftabptr = suftab; suftabptr < suftab + numberofsuffixes; suftabptr++)
+  {
+    gt_assert(*suftabptr < numberofsuffixes);
+    *suftabptr = sstarsuffixes[*suftabptr];
+  }
+}
+
+/* the induction of the first level of a 2-bit packed sequence, the
+   characters are extracted from the units like a plain sequence */
+#define GT_SAIN_SIGMA          4
+#define GT_SAIN_SEQ            TWOBITSEQ
+#define GT_SAIN_SEQTYPE        GtTwobitencoding
+#define GT_SAIN_GETCC(SEQ,POS) GT_TWOBITCHAR(SEQ,POS)
+#define GT_SAIN_CCADDR(SEQ,POS) GT_SAIN_TWOBITCCADDR(SEQ,POS)
+#include "sk-sain-kernels.h"
+
+/* the induction for the first level specialized for the size of the
+   alphabet, NULL if there is none */
+#define GT_SAIN_PLAINSEQKERNEL(NUMOFCHARS,NAME)\
+        ((NUMOFCHARS) <= 8UL ? gt_sain_PLAINSEQ8_ ## NAME\
+                             : ((NUMOFCHARS) <= 64UL\
+                                  ? gt_sain_PLAINSEQ64_ ## NAME\
+                                  : ((NUMOFCHARS) <= 256UL\
+                                       ? gt_sain_PLAINSEQ256_ ## NAME\
+                                       : NULL)))
+
 static unsigned long gt_sain_LONGSEQ_insertSstarsuffixes(GtSainseq *sainseq,
                                              const Uint *array,
                                              Uint *suftab)
@@ -788,8 +1061,8 @@ static unsigned long gt_sain_LONGSEQ_insertSstarsuffixes(GtSainseq *sainseq,
                 countSstartype = 0;
   bool nextisStype = true;
   Uint *fillptr = sainseq->bucketfillptr;
-  GtSainbuffer *sainbuffer = gt_sainbuffer_new(suftab,fillptr,
-                                               sainseq->numofchars);
+  GtSainbuffer *sainbuffer = gt_sainbuffer_new(sainseq->workspace,suftab,
+                                               fillptr,sainseq->numofchars);
 
   gt_sain_endbuckets(sainseq);
   for (position = sainseq->totallength-1; /* Nothing */; position--)
@@ -820,7 +1093,6 @@ static unsigned long gt_sain_LONGSEQ_insertSstarsuffixes(GtSainseq *sainseq,
     }
   }
   gt_sainbuffer_flushall(sainbuffer);
-  gt_sainbuffer_delete(sainbuffer);
   gt_assert(GT_MULT2(countSstartype) <= sainseq->totallength);
   return countSstartype;
 }
@@ -838,6 +1110,8 @@ static void gt_sain_LONGSEQ_fast_induceLtypesuffixes1(GtSainseq *sainseq,
   for (suftabptr = suftab, sainseq->currentround = 0;
        suftabptr < suftab + nonspecialentries; suftabptr++)
   {
+    GT_SAIN_PREFETCHFORWARD(GT_SAIN_PLAINCCADDR,array,suftabptr,
+                            suftab + nonspecialentries,sainseq->totallength);
     if ((position = *suftabptr) > 0)
     {
       unsigned long currentcc;
@@ -895,6 +1169,8 @@ static void gt_sain_LONGSEQ_induceLtypesuffixes1(GtSainseq *sainseq,
   gt_assert(sainseq->roundtable == NULL);
   for (suftabptr = suftab; suftabptr < suftab + nonspecialentries; suftabptr++)
   {
+    GT_SAIN_PREFETCHFORWARD(GT_SAIN_PLAINCCADDR,array,suftabptr,
+                            suftab + nonspecialentries,sainseq->totallength);
     if ((position = *suftabptr) > 0)
     {
       unsigned long currentcc = array[position], leftcontextcc;
@@ -937,6 +1213,8 @@ static void gt_sain_LONGSEQ_fast_induceStypesuffixes1(GtSainseq *sainseq,
   for (suftabptr = suftab + nonspecialentries - 1; suftabptr >= suftab;
        suftabptr--)
   {
+    GT_SAIN_PREFETCHBACKWARD(GT_SAIN_PLAINCCADDR,array,suftabptr,suftab,
+                             sainseq->totallength);
     if ((position = *suftabptr) > 0)
     {
       if (position >= (Sint) sainseq->totallength)
@@ -985,6 +1263,8 @@ static void gt_sain_LONGSEQ_induceStypesuffixes1(GtSainseq *sainseq,
   for (suftabptr = suftab + nonspecialentries - 1; suftabptr >= suftab;
        suftabptr--)
   {
+    GT_SAIN_PREFETCHBACKWARD(GT_SAIN_PLAINCCADDR,array,suftabptr,suftab,
+                             sainseq->totallength);
     if ((position = *suftabptr) > 0)
     {
       unsigned long currentcc = array[position], leftcontextcc;
@@ -1013,6 +1293,8 @@ static void gt_sain_LONGSEQ_induceLtypesuffixes2(Uint *fillptr,
 
   for (suftabptr = suftab; suftabptr < endptr; suftabptr++)
   {
+    GT_SAIN_PREFETCHFORWARD(GT_SAIN_PLAINCCADDR,array,suftabptr,
+                            suftab + nonspecialentries,GT_SAIN_NOROUNDS);
     Sint position = *suftabptr;
     *suftabptr = ~position;
     if (position > 0)
@@ -1048,6 +1330,8 @@ static void gt_sain_LONGSEQ_induceStypesuffixes2(const GtSainseq *sainseq,
   for (suftabptr = suftab + nonspecialentries - 1; suftabptr >= suftab;
        suftabptr--)
   {
+    GT_SAIN_PREFETCHBACKWARD(GT_SAIN_PLAINCCADDR,array,suftabptr,suftab,
+                             GT_SAIN_NOROUNDS);
     Sint position;
 
     if ((position = *suftabptr) > 0)
@@ -1127,6 +1411,10 @@ static unsigned long gt_sain_insertSstarsuffixes(GtSainseq *sainseq,
       return gt_sain_PLAINSEQ_insertSstarsuffixes(sainseq,
                                                   sainseq->seq.plainseq,
                                                   suftab);
+    case GT_SAIN_TWOBITSEQ:
+      return gt_sain_TWOBITSEQ_insertSstarsuffixes(sainseq,
+                                                   sainseq->seq.twobitseq,
+                                                   suftab);
     case GT_SAIN_LONGSEQ:
       return gt_sain_LONGSEQ_insertSstarsuffixes(sainseq,
                                                  sainseq->seq.array,
@@ -1162,11 +1450,32 @@ static void gt_sain_induceLtypesuffixes1(GtSainseq *sainseq,
   switch (sainseq->seqtype)
   {
     case GT_SAIN_PLAINSEQ:
+      if (GT_SAIN_PLAINSEQKERNEL(sainseq->numofchars,
+                                 induceLtypesuffixes1) != NULL)
+      {
+        if (sainseq->roundtable == NULL)
+        {
+          GT_SAIN_PLAINSEQKERNEL(sainseq->numofchars,induceLtypesuffixes1)
+            (sainseq,sainseq->seq.plainseq,suftab,nonspecialentries);
+        } else
+        {
+          GT_SAIN_PLAINSEQKERNEL(sainseq->numofchars,
+                                 fast_induceLtypesuffixes1)
+            (sainseq,sainseq->seq.plainseq,suftab,nonspecialentries);
+        }
+        break;
+      }
       (sainseq->roundtable == NULL
         ? gt_sain_PLAINSEQ_induceLtypesuffixes1
         : gt_sain_PLAINSEQ_fast_induceLtypesuffixes1)
            (sainseq,sainseq->seq.plainseq,suftab,nonspecialentries);
       break;
+    case GT_SAIN_TWOBITSEQ:
+      (sainseq->roundtable == NULL
+        ? gt_sain_TWOBITSEQ4_induceLtypesuffixes1
+        : gt_sain_TWOBITSEQ4_fast_induceLtypesuffixes1)
+           (sainseq,sainseq->seq.twobitseq,suftab,nonspecialentries);
+      break;
     case GT_SAIN_LONGSEQ:
       (sainseq->roundtable == NULL
         ? gt_sain_LONGSEQ_induceLtypesuffixes1
@@ -1243,11 +1552,32 @@ static void gt_sain_induceStypesuffixes1(GtSainseq *sainseq,
   switch (sainseq->seqtype)
   {
     case GT_SAIN_PLAINSEQ:
+      if (GT_SAIN_PLAINSEQKERNEL(sainseq->numofchars,
+                                 induceStypesuffixes1) != NULL)
+      {
+        if (sainseq->roundtable == NULL)
+        {
+          GT_SAIN_PLAINSEQKERNEL(sainseq->numofchars,induceStypesuffixes1)
+            (sainseq,sainseq->seq.plainseq,suftab,nonspecialentries);
+        } else
+        {
+          GT_SAIN_PLAINSEQKERNEL(sainseq->numofchars,
+                                 fast_induceStypesuffixes1)
+            (sainseq,sainseq->seq.plainseq,suftab,nonspecialentries);
+        }
+        break;
+      }
       (sainseq->roundtable == NULL
         ? gt_sain_PLAINSEQ_induceStypesuffixes1
         : gt_sain_PLAINSEQ_fast_induceStypesuffixes1)
            (sainseq,sainseq->seq.plainseq,suftab,nonspecialentries);
       break;
+    case GT_SAIN_TWOBITSEQ:
+      (sainseq->roundtable == NULL
+        ? gt_sain_TWOBITSEQ4_induceStypesuffixes1
+        : gt_sain_TWOBITSEQ4_fast_induceStypesuffixes1)
+           (sainseq,sainseq->seq.twobitseq,suftab,nonspecialentries);
+      break;
     case GT_SAIN_LONGSEQ:
       (sainseq->roundtable == NULL
         ? gt_sain_LONGSEQ_induceStypesuffixes1
@@ -1400,12 +1730,23 @@ static void gt_sain_induceLtypesuffixes2(const GtSainseq *sainseq,
   switch (sainseq->seqtype)
   {
     case GT_SAIN_PLAINSEQ:
+      if (GT_SAIN_PLAINSEQKERNEL(sainseq->numofchars,
+                                 induceLtypesuffixes2) != NULL)
+      {
+        GT_SAIN_PLAINSEQKERNEL(sainseq->numofchars,induceLtypesuffixes2)
+          (sainseq,sainseq->seq.plainseq,suftab,nonspecialentries);
+        break;
+      }
       gt_sain_PLAINSEQ_induceLtypesuffixes2(sainseq->bucketfillptr,
                                             sainseq->seq.plainseq,
                                             sainseq->numofchars,
                                             suftab,
                                             nonspecialentries);
       break;
+    case GT_SAIN_TWOBITSEQ:
+      gt_sain_TWOBITSEQ4_induceLtypesuffixes2(sainseq,sainseq->seq.twobitseq,
+                                              suftab,nonspecialentries);
+      break;
     case GT_SAIN_LONGSEQ:
       gt_sain_LONGSEQ_induceLtypesuffixes2(sainseq->bucketfillptr,
                                            sainseq->seq.array,
@@ -1447,9 +1788,20 @@ static void gt_sain_induceStypesuffixes2(const GtSainseq *sainseq,
   switch (sainseq->seqtype)
   {
     case GT_SAIN_PLAINSEQ:
+      if (GT_SAIN_PLAINSEQKERNEL(sainseq->numofchars,
+                                 induceStypesuffixes2) != NULL)
+      {
+        GT_SAIN_PLAINSEQKERNEL(sainseq->numofchars,induceStypesuffixes2)
+          (sainseq,sainseq->seq.plainseq,suftab,nonspecialentries);
+        break;
+      }
       gt_sain_PLAINSEQ_induceStypesuffixes2(sainseq,sainseq->seq.plainseq,
                                             suftab,nonspecialentries);
       break;
+    case GT_SAIN_TWOBITSEQ:
+      gt_sain_TWOBITSEQ4_induceStypesuffixes2(sainseq,sainseq->seq.twobitseq,
+                                              suftab,nonspecialentries);
+      break;
     case GT_SAIN_LONGSEQ:
       gt_sain_LONGSEQ_induceStypesuffixes2(sainseq,sainseq->seq.array,
                                            suftab,nonspecialentries);
@@ -1672,6 +2024,10 @@ static void gt_sain_expandorder2original(GtSainseq *sainseq,
       gt_sain_PLAINSEQ_expandorder2original(sainseq,sainseq->seq.plainseq,
                                             numberofsuffixes,suftab);
       break;
+    case GT_SAIN_TWOBITSEQ:
+      gt_sain_TWOBITSEQ_expandorder2original(sainseq,sainseq->seq.twobitseq,
+                                             numberofsuffixes,suftab);
+      break;
     case GT_SAIN_LONGSEQ:
       gt_sain_LONGSEQ_expandorder2original(sainseq,sainseq->seq.array,
                                            numberofsuffixes,suftab);
@@ -1762,7 +2118,10 @@ static void gt_sain_rec_sortsuffixes(FILE *outfp,
                                      GtSKtimer *sktimer)
 {
   unsigned long countSstartype;
+  RunstatsMark mark;
 
+  GT_SKTRACE_BEGIN("sain level",sainseq->totallength);
+  runstats_mark(&mark);
   if (outfp != NULL)
   {
     fprintf(outfp,"level %u: sort sequence of length %lu over "
@@ -1808,11 +2167,6 @@ static void gt_sain_rec_sortsuffixes(FILE *outfp,
                                                    (Sint *) suftab,
                                                    nonspecialentries);
       SHOWTIMER("fast moveSstar2front")
-      if (!sainseq->roundtablepoints2suftab)
-      {
-        gt_free(sainseq->roundtable);
-        sainseq->roundtable = NULL;
-      }
       gt_sain_fast_assignSstarnames(sainseq->totallength,countSstartype,suftab,
                                     numberofnames,nonspecialentries);
       SHOWTIMER("fast assignSstarnames");
@@ -1823,7 +2177,7 @@ static void gt_sain_rec_sortsuffixes(FILE *outfp,
     /* Now the name sequence is in the range from
        countSstartype .. 2 * countSstartype - 1 */
       Uint *subseq = suftab + countSstartype;
-      GtSainseq *sainseq_rec;
+      GtSainseq sainseq_rec;
 
       gt_sain_setundefined(true,suftab,0,countSstartype-1);
       gt_sain_movenames2front(suftab,countSstartype,sainseq->totallength);
@@ -1832,22 +2186,24 @@ static void gt_sain_rec_sortsuffixes(FILE *outfp,
       {
         firstusable = GT_MULT2(countSstartype);
       }
-      sainseq_rec = gt_sainseq_new_from_array(subseq,
-                                              countSstartype,
-                                              numberofnames,
-                                              suftab,
-                                              firstusable,
-                                              suftabentries);
+      gt_sainseq_init_from_array(&sainseq_rec,
+                                 sainseq->workspace,
+                                 subseq,
+                                 countSstartype,
+                                 numberofnames,
+                                 sainseq->method,
+                                 suftab,
+                                 firstusable,
+                                 suftabentries);
       gt_sain_rec_sortsuffixes(outfp,
                                level+1,
-                               sainseq_rec,
+                               &sainseq_rec,
                                suftab,
                                firstusable,
                                countSstartype,
                                suftabentries,
                                intermediatecheck,
                                sktimer);
-      gt_sainseq_delete(sainseq_rec);
       if (outfp != NULL)
       {
         fprintf(outfp,"level %u: complete\n",level+1);
@@ -1886,34 +2242,75 @@ static void gt_sain_rec_sortsuffixes(FILE *outfp,
   gt_sain_induceLtypesuffixes2(sainseq,
                                (Sint *) suftab,
                                nonspecialentries);
-  SHOWTIMER(sainseq->seqtype == GT_SAIN_PLAINSEQ
+  SHOWTIMER(sainseq->seqtype != GT_SAIN_LONGSEQ
               ? "plain final induce L suffixes"
               : "array final induce L suffixes");
   gt_sain_endbuckets(sainseq);
   gt_sain_induceStypesuffixes2(sainseq,(Sint *) suftab,nonspecialentries);
-  SHOWTIMER(sainseq->seqtype == GT_SAIN_PLAINSEQ
+  SHOWTIMER(sainseq->seqtype != GT_SAIN_LONGSEQ
              ? "plain final induce S suffixes"
              : "array final induce S suffixes");
   if (nonspecialentries > 0 && intermediatecheck)
   {
     gt_sain_checkorder(sainseq,suftab,0,nonspecialentries-1);
   }
+  runstats_sain_level(level,&mark,sainseq->totallength,sainseq->numofchars);
+  GT_SKTRACE_END;
 }
 
-Uint *gt_sain_plain_sortsuffixes(bool silent,
-                                 const GtUchar *plainseq,
+/* the largest dense alphabet, for which the sequence is copied */
+#define GT_SAIN_DENSEMAX 64UL
+
+/* map the characters of <plainseq> of length <len> to a dense alphabet
+   keeping their order, which keeps the order of the suffixes. Then the
+   tables of the first level have one entry per character occurring in
+   <plainseq>, whose number is stored in <numofchars>. Returns NULL if
+   all characters of the alphabet or more than GT_SAIN_DENSEMAX characters
+   occur, as then no specialized induction saves the copy */
+static GtUchar *gt_sain_densealphabet(const GtUchar *plainseq,
+                                      unsigned long len,
+                                      unsigned long *numofchars)
+{
+  bool occurs[UCHAR_MAX+1] = {false};
+  GtUchar map[UCHAR_MAX+1], *dense;
+  unsigned long idx, charidx, numofdensechars = 0;
+
+  for (idx = 0; idx < len; idx++)
+  {
+    occurs[plainseq[idx]] = true;
+  }
+  for (charidx = 0; charidx <= UCHAR_MAX; charidx++)
+  {
+    if (occurs[charidx])
+    {
+      map[charidx] = (GtUchar) numofdensechars++;
+    }
+  }
+  if (numofdensechars == 0 || numofdensechars >= *numofchars ||
+      numofdensechars > GT_SAIN_DENSEMAX)
+  {
+    return NULL;
+  }
+  dense = (GtUchar *) gt_malloc_large((size_t) len);
+  for (idx = 0; idx < len; idx++)
+  {
+    dense[idx] = map[plainseq[idx]];
+  }
+  *numofchars = numofdensechars;
+  return dense;
+}
+
+/* sort the suffixes of the sequence of the first level <sainseq> of
+   length <len> into <suftab> of <len>+1 entries */
+static void gt_sain_sortsuffixes(bool silent,
+                                 GtSainseq *sainseq,
+                                 Uint *suftab,
                                  unsigned long len,
-                                 unsigned long numofchars,
                                  bool intermediatecheck,
                                  GtSKtimer *sktimer)
 {
-  unsigned long suftabentries;
-  Uint *suftab;
-  GtSainseq *sainseq;
+  const unsigned long suftabentries = len+1;
 
-  suftabentries = len+1;
-  suftab = (Uint *) gt_calloc((size_t) suftabentries,sizeof *suftab);
-  sainseq = gt_sainseq_new_from_plainseq(plainseq,len,numofchars);
   (void) gt_sain_rec_sortsuffixes(silent ? NULL : stdout,
                                   0,
                                   sainseq,
@@ -1924,7 +2321,6 @@ Uint *gt_sain_plain_sortsuffixes(bool silent,
                                   intermediatecheck,
                                   sktimer);
   suftab[suftabentries-1] = suftabentries-1;
-  gt_sainseq_delete(sainseq);
   if (!silent)
   {
     printf("sequentialcharaccess=%lu (%.2f)\n",sequentialcharaccess,
@@ -1932,17 +2328,131 @@ Uint *gt_sain_plain_sortsuffixes(bool silent,
     printf("randomcharaccess=%lu (%.2f)\n",randomcharaccess,
                 (double) randomcharaccess/len);
   }
+}
+
+Uint *gt_sain_plain_sortsuffixes(bool silent,
+                                 const GtUchar *plainseq,
+                                 unsigned long len,
+                                 unsigned long numofchars,
+                                 GtSainMethod method,
+                                 bool intermediatecheck,
+                                 GtSKtimer *sktimer)
+{
+  Uint *suftab;
+  GtSainseq sainseq;
+  GtSainworkspace workspace;
+  GtUchar *dense;
+
+  suftab = (Uint *) gt_calloc_large((size_t) (len+1),sizeof *suftab);
+  dense = gt_sain_densealphabet(plainseq,len,&numofchars);
+  if (dense != NULL)
+  {
+    plainseq = dense;
+  }
+  gt_sainworkspace_init(&workspace,numofchars);
+  gt_sainseq_init_from_plainseq(&sainseq,&workspace,plainseq,len,numofchars,
+                                method);
+  gt_sain_sortsuffixes(silent,&sainseq,suftab,len,intermediatecheck,sktimer);
+  gt_sainworkspace_wrap(&workspace);
+  gt_free(dense);
+  return suftab;
+}
+
+Uint *gt_sain_twobit_sortsuffixes(bool silent,
+                                  const GtTwobitencoding *twobitseq,
+                                  unsigned long len,
+                                  GtSainMethod method,
+                                  bool intermediatecheck,
+                                  GtSKtimer *sktimer)
+{
+  Uint *suftab;
+  GtSainseq sainseq;
+  GtSainworkspace workspace;
+
+  suftab = (Uint *) gt_calloc_large((size_t) (len+1),sizeof *suftab);
+  gt_sainworkspace_init(&workspace,4UL);
+  gt_sainseq_init_from_twobitseq(&sainseq,&workspace,twobitseq,len,method);
+  gt_sain_sortsuffixes(silent,&sainseq,suftab,len,intermediatecheck,sktimer);
+  gt_sainworkspace_wrap(&workspace);
   return suftab;
 }
 
+GtTwobitencoding *gt_sain_twobitencoding_new(const GtUchar *sequence,
+                                             unsigned long len)
+{
+  const unsigned long numofunits = len / GT_UNITSIN2BITENC + 1;
+  GtTwobitencoding *twobitseq, unit = 0;
+  unsigned long idx;
+
+  twobitseq = (GtTwobitencoding *) gt_malloc_large(sizeof (*twobitseq) *
+                                                   (size_t) numofunits);
+  for (idx = 0; idx < len; idx++)
+  {
+    GtTwobitencoding code;
+
+    switch (sequence[idx])
+    {
+      case 'A':
+        code = 0;
+        break;
+      case 'C':
+        code = (GtTwobitencoding) 1;
+        break;
+      case 'G':
+        code = (GtTwobitencoding) 2;
+        break;
+      case 'T':
+        code = (GtTwobitencoding) 3;
+        break;
+      default:
+        gt_free(twobitseq);
+        return NULL;
+    }
+    unit = (unit << 2) | code;
+    if (idx % GT_UNITSIN2BITENC == GT_UNITSIN2BITENC - 1)
+    {
+      twobitseq[idx / GT_UNITSIN2BITENC] = unit;
+      unit = 0;
+    }
+  }
+  /* the last unit is filled with A */
+  twobitseq[len / GT_UNITSIN2BITENC]
+    = unit << GT_MULT2(GT_UNITSIN2BITENC - len % GT_UNITSIN2BITENC - 1) << 2;
+  return twobitseq;
+}
+
 Uint *gt_sain_sorted_suffixes_new(const GtUchar *sequence,
                                   unsigned long len,
                                   unsigned long numofchars)
+{
+  return gt_sain_sorted_suffixes_method_new(sequence,
+                                            len,
+                                            numofchars,
+                                            GT_SAIN_METHOD_DECIDE);
+}
+
+Uint *gt_sain_sorted_suffixes_method_new(const GtUchar *sequence,
+                                         unsigned long len,
+                                         unsigned long numofchars,
+                                         GtSainMethod method)
 {
   return gt_sain_plain_sortsuffixes(true,
                                     sequence,
                                     len,
                                     numofchars,
+                                    method,
                                     false,
                                     NULL);
 }
+
+Uint *gt_sain_twobit_sorted_suffixes_new(const GtTwobitencoding *twobitseq,
+                                         unsigned long len,
+                                         GtSainMethod method)
+{
+  return gt_sain_twobit_sortsuffixes(true,
+                                     twobitseq,
+                                     len,
+                                     method,
+                                     false,
+                                     NULL);
+}
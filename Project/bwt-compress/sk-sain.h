@@ -22,13 +22,56 @@
 #include "sktimer.h"
 #include "gt-defs.h"
 
+/* The method to name the S*-substrings on each level of the recursion:
+   the fast method marks the names in a table of 2 * numofchars entries
+   and requires the two most significant bits of the values, the space
+   efficient one does without the table. By default, the fast method is
+   used if the sequence is longer than 1024 and at least twice as long as
+   the alphabet. */
+
+typedef enum
+{
+  GT_SAIN_METHOD_DECIDE,
+  GT_SAIN_METHOD_FAST,
+  GT_SAIN_METHOD_SPACE
+} GtSainMethod;
+
+/* Besides the suffix array of n+1 entries for a sequence of length n
+   over an alphabet of size sigma, the sorting allocates its workspace
+   once: 5 * sigma entries for the tables of the first level, 2^17
+   entries for the buffers of the insertion of the S*-suffixes (2^16 if
+   the entries have 8 bytes) and, if the tables of the deeper levels do
+   not fit into the end of the suffix array, at most 2c entries for
+   them, where c <= n/2 is the number of S*-suffixes of the sequence.
+   With GT_SAIN_METHOD_FAST these are at most 4c entries. The end of
+   the suffix array suffices if c <= (n+1)/4, or c <= (n+1)/6 with
+   GT_SAIN_METHOD_FAST. If at most 64 of the sigma characters occur in
+   the sequence, as for DNA or quality strings, the sequence is copied
+   to n further bytes, in which the characters are mapped to a dense
+   alphabet, for which the first level uses induction functions
+   specialized for 8 or 64 characters. */
+
 Uint *gt_sain_plain_sortsuffixes(bool silent,
                                  const GtUchar *plainseq,
                                  unsigned long len,
                                  unsigned long numofchars,
+                                 GtSainMethod method,
                                  bool intermediatecheck,
                                  GtSKtimer *sktimer);
 
+/* The same as gt_sain_plain_sortsuffixes for a sequence of length <len>
+   over the alphabet {A,C,G,T}, which is read from the 2-bit encoding
+   <twobitseq> delivered by gt_sain_twobitencoding_new. This needs
+   neither the sequence in bytes nor a copy of it on the first level, so
+   the sequence only takes n/4 bytes besides the workspace. */
+
+Uint *gt_sain_twobit_sortsuffixes(bool silent,
+                                  const GtTwobitencoding *twobitseq,
+                                  unsigned long len,
+                                  GtSainMethod method,
+                                  bool intermediatecheck,
+                                  GtSKtimer *sktimer);
+
 /* Given a <sequence> of length <len> containing <numofchars> different
    characters, the following function returns the suffix array SA of length
    <len>+1 containing the start positions of all suffixes of the sequence
@@ -42,4 +85,28 @@ Uint *gt_sain_sorted_suffixes_new(const GtUchar *sequence,
                                   unsigned long len,
                                   unsigned long numofchars);
 
+/* The same as gt_sain_sorted_suffixes_new, but the S*-substrings are
+   named with the given <method> on all levels of the recursion, if the
+   fast method is possible at all. */
+
+Uint *gt_sain_sorted_suffixes_method_new(const GtUchar *sequence,
+                                         unsigned long len,
+                                         unsigned long numofchars,
+                                         GtSainMethod method);
+
+/* Encode the <sequence> of length <len> with two bits per character,
+   A, C, G and T are encoded by 0, 1, 2 and 3, which keeps the order of
+   the suffixes. Returns NULL if another character occurs. The user is
+   responsible to delete the encoding with gt_free. */
+
+GtTwobitencoding *gt_sain_twobitencoding_new(const GtUchar *sequence,
+                                             unsigned long len);
+
+/* The same as gt_sain_sorted_suffixes_method_new for the sequence of
+   length <len> encoded in <twobitseq> by gt_sain_twobitencoding_new. */
+
+Uint *gt_sain_twobit_sorted_suffixes_new(const GtTwobitencoding *twobitseq,
+                                         unsigned long len,
+                                         GtSainMethod method);
+
 #endif
@@ -79,3 +79,159 @@ void gt_SKtimer_delete(GtSKtimer *sktimer)
 {
   free(sktimer);
 }
+
+#ifdef GT_SKTRACE
+
+#include <stdio.h>
+#include <pthread.h>
+
+/* spans recorded per thread before the oldest ones are overwritten,
+   a power of two */
+#define GT_SKTRACE_RINGSIZE (1UL << 16)
+/* nesting depth of spans recorded, deeper spans are ignored */
+#define GT_SKTRACE_MAXDEPTH 64U
+
+typedef struct
+{
+  const char *name;
+  unsigned long start, /* nanoseconds since gt_SKtrace_enable */
+                duration,
+                length;
+} GtSKtraceSpan;
+
+/* The spans of one thread, written only by this thread */
+typedef struct GtSKtraceThread
+{
+  GtSKtraceSpan ring[GT_SKTRACE_RINGSIZE],
+                open[GT_SKTRACE_MAXDEPTH];
+  unsigned long numofspans, tid;
+  unsigned int depth;
+  struct GtSKtraceThread *next;
+} GtSKtraceThread;
+
+static bool gt_sktrace_on = false;
+static struct timespec gt_sktrace_starttime;
+static pthread_mutex_t gt_sktrace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static GtSKtraceThread *gt_sktrace_threads = NULL;
+static unsigned long gt_sktrace_numofthreads = 0;
+static __thread GtSKtraceThread *gt_sktrace_self = NULL;
+
+static unsigned long gt_sktrace_now(void)
+{
+  struct timespec now;
+
+  (void) clock_gettime(CLOCK_MONOTONIC,&now);
+  return (unsigned long) (now.tv_sec - gt_sktrace_starttime.tv_sec)
+         * 1000000000UL + now.tv_nsec - gt_sktrace_starttime.tv_nsec;
+}
+
+/* the buffer of a thread is registered when it begins its first span,
+   this is the only access to the mutex while recording */
+static GtSKtraceThread *gt_sktrace_thread(void)
+{
+  if (gt_sktrace_self == NULL)
+  {
+    GtSKtraceThread *thread = malloc(sizeof *thread);
+
+    if (thread == NULL)
+    {
+      fprintf(stderr,"%s: cannot allocate span buffer\n",__func__);
+      exit(EXIT_FAILURE);
+    }
+    thread->numofspans = 0;
+    thread->depth = 0;
+    pthread_mutex_lock(&gt_sktrace_mutex);
+    thread->tid = gt_sktrace_numofthreads++;
+    thread->next = gt_sktrace_threads;
+    gt_sktrace_threads = thread;
+    pthread_mutex_unlock(&gt_sktrace_mutex);
+    gt_sktrace_self = thread;
+  }
+  return gt_sktrace_self;
+}
+
+void gt_SKtrace_enable(void)
+{
+  (void) clock_gettime(CLOCK_MONOTONIC,&gt_sktrace_starttime);
+  gt_sktrace_on = true;
+}
+
+void gt_SKtrace_begin(const char *name, unsigned long length)
+{
+  if (gt_sktrace_on)
+  {
+    GtSKtraceThread *thread = gt_sktrace_thread();
+
+    if (thread->depth < GT_SKTRACE_MAXDEPTH)
+    {
+      GtSKtraceSpan *span = thread->open + thread->depth;
+
+      span->name = name;
+      span->length = length;
+      span->start = gt_sktrace_now();
+    }
+    thread->depth++;
+  }
+}
+
+void gt_SKtrace_end(void)
+{
+  GtSKtraceThread *thread = gt_sktrace_self;
+
+  /* a thread which has not begun a span while the tracer was on has no
+     buffer */
+  if (gt_sktrace_on && thread != NULL && thread->depth > 0)
+  {
+    thread->depth--;
+    if (thread->depth < GT_SKTRACE_MAXDEPTH)
+    {
+      GtSKtraceSpan *span = thread->ring + (thread->numofspans
+                                            & (GT_SKTRACE_RINGSIZE - 1));
+
+      *span = thread->open[thread->depth];
+      span->duration = gt_sktrace_now() - span->start;
+      thread->numofspans++;
+    }
+  }
+}
+
+void gt_SKtrace_dump(FILE *fp)
+{
+  GtSKtraceThread *thread, *next;
+  unsigned long dropped = 0;
+  bool first = true;
+
+  gt_sktrace_on = false;
+  pthread_mutex_lock(&gt_sktrace_mutex);
+  fprintf(fp,"{\"traceEvents\":[\n");
+  for (thread = gt_sktrace_threads; thread != NULL; thread = next)
+  {
+    unsigned long idx = thread->numofspans > GT_SKTRACE_RINGSIZE
+                        ? thread->numofspans - GT_SKTRACE_RINGSIZE : 0;
+
+    fprintf(fp,"%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+               "\"tid\":%lu,\"args\":{\"name\":\"thread %lu\"}}",
+            first ? "" : ",\n",thread->tid,thread->tid);
+    first = false;
+    dropped += idx;
+    for (/* Nothing */; idx < thread->numofspans; idx++)
+    {
+      const GtSKtraceSpan *span
+        = thread->ring + (idx & (GT_SKTRACE_RINGSIZE - 1));
+
+      fprintf(fp,",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,"
+                 "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"length\":%lu}}",
+              span->name,thread->tid,span->start/1000.0,
+              span->duration/1000.0,span->length);
+    }
+    next = thread->next;
+    free(thread);
+  }
+  fprintf(fp,"\n],\"displayTimeUnit\":\"ms\","
+             "\"otherData\":{\"droppedspans\":%lu}}\n",dropped);
+  gt_sktrace_threads = NULL;
+  gt_sktrace_numofthreads = 0;
+  pthread_mutex_unlock(&gt_sktrace_mutex);
+}
+
+#endif
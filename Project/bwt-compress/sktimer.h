@@ -1,6 +1,8 @@
 #ifndef SKTIMER_H
 #define SKTIMER_H
 
+#include <stdio.h>
+
 typedef struct GtSKtimer GtSKtimer;
 
 GtSKtimer *gt_SKtimer_new(void);
@@ -13,4 +15,45 @@ double gt_SKtimer_total(GtSKtimer *sktimer);
 
 void gt_SKtimer_delete(GtSKtimer *sktimer);
 
+/* The span tracer records named, possibly nested spans of time of each
+   thread and writes them as a timeline in the Chrome trace event format,
+   which is shown by Perfetto or chrome://tracing. It is compiled in if
+   GT_SKTRACE is defined, otherwise the macros GT_SKTRACE_BEGIN and
+   GT_SKTRACE_END expand to nothing. Each thread records its spans in its
+   own ring buffer without locks; if the buffer is full, the oldest spans
+   are overwritten. */
+
+#ifdef GT_SKTRACE
+
+/* Start the recording of spans, spans begun before are ignored. */
+
+void gt_SKtrace_enable(void);
+
+/* Begin a span of the current thread with the given <name>, which must
+   remain valid until gt_SKtrace_dump, and an argument <length>, e.g. the
+   number of bytes processed in the span. */
+
+void gt_SKtrace_begin(const char *name, unsigned long length);
+
+/* End the span of the current thread begun last. */
+
+void gt_SKtrace_end(void);
+
+/* Write the recorded spans as trace event JSON to <fp>, stop the
+   recording and release the buffers. All threads which recorded spans
+   must have finished their spans, the recording can not be
+   restarted. */
+
+void gt_SKtrace_dump(FILE *fp);
+
+#define GT_SKTRACE_BEGIN(NAME,LENGTH) gt_SKtrace_begin(NAME,LENGTH)
+#define GT_SKTRACE_END                gt_SKtrace_end()
+
+#else
+
+#define GT_SKTRACE_BEGIN(NAME,LENGTH) /* Nothing */
+#define GT_SKTRACE_END                /* Nothing */
+
+#endif
+
 #endif
@@ -0,0 +1,54 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <stdbool.h>
+#include "gt-defs.h"
+
+/* The maximum number of bytes required to store an unsigned long
+   as a variable length integer. */
+
+#define VARINT_MAXBYTES 10
+
+/* The following function stores <value> at <dest> as a variable length
+   integer, i.e. in groups of 7 bits, least significant group first,
+   where the high bit of each byte signals that another byte follows.
+   It returns the number of bytes written, which is at most
+   VARINT_MAXBYTES. */
+
+static inline unsigned long varint_put(GtUchar *dest, unsigned long value) {
+  unsigned long idx = 0;
+
+  while (value >= 0x80UL) {
+    dest[idx++] = (GtUchar) (value | 0x80UL);
+    value >>= 7;
+  }
+  dest[idx++] = (GtUchar) value;
+  return idx;
+}
+
+/* The following function reads a variable length integer from the
+   memory area starting at <*src> and ending before <end>. It stores the
+   integer in <value> and advances <*src> behind the integer. If the
+   integer is not properly terminated before <end>, then false is
+   returned. */
+
+static inline bool varint_get(const GtUchar **src, const GtUchar *end,
+    unsigned long *value) {
+  const GtUchar *ptr = *src;
+  unsigned int shift = 0;
+
+  *value = 0;
+  while (ptr < end && shift < 64U) {
+    const GtUchar byte = *ptr++;
+
+    *value |= (unsigned long) (byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      *src = ptr;
+      return true;
+    }
+    shift += 7;
+  }
+  return false;
+}
+
+#endif
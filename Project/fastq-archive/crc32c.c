@@ -0,0 +1,97 @@
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include "crc32c.h"
+
+#define CRC32C_POLYNOMIAL 0x82F63B78U
+
+static uint32_t crc32c_table[8][256];
+static pthread_once_t crc32c_table_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Compute the tables for the
+ * slicing-by-8 algorithm
+ */
+static void crc32c_table_init(void) {
+  uint32_t i, j;
+
+  for (i = 0; i < 256U; i++) {
+    uint32_t crc = i;
+
+    for (j = 0; j < 8U; j++) {
+      crc = (crc & 1U) ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1;
+    }
+    crc32c_table[0][i] = crc;
+  }
+  for (i = 0; i < 256U; i++) {
+    for (j = 1; j < 8U; j++) {
+      crc32c_table[j][i] = (crc32c_table[j - 1][i] >> 8)
+          ^ crc32c_table[0][crc32c_table[j - 1][i] & 0xFF];
+    }
+  }
+}
+
+static uint32_t crc32c_software(uint32_t crc, const unsigned char *ptr,
+    size_t length) {
+
+  pthread_once(&crc32c_table_once, crc32c_table_init);
+  while (length >= 8) {
+    uint32_t low, high;
+
+    memcpy(&low, ptr, sizeof low);
+    memcpy(&high, ptr + 4, sizeof high);
+    low ^= crc;
+    crc = crc32c_table[7][low & 0xFF] ^ crc32c_table[6][(low >> 8) & 0xFF]
+        ^ crc32c_table[5][(low >> 16) & 0xFF] ^ crc32c_table[4][low >> 24]
+        ^ crc32c_table[3][high & 0xFF] ^ crc32c_table[2][(high >> 8) & 0xFF]
+        ^ crc32c_table[1][(high >> 16) & 0xFF] ^ crc32c_table[0][high >> 24];
+    ptr += 8;
+    length -= 8;
+  }
+  while (length-- > 0) {
+    crc = crc32c_table[0][(crc ^ *ptr++) & 0xFF] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <nmmintrin.h>
+#define CRC32C_HARDWARE
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hardware(uint32_t crc, const unsigned char *ptr,
+    size_t length) {
+  uint64_t crc64 = crc;
+
+  while (length >= 8) {
+    uint64_t word;
+
+    memcpy(&word, ptr, sizeof word);
+    crc64 = _mm_crc32_u64(crc64, word);
+    ptr += 8;
+    length -= 8;
+  }
+  crc = (uint32_t) crc64;
+  while (length-- > 0) {
+    crc = _mm_crc32_u8(crc, *ptr++);
+  }
+  return crc;
+}
+#endif
+
+/* The following function updates the CRC32C checksum (Castagnoli
+ polynomial, as used by iSCSI and ext4) <crc> by the <length> bytes
+ stored at <buffer> and returns the new checksum. The checksum of an
+ empty sequence is 0, so a checksum is computed by calling the
+ function with <crc> equal to 0. If the processor supports SSE4.2,
+ then the crc32 instruction is used. */
+
+uint32_t crc32c(uint32_t crc, const void *buffer, size_t length) {
+  crc = ~crc;
+#ifdef CRC32C_HARDWARE
+  if (__builtin_cpu_supports("sse4.2")) {
+    return ~crc32c_hardware(crc, buffer, length);
+  }
+#endif
+  return ~crc32c_software(crc, buffer, length);
+}
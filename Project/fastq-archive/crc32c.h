@@ -0,0 +1,16 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stddef.h>
+#include <inttypes.h>
+
+/* The following function updates the CRC32C checksum (Castagnoli
+   polynomial, as used by iSCSI and ext4) <crc> by the <length> bytes
+   stored at <buffer> and returns the new checksum. The checksum of an
+   empty sequence is 0, so a checksum is computed by calling the
+   function with <crc> equal to 0. If the processor supports SSE4.2,
+   then the crc32 instruction is used. */
+
+uint32_t crc32c(uint32_t crc, const void *buffer, size_t length);
+
+#endif
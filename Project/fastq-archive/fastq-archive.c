@@ -0,0 +1,1328 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include "../bwt-compress/gt-alloc.h"
+#include "../bwt-compress/sk-sain.h"
+#include "../bwt-compress/sktimer.h"
+#include "../bwt-compress/bwt-compress.h"
+#include "../bwt-compress/rans.h"
+#include "../bwt-compress/qualcm.h"
+#include "../bwt-compress/varint.h"
+#include "../bwt-compress/runstats.h"
+#include "crc32c.h"
+#include "transpose.h"
+#include "seqexcept.h"
+#include "fastq-archive.h"
+
+#define FASTQ_ARCHIVE_MAGIC        "FQZA"
+#define FASTQ_ARCHIVE_BLOCKMAGIC   "FQZB"
+#define FASTQ_ARCHIVE_INDEXMAGIC   "FQZI"
+#define FASTQ_ARCHIVE_TRAILERMAGIC "FQZE"
+#define FASTQ_ARCHIVE_MAGICSIZE    4UL
+
+#define FASTQ_ARCHIVE_BLOCKHEADERSIZE\
+        (FASTQ_ARCHIVE_MAGICSIZE + 8UL + 4UL\
+         + FASTQ_ARCHIVE_NUMOFSECTIONS * FASTQ_ARCHIVE_DESCRIPTORSIZE)
+
+/* the number of bytes searched at once for a trailer */
+#define FASTQ_ARCHIVE_SCANSIZE 4096UL
+
+#define FASTQ_ARCHIVE_INDEXENTRYSIZE\
+        (8UL + 4UL + FASTQ_ARCHIVE_NUMOFSECTIONS\
+                     * (8UL + FASTQ_ARCHIVE_DESCRIPTORSIZE))
+
+#define FASTQ_ARCHIVE_SHOWTIME(STAGE)\
+        if (logfp != NULL)\
+        {\
+          double elapsed = gt_SKtimer_elapsed(sktimer);\
+          fprintf(logfp,"# TIME %s %s %.2f (%.2f MB/s)\n",STAGE,\
+                  fastq_archive_section_name(section),elapsed,\
+                  elapsed > 0.0 ? rawlength / (elapsed * 1000000.0) : 0.0);\
+        }
+
+/* Class to write an archive */
+struct FastqArchiveWriter {
+  FILE * fp;
+  uint64_t offset;
+  unsigned long blocksize, numofblocks, allocatedblocks, numofentries;
+  bool append;
+  FastqArchiveBlock * blocks;
+};
+
+/* Class to read an archive */
+struct FastqArchiveReader {
+  FILE * fp;
+  uint64_t indexoffset,
+           offset, /* the number of bytes read sequentially */
+           length; /* the end of the last valid trailer */
+  unsigned long blocksize, numofblocks, numofentries;
+  GtUchar * extra;
+  unsigned long extralength;
+  bool endofblocks;
+  FastqArchiveBlock * blocks;
+};
+
+/**
+ * Store integers in
+ * little endian byte order
+ */
+static void fastq_archive_put(GtUchar *dest, uint64_t value,
+    unsigned long numofbytes) {
+  unsigned long i;
+
+  for (i = 0; i < numofbytes; i++) {
+    dest[i] = (GtUchar) (value >> (8 * i));
+  }
+}
+
+static uint64_t fastq_archive_get(const GtUchar *src,
+    unsigned long numofbytes) {
+  uint64_t value = 0;
+  unsigned long i;
+
+  for (i = 0; i < numofbytes; i++) {
+    value |= (uint64_t) src[i] << (8 * i);
+  }
+  return value;
+}
+
+/**
+ * Store and read the descriptor
+ * of a section
+ */
+static void fastq_archive_put_descriptor(GtUchar *dest,
+    const FastqArchiveSectioninfo *info) {
+  dest[0] = info->codec;
+  dest[1] = info->flags;
+  fastq_archive_put(dest + 2, info->rawlength, 4UL);
+  fastq_archive_put(dest + 6, info->codedlength, 4UL);
+  fastq_archive_put(dest + 10, info->checksum, 4UL);
+}
+
+static void fastq_archive_get_descriptor(FastqArchiveSectioninfo *info,
+    const GtUchar *src) {
+  info->codec = src[0];
+  info->flags = src[1];
+  info->rawlength = (uint32_t) fastq_archive_get(src + 2, 4UL);
+  info->codedlength = (uint32_t) fastq_archive_get(src + 6, 4UL);
+  info->checksum = (uint32_t) fastq_archive_get(src + 10, 4UL);
+}
+
+static void fastq_archive_write(FastqArchiveWriter *writer,
+    const void *buffer, unsigned long length) {
+  if (length > 0 && fwrite(buffer, 1, (size_t) length, writer->fp) != length) {
+    fprintf(stderr, "Can not write archive\n");
+    exit(EXIT_FAILURE);
+  }
+  writer->offset += length;
+}
+
+static void fastq_archive_read(FILE *fp, void *buffer, unsigned long length) {
+  if (length > 0 && fread(buffer, 1, (size_t) length, fp) != length) {
+    fprintf(stderr, "Archive is truncated\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+/* Deliver the name of <section>, e.g. for messages */
+
+const char *fastq_archive_section_name(FastqArchiveSection section) {
+  static const char *names[] = { "lengths", "header", "sequence", "quality" };
+
+  assert(section < FASTQ_ARCHIVE_NUMOFSECTIONS);
+  return names[section];
+}
+
+/* Deliver the name of <codec>, e.g. for messages */
+
+const char *fastq_archive_codec_name(FastqArchiveCodec codec) {
+  static const char *names[] = { "bwt", "rans", "cm" };
+
+  assert(codec < FASTQ_ARCHIVE_NUMOFCODECS);
+  return names[codec];
+}
+
+/* Store the codec with the given <name> in <codec>. Returns false if
+ there is no such codec. */
+
+bool fastq_archive_codec_parse(FastqArchiveCodec *codec, const char *name) {
+  unsigned long idx;
+
+  for (idx = 0; idx < FASTQ_ARCHIVE_NUMOFCODECS; idx++) {
+    if (strcmp(name, fastq_archive_codec_name(idx)) == 0) {
+      *codec = (FastqArchiveCodec) idx;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * The positions in a section of <numofentries> entries with
+ * the given <entrylengths> at which the inverse suffix array is
+ * sampled: the end of every <samplerate>-th entry and the end of
+ * the last entry
+ */
+static unsigned long *fastq_archive_samples(unsigned long *numofsamples,
+    const unsigned long *entrylengths, unsigned long numofentries,
+    unsigned long samplerate) {
+
+  unsigned long * samples = NULL;
+  unsigned long idx, position = 0;
+
+  *numofsamples = (numofentries + samplerate - 1) / samplerate;
+  samples = gt_malloc((size_t) (*numofsamples + 1) * sizeof *samples);
+  for (idx = 0; idx < numofentries; idx++) {
+    position += entrylengths[idx];
+    if ((idx + 1) % samplerate == 0 || idx + 1 == numofentries) {
+      samples[idx / samplerate] = position;
+    }
+  }
+  return samples;
+}
+
+/**
+ * Deliver the common length of the <numofentries> entries with
+ * the given <entrylengths> whose total length is <rawlength>,
+ * or 0 if the entries differ in length
+ */
+static unsigned long fastq_archive_readlength(
+    const unsigned long *entrylengths, unsigned long numofentries,
+    unsigned long rawlength) {
+
+  unsigned long idx;
+
+  if (numofentries == 0 || entrylengths[0] == 0
+      || entrylengths[0] * numofentries != rawlength) {
+    return 0;
+  }
+  for (idx = 1; idx < numofentries; idx++) {
+    if (entrylengths[idx] != entrylengths[0]) {
+      return 0;
+    }
+  }
+  return entrylengths[0];
+}
+
+/**
+ * The lengths of the entries of a transposed section: one
+ * entry per cycle, consisting of the values of all reads
+ */
+static unsigned long *fastq_archive_cyclelengths(unsigned long readlength,
+    unsigned long numofentries) {
+
+  unsigned long * cyclelengths = gt_malloc(
+      (size_t) readlength * sizeof *cyclelengths);
+  unsigned long idx;
+
+  for (idx = 0; idx < readlength; idx++) {
+    cyclelengths[idx] = numofentries;
+  }
+  return cyclelengths;
+}
+
+/**
+ * Store the <prefixlength> bytes of <prefix> in front of the
+ * <codedlength> bytes of <coded>, which is freed
+ */
+static GtUchar *fastq_archive_prepend(GtUchar *coded,
+    unsigned long *codedlength, const GtUchar *prefix,
+    unsigned long prefixlength) {
+
+  GtUchar * prefixed = gt_malloc((size_t) prefixlength + *codedlength);
+
+  memcpy(prefixed, prefix, (size_t) prefixlength);
+  memcpy(prefixed + prefixlength, coded, (size_t) *codedlength);
+  *codedlength += prefixlength;
+  gt_free(coded);
+  return prefixed;
+}
+
+/* The following function encodes the <rawlength> bytes of <raw> with
+ the given <codec> as section of an archive and stores the code length,
+ the checksum, the codec and the flags in <info>. The returned memory
+ area holds the code, the user is responsible to free it. The caller
+ sets the flags in <info> which describe the raw data, i.e.
+ FASTQ_ARCHIVE_FLAG_BINNED, or request a stage of the encoding.
+ FASTQ_ARCHIVE_FLAG_EXCEPTIONS replaces the characters other than ACGT
+ by a placeholder and stores them in a list in front of the code, the
+ flag is cleared if there are no such characters.
+ FASTQ_ARCHIVE_FLAG_TRANSPOSED stores the values cycle by cycle before
+ they are coded, and it is only applied if all entries have the same
+ length. Otherwise the flag is cleared. The lengths
+ of the <numofentries> entries of the block in this section are given
+ by <entrylengths>, i.e. the lengths of the header lines or of the
+ sequences. They are required by FASTQ_ARCHIVE_CODEC_CM and for
+ sampling. If <samplerate> is not 0 and the codec is
+ FASTQ_ARCHIVE_CODEC_BWT, then the inverse suffix array is sampled at
+ the end of every <samplerate>-th entry and the section is marked with
+ FASTQ_ARCHIVE_FLAG_SAMPLED, see fastq_archive_section_extract. If
+ <logfp> is not NULL, then the time and throughput of each stage of
+ the codec is reported to <logfp>. */
+
+GtUchar *fastq_archive_section_encode(FILE *logfp,
+    FastqArchiveSectioninfo *info, FastqArchiveSection section,
+    FastqArchiveCodec codec, const GtUchar *raw, unsigned long rawlength,
+    const unsigned long *entrylengths, unsigned long numofentries,
+    unsigned long samplerate) {
+
+  GtSKtimer * sktimer = gt_SKtimer_new();
+  GtUchar * coded = NULL;
+  GtUchar * transposed = NULL;
+  GtUchar * cleaned = NULL;
+  GtUchar * exceptions = NULL;
+  unsigned long * cyclelengths = NULL;
+  const GtUchar * input = raw;
+  const unsigned long * inputlengths = entrylengths;
+  unsigned long inputentries = numofentries;
+  BwtContext * context = NULL;
+  RunstatsMark mark;
+  unsigned long codedlength = 0, exceptionslength = 0;
+
+  assert(rawlength <= FASTQ_ARCHIVE_MAXBLOCKSIZE);
+  gt_SKtimer_start(sktimer);
+
+  info->flags &= FASTQ_ARCHIVE_FLAG_BINNED | FASTQ_ARCHIVE_FLAG_TRANSPOSED
+      | FASTQ_ARCHIVE_FLAG_EXCEPTIONS;
+  if (info->flags & FASTQ_ARCHIVE_FLAG_EXCEPTIONS) {
+    unsigned long numofruns;
+
+    cleaned = gt_malloc((size_t) rawlength + 1);
+    exceptions = seqexcept_extract(&exceptionslength, &numofruns, cleaned,
+        raw, rawlength);
+    if (numofruns > 0) {
+      input = cleaned;
+      FASTQ_ARCHIVE_SHOWTIME("exceptions");
+    } else {
+      info->flags &= ~FASTQ_ARCHIVE_FLAG_EXCEPTIONS;
+    }
+  }
+  if (info->flags & FASTQ_ARCHIVE_FLAG_TRANSPOSED) {
+    const unsigned long readlength = fastq_archive_readlength(entrylengths,
+        numofentries, rawlength);
+
+    if (readlength > 0) {
+      transposed = gt_malloc((size_t) rawlength);
+      transpose_bytes(transposed, input, numofentries, readlength);
+      cyclelengths = fastq_archive_cyclelengths(readlength, numofentries);
+      input = transposed;
+      inputlengths = cyclelengths;
+      inputentries = readlength;
+      FASTQ_ARCHIVE_SHOWTIME("transpose");
+    } else {
+      info->flags &= ~FASTQ_ARCHIVE_FLAG_TRANSPOSED;
+    }
+  }
+
+  switch (codec) {
+  case FASTQ_ARCHIVE_CODEC_BWT:
+    context = bwt_context_new(input, rawlength, UCHAR_MAX + 1, NULL);
+    if (rawlength > 0) {
+      (void) bwt_context_sa(context);
+    }
+    FASTQ_ARCHIVE_SHOWTIME("sa");
+    /* the entries of a transposed section are not contiguous */
+    if (samplerate > 0 && section != FASTQ_ARCHIVE_LENGTHS
+        && transposed == NULL) {
+      unsigned long numofsamples;
+      unsigned long * samples = fastq_archive_samples(&numofsamples,
+          entrylengths, numofentries, samplerate);
+      GtUchar prefix[VARINT_MAXBYTES];
+
+      coded = bwt_context_compress_sampled(context, &codedlength, samples,
+          numofsamples);
+      /* the samplerate precedes the code */
+      coded = fastq_archive_prepend(coded, &codedlength, prefix,
+          varint_put(prefix, samplerate));
+      info->flags |= FASTQ_ARCHIVE_FLAG_SAMPLED;
+      gt_free(samples);
+    } else {
+      coded = bwt_context_compress(context, &codedlength);
+    }
+    FASTQ_ARCHIVE_SHOWTIME("encode");
+    bwt_context_delete(context);
+    break;
+  case FASTQ_ARCHIVE_CODEC_RANS:
+    GT_SKTRACE_BEGIN("rans", rawlength);
+    runstats_mark(&mark);
+    coded = rans_encode(&codedlength, input, rawlength);
+    runstats_end(RUNSTATS_ENTROPY, &mark, rawlength);
+    GT_SKTRACE_END;
+    FASTQ_ARCHIVE_SHOWTIME("encode");
+    break;
+  case FASTQ_ARCHIVE_CODEC_CM:
+    /* the context of a quality value is its position in the read, or
+     the read if the section is transposed */
+    assert(section == FASTQ_ARCHIVE_QUALITY);
+    GT_SKTRACE_BEGIN("cm", rawlength);
+    runstats_mark(&mark);
+    coded = qualcm_encode(&codedlength, input, rawlength, inputlengths,
+        inputentries);
+    runstats_end(RUNSTATS_ENTROPY, &mark, rawlength);
+    GT_SKTRACE_END;
+    FASTQ_ARCHIVE_SHOWTIME("encode");
+    break;
+  default:
+    fprintf(stderr, "%s: unknown codec %u\n", __func__, (unsigned int) codec);
+    exit(EXIT_FAILURE);
+  }
+
+  if (info->flags & FASTQ_ARCHIVE_FLAG_EXCEPTIONS) {
+    GtUchar prefix[VARINT_MAXBYTES];
+
+    /* the list of exceptions precedes all other parts of the code */
+    coded = fastq_archive_prepend(coded, &codedlength, exceptions,
+        exceptionslength);
+    coded = fastq_archive_prepend(coded, &codedlength, prefix,
+        varint_put(prefix, exceptionslength));
+  }
+
+  info->codec = (GtUchar) codec;
+  info->rawlength = (uint32_t) rawlength;
+  info->codedlength = (uint32_t) codedlength;
+  info->checksum = crc32c(0, raw, (size_t) rawlength);
+  info->offset = 0;
+
+  gt_free(transposed);
+  gt_free(cleaned);
+  gt_free(exceptions);
+  gt_free(cyclelengths);
+  gt_SKtimer_delete(sktimer);
+  return coded;
+}
+
+/**
+ * Split the code of the section described by <info> into the
+ * list of exceptions, which is empty if the section has no
+ * exceptions, and the code of the codec. The latter is
+ * returned, its length is stored in <codelength>
+ */
+static const GtUchar *fastq_archive_exceptions(const GtUchar **list,
+    unsigned long *listlength, unsigned long *codelength,
+    const FastqArchiveSectioninfo *info, const GtUchar *coded) {
+
+  const GtUchar * ptr = coded, * end = coded + info->codedlength;
+
+  *list = NULL;
+  *listlength = 0;
+  if (info->flags & FASTQ_ARCHIVE_FLAG_EXCEPTIONS) {
+    if (!varint_get(&ptr, end, listlength)
+        || *listlength > (unsigned long) (end - ptr)) {
+      fprintf(stderr, "Archive is corrupted: invalid list of exceptions\n");
+      exit(EXIT_FAILURE);
+    }
+    *list = ptr;
+    ptr += *listlength;
+  }
+  *codelength = (unsigned long) (end - ptr);
+  return ptr;
+}
+
+/**
+ * Read the samplerate in front of the <codelength> bytes of
+ * the <code> of a sampled section and store it in <samplerate>.
+ * Returns the number of bytes to skip
+ */
+static unsigned long fastq_archive_samplerate(unsigned long *samplerate,
+    const GtUchar *code, unsigned long codelength) {
+
+  const GtUchar * ptr = code;
+
+  if (!varint_get(&ptr, code + codelength, samplerate) || *samplerate == 0) {
+    fprintf(stderr, "Archive is corrupted: invalid samplerate\n");
+    exit(EXIT_FAILURE);
+  }
+  return (unsigned long) (ptr - code);
+}
+
+/* The following function decodes the section described by <info> whose
+ code is stored in <coded>. The entry lengths of the block must be
+ the same as for the encoding. The decoded data is verified against
+ the checksum in <info>. If the code is corrupted, the function
+ reports this and exits with an exit code different from 0. The user
+ is responsible to free the returned memory, which stores
+ <info->rawlength> bytes followed by a \0-byte. */
+
+GtUchar *fastq_archive_section_decode(const FastqArchiveSectioninfo *info,
+    const GtUchar *coded, const unsigned long *entrylengths,
+    unsigned long numofentries) {
+
+  GtUchar * raw = NULL;
+  unsigned long * cyclelengths = NULL;
+  const unsigned long * inputlengths = entrylengths;
+  const GtUchar * list = NULL, * code = NULL;
+  unsigned long rawlength = 0, inputentries = numofentries, readlength = 0,
+      listlength, codelength;
+
+  code = fastq_archive_exceptions(&list, &listlength, &codelength, info,
+      coded);
+
+  if (info->flags & FASTQ_ARCHIVE_FLAG_TRANSPOSED) {
+    readlength = fastq_archive_readlength(entrylengths, numofentries,
+        info->rawlength);
+    if (readlength == 0) {
+      fprintf(stderr, "%s: transposed section with entries of different "
+          "lengths\n", __func__);
+      exit(EXIT_FAILURE);
+    }
+    cyclelengths = fastq_archive_cyclelengths(readlength, numofentries);
+    inputlengths = cyclelengths;
+    inputentries = readlength;
+  }
+
+  switch (info->codec) {
+  case FASTQ_ARCHIVE_CODEC_BWT:
+    if (info->flags & FASTQ_ARCHIVE_FLAG_SAMPLED) {
+      unsigned long samplerate;
+      const unsigned long skip = fastq_archive_samplerate(&samplerate, code,
+          codelength);
+
+      raw = bwt_decompress_sampled(&rawlength, code + skip,
+          codelength - skip);
+    } else {
+      raw = bwt_decompress(&rawlength, code, codelength);
+    }
+    break;
+  case FASTQ_ARCHIVE_CODEC_RANS:
+    raw = rans_decode(&rawlength, code, codelength);
+    break;
+  case FASTQ_ARCHIVE_CODEC_CM:
+    raw = qualcm_decode(&rawlength, code, codelength, inputlengths,
+        inputentries);
+    break;
+  default:
+    fprintf(stderr, "%s: unknown codec %u\n", __func__,
+        (unsigned int) info->codec);
+    exit(EXIT_FAILURE);
+  }
+
+  if (raw == NULL) {
+    fprintf(stderr, "%s: %s code is corrupted\n", __func__,
+        fastq_archive_codec_name(info->codec));
+    exit(EXIT_FAILURE);
+  }
+  if (rawlength != info->rawlength) {
+    fprintf(stderr, "Archive is corrupted: section decodes to %lu bytes, "
+        "expected %lu\n", rawlength, (unsigned long) info->rawlength);
+    exit(EXIT_FAILURE);
+  }
+  if (readlength > 0) {
+    GtUchar * transposed = raw;
+
+    raw = gt_malloc((size_t) rawlength + 1);
+    transpose_bytes(raw, transposed, readlength, numofentries);
+    gt_free(transposed);
+    gt_free(cyclelengths);
+  }
+  if (list != NULL && !seqexcept_restore(raw, 0, rawlength, list,
+      listlength)) {
+    fprintf(stderr, "Archive is corrupted: invalid list of exceptions\n");
+    exit(EXIT_FAILURE);
+  }
+  if (crc32c(0, raw, (size_t) rawlength) != info->checksum) {
+    fprintf(stderr, "%s: checksum mismatch\n", __func__);
+    exit(EXIT_FAILURE);
+  }
+  raw = gt_realloc(raw, (size_t) rawlength + 1);
+  raw[rawlength] = '\0';
+  return raw;
+}
+
+/* The following function stores the entries <firstentry> to
+ <firstentry>+<count>-1 of the section described by <info> whose code
+ is stored in <coded> in a new memory area and their total length in
+ <length>. The lengths of the <numofentries> entries of the block in
+ this section are given by <entrylengths>. If the section is sampled,
+ then only the BWT is decoded and walked backwards from the sample
+ following the last of the entries, so that the number of LF-steps is
+ at most the length of the <samplerate>+<count>-1 entries. The
+ checksum can not be verified in this case. Otherwise the whole section
+ is decoded. The user is responsible to free the returned memory, which
+ stores <length> bytes followed by a \0-byte. */
+
+GtUchar *fastq_archive_section_extract(unsigned long *length,
+    const FastqArchiveSectioninfo *info, const GtUchar *coded,
+    const unsigned long *entrylengths, unsigned long numofentries,
+    unsigned long firstentry, unsigned long count) {
+
+  const unsigned long endentry = firstentry + count;
+  unsigned long idx, start = 0, end = 0, total = 0, samplerate, sample,
+      sampleentry, skip, listlength, codelength;
+  const GtUchar * list = NULL, * code = NULL;
+  GtUchar * raw = NULL;
+  BwtIndex * index = NULL;
+
+  assert(endentry <= numofentries);
+  for (idx = 0; idx < numofentries; idx++) {
+    if (idx == firstentry) {
+      start = total;
+    }
+    if (idx == endentry) {
+      end = total;
+    }
+    total += entrylengths[idx];
+  }
+  if (endentry == numofentries) {
+    end = total;
+  }
+  if (total != info->rawlength) {
+    fprintf(stderr, "Archive is corrupted: lengths of the entries differ "
+        "from the length of the section\n");
+    exit(EXIT_FAILURE);
+  }
+  *length = end - start;
+
+  if (info->codec != FASTQ_ARCHIVE_CODEC_BWT
+      || !(info->flags & FASTQ_ARCHIVE_FLAG_SAMPLED) || count == 0) {
+    GtUchar * decoded = fastq_archive_section_decode(info, coded,
+        entrylengths, numofentries);
+
+    raw = gt_malloc((size_t) *length + 1);
+    memcpy(raw, decoded + start, (size_t) *length);
+    raw[*length] = '\0';
+    gt_free(decoded);
+    return raw;
+  }
+
+  code = fastq_archive_exceptions(&list, &listlength, &codelength, info,
+      coded);
+  skip = fastq_archive_samplerate(&samplerate, code, codelength);
+  index = bwt_index_new(code + skip, codelength - skip);
+  sample = (endentry + samplerate - 1) / samplerate - 1;
+  if (bwt_index_seqlength(index) != info->rawlength
+      || bwt_index_numofsamples(index)
+          != (numofentries + samplerate - 1) / samplerate) {
+    fprintf(stderr, "Archive is corrupted: invalid samples\n");
+    exit(EXIT_FAILURE);
+  }
+
+  /* the distance of the sampled position behind the entries */
+  sampleentry = (sample + 1) * samplerate;
+  if (sampleentry > numofentries) {
+    sampleentry = numofentries;
+  }
+  for (idx = endentry, skip = 0; idx < sampleentry; idx++) {
+    skip += entrylengths[idx];
+  }
+  raw = gt_malloc((size_t) *length + 1);
+  bwt_index_extract(raw, index, sample, skip, *length);
+  raw[*length] = '\0';
+  if (list != NULL && !seqexcept_restore(raw, start, *length, list,
+      listlength)) {
+    fprintf(stderr, "Archive is corrupted: invalid list of exceptions\n");
+    exit(EXIT_FAILURE);
+  }
+  bwt_index_delete(index);
+  return raw;
+}
+
+/* The following function checks that the section described by <info>
+ whose code is stored in <coded> is decoded to the <rawlength> bytes of
+ <raw>, which consist of the <numofentries> entries whose lengths are
+ given by <entrylengths>. If the section is sampled, then only the BWT
+ is decoded and walked backwards over <numofranges> ranges between two
+ consecutive samples, which are chosen pseudo-randomly from <seed>.
+ This checks every stage of the code but only a small part of the
+ LF-mapping, at a fraction of the cost of the inversion of the BWT.
+ Otherwise the whole section is decoded and compared. Returns false if
+ a difference is found. */
+
+bool fastq_archive_section_spotcheck(const FastqArchiveSectioninfo *info,
+    const GtUchar *coded, const GtUchar *raw, unsigned long rawlength,
+    const unsigned long *entrylengths, unsigned long numofentries,
+    unsigned long numofranges, unsigned long seed) {
+
+  const GtUchar * list = NULL, * code = NULL;
+  unsigned long * offsets = NULL;
+  unsigned long idx, range, samplerate, numofsamples, skip, listlength,
+      codelength;
+  uint64_t state = (uint64_t) seed * 0x9E3779B97F4A7C15ULL + 1;
+  GtUchar * extracted = NULL;
+  BwtIndex * index = NULL;
+  bool equal = true;
+
+  if (info->codec != FASTQ_ARCHIVE_CODEC_BWT
+      || !(info->flags & FASTQ_ARCHIVE_FLAG_SAMPLED) || numofentries == 0) {
+    GtUchar * decoded = fastq_archive_section_decode(info, coded,
+        entrylengths, numofentries);
+
+    equal = memcmp(raw, decoded, (size_t) rawlength) == 0;
+    gt_free(decoded);
+    return equal;
+  }
+
+  offsets = gt_malloc((size_t) (numofentries + 1) * sizeof *offsets);
+  for (idx = 0, offsets[0] = 0; idx < numofentries; idx++) {
+    offsets[idx + 1] = offsets[idx] + entrylengths[idx];
+  }
+  code = fastq_archive_exceptions(&list, &listlength, &codelength, info,
+      coded);
+  skip = fastq_archive_samplerate(&samplerate, code, codelength);
+  index = bwt_index_new(code + skip, codelength - skip);
+  numofsamples = (numofentries + samplerate - 1) / samplerate;
+  if (offsets[numofentries] != rawlength
+      || bwt_index_seqlength(index) != rawlength
+      || bwt_index_numofsamples(index) != numofsamples) {
+    equal = false;
+  }
+
+  for (range = 0; equal && range < numofranges; range++) {
+    unsigned long sample, first, end, length;
+
+    /* xorshift, the ranges only need to differ from block to block */
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    sample = (unsigned long) (state % numofsamples);
+    first = sample * samplerate;
+    end = first + samplerate < numofentries ? first + samplerate
+        : numofentries;
+    length = offsets[end] - offsets[first];
+    extracted = gt_realloc(extracted, (size_t) length + 1);
+    bwt_index_extract(extracted, index, sample, 0, length);
+    if (list != NULL && !seqexcept_restore(extracted, offsets[first], length,
+        list, listlength)) {
+      equal = false;
+    } else {
+      equal = memcmp(extracted, raw + offsets[first], (size_t) length) == 0;
+    }
+  }
+  gt_free(extracted);
+  bwt_index_delete(index);
+  gt_free(offsets);
+  return equal;
+}
+
+/* The following function parses the <rawlength> bytes of the decoded
+ lengths section <raw> of a block with <numofentries> entries and
+ stores the lengths of the header lines in <headerlengths> and the
+ lengths of the sequences in <seqlengths>. Returns false if the
+ section does not store exactly <numofentries> pairs of lengths. */
+
+bool fastq_archive_lengths_parse(unsigned long *headerlengths,
+    unsigned long *seqlengths, unsigned long numofentries,
+    const GtUchar *raw, unsigned long rawlength) {
+
+  const GtUchar * end = raw + rawlength;
+  unsigned long idx;
+
+  for (idx = 0; idx < numofentries; idx++) {
+    if (!varint_get(&raw, end, headerlengths + idx)
+        || !varint_get(&raw, end, seqlengths + idx)) {
+      return false;
+    }
+  }
+  return raw == end;
+}
+
+/* Deliver an upper bound for the number of bytes of workspace required
+ to encode, if <encode> is true, or to decode a section of <rawlength>
+ bytes with the given <codec> and <flags>. The raw and the coded data
+ are not included. */
+
+unsigned long fastq_archive_section_memory(FastqArchiveCodec codec,
+    GtUchar flags, unsigned long rawlength, bool encode) {
+
+  unsigned long needed = 0;
+
+  switch (codec) {
+  case FASTQ_ARCHIVE_CODEC_BWT:
+    if (encode) {
+      /* suffix array, BWT and MTF buffers */
+      needed = (sizeof (Uint) + 2) * (rawlength + 1UL);
+    } else {
+      /* lf and rank arrays of bwt_decode, MTF and BWT buffers */
+      needed = (2 * sizeof (unsigned long) + 3) * (rawlength + 1UL);
+    }
+    break;
+  case FASTQ_ARCHIVE_CODEC_RANS:
+    needed = rawlength;
+    break;
+  case FASTQ_ARCHIVE_CODEC_CM:
+    /* the models for 8 bit ranks */
+    needed = rawlength + (16UL << 20);
+    break;
+  default:
+    break;
+  }
+  if (flags & FASTQ_ARCHIVE_FLAG_TRANSPOSED) {
+    needed += rawlength;
+  }
+  if (encode && (flags & FASTQ_ARCHIVE_FLAG_EXCEPTIONS)) {
+    needed += rawlength;
+  }
+  return needed;
+}
+
+/* Deliver an upper bound for the number of bytes of memory required to
+ decode the sections of <block> one after the other, including the
+ coded and the decoded sections. */
+
+unsigned long fastq_archive_block_memory(const FastqArchiveBlock *block) {
+  unsigned long section, memory = 0, workspace = 0;
+
+  for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+    const FastqArchiveSectioninfo *info = block->section + section;
+    const unsigned long needed = fastq_archive_section_memory(
+        (FastqArchiveCodec) info->codec, info->flags, info->rawlength, false);
+
+    memory += (unsigned long) info->codedlength + info->rawlength + 1;
+    if (needed > workspace) {
+      workspace = needed;
+    }
+  }
+  return memory + workspace
+      + block->numofentries * 2 * sizeof (unsigned long);
+}
+
+/* Append a record with the given <tag> and the <length> bytes of
+ <payload> to the extra data <extra>, which stores <*extralength>
+ bytes and is enlarged as required. The new extra data is returned. */
+
+GtUchar *fastq_archive_extra_add(GtUchar *extra, unsigned long *extralength,
+    FastqArchiveExtra tag, const GtUchar *payload, unsigned long length) {
+
+  extra = gt_realloc(extra, (size_t) *extralength + 1 + VARINT_MAXBYTES
+      + length);
+  extra[(*extralength)++] = (GtUchar) tag;
+  *extralength += varint_put(extra + *extralength, length);
+  memcpy(extra + *extralength, payload, (size_t) length);
+  *extralength += length;
+  return extra;
+}
+
+/* Create a writer for the archive written to <fp>, which is not
+ required to be seekable. The file header with the <extralength>
+ bytes of <extra> is written immediately. */
+
+FastqArchiveWriter *fastq_archive_writer_new(FILE *fp,
+    unsigned long blocksize, const GtUchar *extra,
+    unsigned long extralength) {
+
+  GtUchar header[FASTQ_ARCHIVE_HEADERSIZE] = { 0 };
+  FastqArchiveWriter * writer = gt_malloc(sizeof *writer);
+
+  assert(blocksize > 0 && blocksize <= FASTQ_ARCHIVE_MAXBLOCKSIZE);
+  writer->fp = fp;
+  writer->offset = 0;
+  writer->blocksize = blocksize;
+  writer->numofblocks = 0;
+  writer->allocatedblocks = 0;
+  writer->numofentries = 0;
+  writer->append = false;
+  writer->blocks = NULL;
+
+  memcpy(header, FASTQ_ARCHIVE_MAGIC, FASTQ_ARCHIVE_MAGICSIZE);
+  header[4] = FASTQ_ARCHIVE_VERSION;
+  fastq_archive_put(header + 8, blocksize, 4UL);
+  fastq_archive_put(header + 12, extralength, 4UL);
+  fastq_archive_write(writer, header, FASTQ_ARCHIVE_HEADERSIZE);
+  fastq_archive_write(writer, extra, extralength);
+
+  return writer;
+}
+
+/* Create a writer which appends blocks to the archive read by <reader>,
+ whose index must have been read. The file of <reader> must be opened
+ for reading and writing. The new blocks follow the last trailer, the
+ index of all blocks and the new trailer are written by
+ fastq_archive_writer_delete. Until the new trailer is written, the
+ archive is not changed, so an interrupted append keeps the previous
+ entries. The file header including the extra data is not changed, so
+ the blocksize of the archive is kept. */
+
+FastqArchiveWriter *fastq_archive_writer_append(FastqArchiveReader *reader) {
+
+  FastqArchiveWriter * writer = gt_malloc(sizeof *writer);
+
+  assert(reader->blocks != NULL);
+  writer->fp = reader->fp;
+  writer->offset = reader->length;
+  writer->blocksize = reader->blocksize;
+  writer->numofblocks = reader->numofblocks;
+  writer->allocatedblocks = reader->numofblocks + 16;
+  writer->numofentries = reader->numofentries;
+  writer->append = true;
+  writer->blocks = gt_malloc(writer->allocatedblocks * sizeof *writer->blocks);
+  memcpy(writer->blocks, reader->blocks,
+      reader->numofblocks * sizeof *writer->blocks);
+  if (fseek(writer->fp, (long) writer->offset, SEEK_SET) != 0) {
+    fprintf(stderr, "Can not seek to the end of the archive\n");
+    exit(EXIT_FAILURE);
+  }
+  return writer;
+}
+
+/* Deliver the blocksize of the archive written by <writer>. */
+
+unsigned long fastq_archive_writer_blocksize(const FastqArchiveWriter *writer) {
+  return writer->blocksize;
+}
+
+/* Deliver the number of entries of the archive written by <writer>,
+ including the entries of the blocks preceding an append. */
+
+unsigned long fastq_archive_writer_numofentries(
+    const FastqArchiveWriter *writer) {
+  return writer->numofentries;
+}
+
+/* Append the <block> whose sections are stored in <coded> to the
+ archive. The offsets in <block> are set by this function. The first
+ entry of <block> must be the number of entries written so far. */
+
+void fastq_archive_writer_add(FastqArchiveWriter *writer,
+    FastqArchiveBlock *block, GtUchar * const *coded) {
+
+  GtUchar header[FASTQ_ARCHIVE_BLOCKHEADERSIZE];
+  unsigned long section;
+  uint64_t offset;
+
+  assert(block->firstentry == writer->numofentries);
+  memcpy(header, FASTQ_ARCHIVE_BLOCKMAGIC, FASTQ_ARCHIVE_MAGICSIZE);
+  fastq_archive_put(header + 4, block->firstentry, 8UL);
+  fastq_archive_put(header + 12, block->numofentries, 4UL);
+
+  offset = writer->offset + FASTQ_ARCHIVE_BLOCKHEADERSIZE;
+  for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+    block->section[section].offset = offset;
+    offset += block->section[section].codedlength;
+    fastq_archive_put_descriptor(
+        header + 16 + section * FASTQ_ARCHIVE_DESCRIPTORSIZE,
+        block->section + section);
+  }
+  fastq_archive_write(writer, header, FASTQ_ARCHIVE_BLOCKHEADERSIZE);
+  for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+    fastq_archive_write(writer, coded[section],
+        block->section[section].codedlength);
+  }
+
+  if (writer->numofblocks == writer->allocatedblocks) {
+    writer->allocatedblocks = writer->allocatedblocks * 2 + 16;
+    writer->blocks = gt_realloc(writer->blocks,
+        writer->allocatedblocks * sizeof *writer->blocks);
+  }
+  writer->blocks[writer->numofblocks++] = *block;
+  writer->numofentries += block->numofentries;
+}
+
+/* Write the index and the trailer and delete the writer. The file itself
+ is not closed. After an append, the blocks of an interrupted append
+ following the new trailer are removed. */
+
+void fastq_archive_writer_delete(FastqArchiveWriter *writer) {
+
+  GtUchar trailer[FASTQ_ARCHIVE_TRAILERSIZE];
+  GtUchar * index = NULL;
+  unsigned long i, section, pos = 0;
+  const uint64_t indexoffset = writer->offset;
+  const unsigned long indexsize = FASTQ_ARCHIVE_MAGICSIZE + 16UL
+      + writer->numofblocks * FASTQ_ARCHIVE_INDEXENTRYSIZE;
+
+  index = gt_malloc((size_t) indexsize);
+  memcpy(index, FASTQ_ARCHIVE_INDEXMAGIC, FASTQ_ARCHIVE_MAGICSIZE);
+  fastq_archive_put(index + 4, writer->numofblocks, 8UL);
+  fastq_archive_put(index + 12, writer->numofentries, 8UL);
+  pos = 20UL;
+  for (i = 0; i < writer->numofblocks; i++) {
+    const FastqArchiveBlock *block = writer->blocks + i;
+
+    fastq_archive_put(index + pos, block->firstentry, 8UL);
+    fastq_archive_put(index + pos + 8, block->numofentries, 4UL);
+    pos += 12UL;
+    for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+      fastq_archive_put(index + pos, block->section[section].offset, 8UL);
+      fastq_archive_put_descriptor(index + pos + 8, block->section + section);
+      pos += 8UL + FASTQ_ARCHIVE_DESCRIPTORSIZE;
+    }
+  }
+  assert(pos == indexsize);
+  fastq_archive_write(writer, index, indexsize);
+
+  fastq_archive_put(trailer, indexoffset, 8UL);
+  fastq_archive_put(trailer + 8, crc32c(0, index, (size_t) indexsize), 4UL);
+  memcpy(trailer + 12, FASTQ_ARCHIVE_TRAILERMAGIC, FASTQ_ARCHIVE_MAGICSIZE);
+  fastq_archive_write(writer, trailer, FASTQ_ARCHIVE_TRAILERSIZE);
+  fflush(writer->fp);
+  if (writer->append
+      && ftruncate(fileno(writer->fp), (off_t) writer->offset) != 0) {
+    fprintf(stderr, "Can not truncate the archive\n");
+    exit(EXIT_FAILURE);
+  }
+
+  gt_free(index);
+  gt_free(writer->blocks);
+  gt_free(writer);
+}
+
+/* Create a reader for the archive read from <fp>. Only the file header
+ is read. If the archive is corrupted, the function reports this and
+ exits with an exit code different from 0. */
+
+FastqArchiveReader *fastq_archive_reader_new(FILE *fp) {
+
+  GtUchar header[FASTQ_ARCHIVE_HEADERSIZE];
+  FastqArchiveReader * reader = NULL;
+
+  fastq_archive_read(fp, header, FASTQ_ARCHIVE_HEADERSIZE);
+  if (memcmp(header, FASTQ_ARCHIVE_MAGIC, FASTQ_ARCHIVE_MAGICSIZE) != 0
+      || header[4] != FASTQ_ARCHIVE_VERSION) {
+    fprintf(stderr, "Input is not an archive of version %d\n",
+        FASTQ_ARCHIVE_VERSION);
+    exit(EXIT_FAILURE);
+  }
+
+  reader = gt_malloc(sizeof *reader);
+  reader->fp = fp;
+  reader->blocksize = (unsigned long) fastq_archive_get(header + 8, 4UL);
+  reader->extralength = (unsigned long) fastq_archive_get(header + 12, 4UL);
+  reader->extra = gt_malloc((size_t) reader->extralength + 1);
+  fastq_archive_read(fp, reader->extra, reader->extralength);
+  reader->numofblocks = 0;
+  reader->numofentries = 0;
+  reader->indexoffset = 0;
+  reader->offset = FASTQ_ARCHIVE_HEADERSIZE + reader->extralength;
+  reader->length = UINT64_MAX;
+  reader->endofblocks = false;
+  reader->blocks = NULL;
+
+  return reader;
+}
+
+/* Deliver the blocksize of the archive. */
+
+unsigned long fastq_archive_reader_blocksize(const FastqArchiveReader *reader) {
+  return reader->blocksize;
+}
+
+/* Deliver the payload of the record with the given <tag> in the extra
+ data of the archive and store its length in <length>. Returns NULL if
+ there is no such record. */
+
+const GtUchar *fastq_archive_reader_extra(const FastqArchiveReader *reader,
+    FastqArchiveExtra tag, unsigned long *length) {
+
+  const GtUchar * ptr = reader->extra,
+      * end = reader->extra + reader->extralength;
+
+  while (ptr < end) {
+    const GtUchar recordtag = *ptr++;
+
+    if (!varint_get(&ptr, end, length) || *length > (unsigned long) (end
+        - ptr)) {
+      fprintf(stderr, "Archive is corrupted: invalid extra data\n");
+      exit(EXIT_FAILURE);
+    }
+    if (recordtag == (GtUchar) tag) {
+      return ptr;
+    }
+    ptr += *length;
+  }
+  return NULL;
+}
+
+/**
+ * Read <length> bytes of the archive sequentially
+ * and count them in the offset of <reader>
+ */
+static void fastq_archive_reader_read(FastqArchiveReader *reader,
+    void *buffer, unsigned long length) {
+  fastq_archive_read(reader->fp, buffer, length);
+  reader->offset += length;
+}
+
+/**
+ * Skip the index following the magic just read and the
+ * trailer, which are replaced by the blocks of an append
+ */
+static void fastq_archive_reader_skipindex(FastqArchiveReader *reader) {
+
+  GtUchar buffer[FASTQ_ARCHIVE_INDEXENTRYSIZE];
+  unsigned long numofblocks;
+
+  fastq_archive_reader_read(reader, buffer, 16UL);
+  numofblocks = (unsigned long) fastq_archive_get(buffer, 8UL);
+  while (numofblocks-- > 0) {
+    fastq_archive_reader_read(reader, buffer, FASTQ_ARCHIVE_INDEXENTRYSIZE);
+  }
+  fastq_archive_reader_read(reader, buffer, FASTQ_ARCHIVE_TRAILERSIZE);
+}
+
+/* Read the next block of the archive sequentially, i.e. without seeking.
+ The descriptor is stored in <block>, the coded sections are stored in
+ <coded> and must be freed by the user. Returns false if there is no
+ further block. If the index has been read, the blocks of an
+ interrupted append are not delivered. */
+
+bool fastq_archive_reader_next(FastqArchiveReader *reader,
+    FastqArchiveBlock *block, GtUchar **coded) {
+
+  GtUchar header[FASTQ_ARCHIVE_BLOCKHEADERSIZE];
+  unsigned long section;
+  bool aftertrailer = false;
+
+  if (reader->endofblocks) {
+    return false;
+  }
+  while (true) {
+    size_t numread;
+
+    /* the blocks of an interrupted append follow the last trailer */
+    if (reader->offset == reader->length) {
+      reader->endofblocks = true;
+      return false;
+    }
+    numread = fread(header, 1, (size_t) FASTQ_ARCHIVE_MAGICSIZE, reader->fp);
+    if (numread == 0 && aftertrailer && feof(reader->fp)) {
+      reader->endofblocks = true;
+      return false;
+    }
+    if (numread != FASTQ_ARCHIVE_MAGICSIZE) {
+      fprintf(stderr, "Archive is truncated\n");
+      exit(EXIT_FAILURE);
+    }
+    reader->offset += FASTQ_ARCHIVE_MAGICSIZE;
+    if (memcmp(header, FASTQ_ARCHIVE_INDEXMAGIC, FASTQ_ARCHIVE_MAGICSIZE)
+        != 0) {
+      break;
+    }
+    /* the blocks of an append follow the previous index and trailer */
+    fastq_archive_reader_skipindex(reader);
+    aftertrailer = true;
+  }
+  if (memcmp(header, FASTQ_ARCHIVE_BLOCKMAGIC, FASTQ_ARCHIVE_MAGICSIZE) != 0) {
+    fprintf(stderr, "Archive is corrupted: block header expected\n");
+    exit(EXIT_FAILURE);
+  }
+  fastq_archive_reader_read(reader, header + FASTQ_ARCHIVE_MAGICSIZE,
+      FASTQ_ARCHIVE_BLOCKHEADERSIZE - FASTQ_ARCHIVE_MAGICSIZE);
+  block->firstentry = fastq_archive_get(header + 4, 8UL);
+  block->numofentries = (uint32_t) fastq_archive_get(header + 12, 4UL);
+  for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+    fastq_archive_get_descriptor(block->section + section,
+        header + 16 + section * FASTQ_ARCHIVE_DESCRIPTORSIZE);
+    block->section[section].offset = 0;
+  }
+  for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+    const unsigned long codedlength = block->section[section].codedlength;
+
+    coded[section] = gt_malloc((size_t) codedlength + 1);
+    fastq_archive_reader_read(reader, coded[section], codedlength);
+  }
+  return true;
+}
+
+/**
+ * Deliver the largest file offset <e> with <e> <= <end> at which
+ * the magic of a trailer ends in the archive read from <fp>, or 0
+ * if there is no such offset
+ */
+static uint64_t fastq_archive_reader_prevtrailer(FILE *fp, uint64_t end) {
+
+  GtUchar buffer[FASTQ_ARCHIVE_SCANSIZE + FASTQ_ARCHIVE_MAGICSIZE];
+  uint64_t last = end;
+
+  while (last >= FASTQ_ARCHIVE_TRAILERSIZE) {
+    /* the candidates first to last end in the buffer */
+    const uint64_t first =
+        last >= FASTQ_ARCHIVE_TRAILERSIZE + FASTQ_ARCHIVE_SCANSIZE
+            ? last - FASTQ_ARCHIVE_SCANSIZE + 1 : FASTQ_ARCHIVE_TRAILERSIZE;
+    const size_t length = (size_t) (last - first + FASTQ_ARCHIVE_MAGICSIZE);
+    uint64_t e;
+
+    if (fseek(fp, (long) (first - FASTQ_ARCHIVE_MAGICSIZE), SEEK_SET) != 0
+        || fread(buffer, 1, length, fp) != length) {
+      fprintf(stderr, "Can not seek to the index of the archive\n");
+      exit(EXIT_FAILURE);
+    }
+    for (e = last; e >= first; e--) {
+      if (memcmp(buffer + (e - first), FASTQ_ARCHIVE_TRAILERMAGIC,
+          FASTQ_ARCHIVE_MAGICSIZE) == 0) {
+        return e;
+      }
+    }
+    last = first - 1;
+  }
+  return 0;
+}
+
+/**
+ * Read the trailer ending at file offset <end> and the index it
+ * refers to, whose offset and size are stored. Returns the index
+ * or NULL if the size or the checksum of the index is wrong
+ */
+static GtUchar *fastq_archive_reader_trailer(FILE *fp, uint64_t end,
+    uint64_t *indexoffset, unsigned long *indexsize) {
+
+  GtUchar trailer[FASTQ_ARCHIVE_TRAILERSIZE];
+  GtUchar head[FASTQ_ARCHIVE_MAGICSIZE + 16UL];
+  GtUchar * index = NULL;
+
+  if (fseek(fp, (long) (end - FASTQ_ARCHIVE_TRAILERSIZE), SEEK_SET) != 0) {
+    fprintf(stderr, "Can not seek to the index of the archive\n");
+    exit(EXIT_FAILURE);
+  }
+  fastq_archive_read(fp, trailer, FASTQ_ARCHIVE_TRAILERSIZE);
+  *indexoffset = fastq_archive_get(trailer, 8UL);
+  if (*indexoffset > end
+      || *indexoffset + sizeof head + FASTQ_ARCHIVE_TRAILERSIZE > end
+      || fseek(fp, (long) *indexoffset, SEEK_SET) != 0
+      || fread(head, 1, sizeof head, fp) != sizeof head
+      || memcmp(head, FASTQ_ARCHIVE_INDEXMAGIC, FASTQ_ARCHIVE_MAGICSIZE)
+          != 0) {
+    return NULL;
+  }
+
+  /* the size is checked before the index is read */
+  *indexsize = (unsigned long) (end - FASTQ_ARCHIVE_TRAILERSIZE
+      - *indexoffset);
+  if ((*indexsize - sizeof head) % FASTQ_ARCHIVE_INDEXENTRYSIZE != 0
+      || (*indexsize - sizeof head) / FASTQ_ARCHIVE_INDEXENTRYSIZE
+          != fastq_archive_get(head + 4, 8UL)) {
+    return NULL;
+  }
+  index = gt_malloc((size_t) *indexsize);
+  memcpy(index, head, sizeof head);
+  if (fread(index + sizeof head, 1, (size_t) (*indexsize - sizeof head), fp)
+      != *indexsize - sizeof head
+      || crc32c(0, index, (size_t) *indexsize)
+          != (uint32_t) fastq_archive_get(trailer + 8, 4UL)) {
+    gt_free(index);
+    return NULL;
+  }
+  return index;
+}
+
+/* Read the index of the archive, which is referred to by the last valid
+ trailer. This requires that the archive can be seeked. The position
+ of the sequential reading is not changed. Returns the number of
+ blocks. */
+
+unsigned long fastq_archive_reader_index(FastqArchiveReader *reader) {
+
+  GtUchar * index = NULL;
+  unsigned long i, section, pos, indexsize;
+  long filesize, position;
+  uint64_t end;
+
+  if ((position = ftell(reader->fp)) < 0
+      || fseek(reader->fp, 0L, SEEK_END) != 0
+      || (filesize = ftell(reader->fp)) < (long) FASTQ_ARCHIVE_TRAILERSIZE) {
+    fprintf(stderr, "Can not seek to the index of the archive\n");
+    exit(EXIT_FAILURE);
+  }
+
+  /* the trailer is written last, so the blocks of an interrupted append
+   follow the last valid trailer */
+  end = fastq_archive_reader_prevtrailer(reader->fp, (uint64_t) filesize);
+  while (end > 0 && (index = fastq_archive_reader_trailer(reader->fp, end,
+      &reader->indexoffset, &indexsize)) == NULL) {
+    if (end == (uint64_t) filesize) {
+      fprintf(stderr, "Archive is corrupted: invalid index\n");
+      exit(EXIT_FAILURE);
+    }
+    end = fastq_archive_reader_prevtrailer(reader->fp, end - 1);
+  }
+  if (index == NULL) {
+    fprintf(stderr, "Archive is corrupted: no valid trailer\n");
+    exit(EXIT_FAILURE);
+  }
+  reader->length = end;
+
+  reader->numofblocks = (unsigned long) fastq_archive_get(index + 4, 8UL);
+  reader->numofentries = (unsigned long) fastq_archive_get(index + 12, 8UL);
+  gt_free(reader->blocks);
+  reader->blocks = gt_malloc(
+      (size_t) (reader->numofblocks + 1) * sizeof *reader->blocks);
+  for (i = 0, pos = 20UL; i < reader->numofblocks; i++) {
+    FastqArchiveBlock *block = reader->blocks + i;
+
+    block->firstentry = fastq_archive_get(index + pos, 8UL);
+    block->numofentries = (uint32_t) fastq_archive_get(index + pos + 8, 4UL);
+    pos += 12UL;
+    for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+      block->section[section].offset = fastq_archive_get(index + pos, 8UL);
+      fastq_archive_get_descriptor(block->section + section, index + pos + 8);
+      pos += 8UL + FASTQ_ARCHIVE_DESCRIPTORSIZE;
+    }
+  }
+
+  gt_free(index);
+  /* the blocks can still be read sequentially */
+  if (fseek(reader->fp, position, SEEK_SET) != 0) {
+    fprintf(stderr, "Can not seek to the index of the archive\n");
+    exit(EXIT_FAILURE);
+  }
+  return reader->numofblocks;
+}
+
+/* Deliver the total number of entries in the archive. Requires that the
+ index has been read. */
+
+unsigned long fastq_archive_reader_numofentries(
+    const FastqArchiveReader *reader) {
+  return reader->numofentries;
+}
+
+/* Deliver the descriptor of the block with index <blocknum>. Requires
+ that the index has been read. */
+
+const FastqArchiveBlock *fastq_archive_reader_block(
+    const FastqArchiveReader *reader, unsigned long blocknum) {
+  assert(reader->blocks != NULL && blocknum < reader->numofblocks);
+  return reader->blocks + blocknum;
+}
+
+/* Deliver the index of the block which contains the entry with index
+ <entry>. Requires that the index has been read. */
+
+unsigned long fastq_archive_reader_findblock(const FastqArchiveReader *reader,
+    unsigned long entry) {
+
+  unsigned long left = 0, right = reader->numofblocks;
+
+  /* binary search for the last block starting at or before <entry> */
+  while (left + 1 < right) {
+    const unsigned long mid = left + (right - left) / 2;
+
+    if (reader->blocks[mid].firstentry <= entry) {
+      left = mid;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+/* Read the coded data of <section> of the block with index <blocknum>
+ by seeking to its offset. The user is responsible to free the returned
+ memory. */
+
+GtUchar *fastq_archive_reader_section(FastqArchiveReader *reader,
+    unsigned long blocknum, FastqArchiveSection section) {
+
+  const FastqArchiveSectioninfo *info = &fastq_archive_reader_block(reader,
+      blocknum)->section[section];
+  GtUchar * coded = gt_malloc((size_t) info->codedlength + 1);
+
+  if (fseek(reader->fp, (long) info->offset, SEEK_SET) != 0) {
+    fprintf(stderr, "Can not seek to block %lu of the archive\n", blocknum);
+    exit(EXIT_FAILURE);
+  }
+  fastq_archive_read(reader->fp, coded, info->codedlength);
+  return coded;
+}
+
+/* Delete the reader. The file itself is not closed. */
+
+void fastq_archive_reader_delete(FastqArchiveReader *reader) {
+  if (reader != NULL) {
+    gt_free(reader->extra);
+    gt_free(reader->blocks);
+    gt_free(reader);
+  }
+}
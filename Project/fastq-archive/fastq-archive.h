@@ -0,0 +1,364 @@
+#ifndef FASTQ_ARCHIVE_H
+#define FASTQ_ARCHIVE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "../bwt-compress/gt-defs.h"
+
+/* An archive stores the entries of a Fastq-file in four independent
+   sections, namely
+   - the lengths of the header lines and of the sequences,
+   - the concatenation of the header lines,
+   - the concatenation of the nucleotide sequences and
+   - the concatenation of the quality values.
+   The entries are split into blocks of consecutive entries, such that
+   the sequences of each block (except for the last) have a total length
+   of about the blocksize of the archive. Each block is compressed
+   independently, section by section.
+
+   All integers are stored in little endian byte order. The layout is:
+
+   file header:  magic "FQZA", version (1 byte), flags (1 byte),
+                 2 reserved bytes, blocksize (4 bytes), length of the
+                 extra data (4 bytes), followed by the extra data
+   blocks:       for each block: magic "FQZB", the index of its first
+                 entry (8 bytes), the number of entries (4 bytes) and for
+                 each section a descriptor of FASTQ_ARCHIVE_DESCRIPTORSIZE
+                 bytes: codec (1 byte), flags (1 byte), raw length,
+                 coded length and CRC32C of the raw data (4 bytes each).
+                 The descriptors are followed by the coded sections
+                 in the order given above.
+   index:        magic "FQZI", number of blocks (8 bytes), number of
+                 entries (8 bytes) and for each block the index of its
+                 first entry (8 bytes), the number of entries (4 bytes)
+                 and for each section the file offset of the coded data
+                 (8 bytes) and its descriptor
+   trailer:      file offset of the index (8 bytes), CRC32C of the index
+                 (4 bytes), magic "FQZE"
+
+   The extra data of the file header is a sequence of records, each
+   consisting of a tag (1 byte, see FastqArchiveExtra), the length of
+   the payload (as varint) and the payload.
+
+   An append writes further blocks, an index of all blocks and a new
+   trailer after the trailer, so the previous index and trailer are
+   skipped when the blocks are read. The last valid trailer is the end
+   of the archive.
+
+   The sections of a block are stored next to each other, so an archive
+   can be written and read as a stream. Readers which can seek use the
+   index to decode only the blocks (and sections) they need. */
+
+#define FASTQ_ARCHIVE_VERSION          1
+#define FASTQ_ARCHIVE_HEADERSIZE       16UL
+#define FASTQ_ARCHIVE_DESCRIPTORSIZE   14UL
+#define FASTQ_ARCHIVE_TRAILERSIZE      16UL
+#define FASTQ_ARCHIVE_DEFAULTBLOCKSIZE (64UL << 20)
+#define FASTQ_ARCHIVE_MAXBLOCKSIZE     (1UL << 30)
+
+typedef enum {
+  FASTQ_ARCHIVE_LENGTHS,
+  FASTQ_ARCHIVE_HEADER,
+  FASTQ_ARCHIVE_SEQUENCE,
+  FASTQ_ARCHIVE_QUALITY,
+  FASTQ_ARCHIVE_NUMOFSECTIONS
+} FastqArchiveSection;
+
+typedef enum {
+  FASTQ_ARCHIVE_CODEC_BWT,  /* bwt_compress: BWT, MTF, RLE0 and Huffman */
+  FASTQ_ARCHIVE_CODEC_RANS, /* rans_encode: interleaved order-0 rANS */
+  FASTQ_ARCHIVE_CODEC_CM,   /* qualcm_encode: context mixing, quality only */
+  FASTQ_ARCHIVE_NUMOFCODECS
+} FastqArchiveCodec;
+
+/* The flags of a section */
+#define FASTQ_ARCHIVE_FLAG_BINNED     1U /* quality values are binned */
+#define FASTQ_ARCHIVE_FLAG_SAMPLED    2U /* BWT code with sampled inverse SA */
+#define FASTQ_ARCHIVE_FLAG_TRANSPOSED 4U /* coded cycle by cycle */
+#define FASTQ_ARCHIVE_FLAG_EXCEPTIONS 8U /* non-ACGT runs stored apart */
+
+/* A section with the flag FASTQ_ARCHIVE_FLAG_SAMPLED stores the
+   samplerate r (as varint) followed by the code of bwt_compress_sampled,
+   which samples the inverse suffix array at the end of the entries
+   r, 2r, ... and at the end of the last entry of the block.
+   A section with the flag FASTQ_ARCHIVE_FLAG_EXCEPTIONS starts with the
+   length (as varint) and the list of seqexcept_extract, which precede
+   the samplerate if the section is also sampled. */
+#define FASTQ_ARCHIVE_DEFAULTSAMPLERATE 32UL
+
+/* The tags of the records in the extra data of the file header */
+typedef enum {
+  FASTQ_ARCHIVE_EXTRA_BINNING = 1 /* qualbin_scheme_serialize */
+} FastqArchiveExtra;
+
+/* The descriptor of a single section of a block */
+typedef struct {
+  uint64_t offset;          /* file offset of the coded data */
+  uint32_t rawlength,
+           codedlength,
+           checksum;        /* CRC32C of the raw data */
+  GtUchar codec,
+          flags;
+} FastqArchiveSectioninfo;
+
+/* The descriptor of a block */
+typedef struct {
+  uint64_t firstentry;
+  uint32_t numofentries;
+  FastqArchiveSectioninfo section[FASTQ_ARCHIVE_NUMOFSECTIONS];
+} FastqArchiveBlock;
+
+/* Deliver the name of <section>, e.g. for messages */
+
+const char *fastq_archive_section_name(FastqArchiveSection section);
+
+/* Deliver the name of <codec>, e.g. for messages */
+
+const char *fastq_archive_codec_name(FastqArchiveCodec codec);
+
+/* Store the codec with the given <name> in <codec>. Returns false if
+   there is no such codec. */
+
+bool fastq_archive_codec_parse(FastqArchiveCodec *codec, const char *name);
+
+/* The following function encodes the <rawlength> bytes of <raw> with
+   the given <codec> as section of an archive and stores the code length,
+   the checksum, the codec and the flags in <info>. The returned memory
+   area holds the code, the user is responsible to free it. The caller
+   sets the flags in <info> which describe the raw data, i.e.
+   FASTQ_ARCHIVE_FLAG_BINNED, or request a stage of the encoding.
+   FASTQ_ARCHIVE_FLAG_EXCEPTIONS replaces the characters other than ACGT
+   by a placeholder and stores them in a list in front of the code, the
+   flag is cleared if there are no such characters.
+   FASTQ_ARCHIVE_FLAG_TRANSPOSED stores the values cycle by cycle before
+   they are coded, and it is only applied if all entries have the same
+   length. Otherwise the flag is cleared. The lengths
+   of the <numofentries> entries of the block in this section are given
+   by <entrylengths>, i.e. the lengths of the header lines or of the
+   sequences. They are required by FASTQ_ARCHIVE_CODEC_CM and for
+   sampling. If <samplerate> is not 0 and the codec is
+   FASTQ_ARCHIVE_CODEC_BWT, then the inverse suffix array is sampled at
+   the end of every <samplerate>-th entry and the section is marked with
+   FASTQ_ARCHIVE_FLAG_SAMPLED, see fastq_archive_section_extract. If
+   <logfp> is not NULL, then the time and throughput of each stage of
+   the codec is reported to <logfp>. */
+
+GtUchar *fastq_archive_section_encode(FILE *logfp,
+                                      FastqArchiveSectioninfo *info,
+                                      FastqArchiveSection section,
+                                      FastqArchiveCodec codec,
+                                      const GtUchar *raw,
+                                      unsigned long rawlength,
+                                      const unsigned long *entrylengths,
+                                      unsigned long numofentries,
+                                      unsigned long samplerate);
+
+/* The following function decodes the section described by <info> whose
+   code is stored in <coded>. The entry lengths of the block must be
+   the same as for the encoding. The decoded data is verified against
+   the checksum in <info>. If the code is corrupted, the function
+   reports this and exits with an exit code different from 0. The user
+   is responsible to free the returned memory, which stores
+   <info->rawlength> bytes followed by a \0-byte. */
+
+GtUchar *fastq_archive_section_decode(const FastqArchiveSectioninfo *info,
+                                      const GtUchar *coded,
+                                      const unsigned long *entrylengths,
+                                      unsigned long numofentries);
+
+/* The following function stores the entries <firstentry> to
+   <firstentry>+<count>-1 of the section described by <info> whose code
+   is stored in <coded> in a new memory area and their total length in
+   <length>. The lengths of the <numofentries> entries of the block in
+   this section are given by <entrylengths>. If the section is sampled,
+   then only the BWT is decoded and walked backwards from the sample
+   following the last of the entries, so that the number of LF-steps is
+   at most the length of the <samplerate>+<count>-1 entries. The
+   checksum can not be verified in this case. Otherwise the whole section
+   is decoded. The user is responsible to free the returned memory, which
+   stores <length> bytes followed by a \0-byte. */
+
+GtUchar *fastq_archive_section_extract(unsigned long *length,
+                                       const FastqArchiveSectioninfo *info,
+                                       const GtUchar *coded,
+                                       const unsigned long *entrylengths,
+                                       unsigned long numofentries,
+                                       unsigned long firstentry,
+                                       unsigned long count);
+
+/* The following function checks that the section described by <info>
+   whose code is stored in <coded> is decoded to the <rawlength> bytes of
+   <raw>, which consist of the <numofentries> entries whose lengths are
+   given by <entrylengths>. If the section is sampled, then only the BWT
+   is decoded and walked backwards over <numofranges> ranges between two
+   consecutive samples, which are chosen pseudo-randomly from <seed>.
+   This checks every stage of the code but only a small part of the
+   LF-mapping, at a fraction of the cost of the inversion of the BWT.
+   Otherwise the whole section is decoded and compared. Returns false if
+   a difference is found. */
+
+bool fastq_archive_section_spotcheck(const FastqArchiveSectioninfo *info,
+                                     const GtUchar *coded,
+                                     const GtUchar *raw,
+                                     unsigned long rawlength,
+                                     const unsigned long *entrylengths,
+                                     unsigned long numofentries,
+                                     unsigned long numofranges,
+                                     unsigned long seed);
+
+/* The following function parses the <rawlength> bytes of the decoded
+   lengths section <raw> of a block with <numofentries> entries and
+   stores the lengths of the header lines in <headerlengths> and the
+   lengths of the sequences in <seqlengths>. Returns false if the
+   section does not store exactly <numofentries> pairs of lengths. */
+
+bool fastq_archive_lengths_parse(unsigned long *headerlengths,
+                                 unsigned long *seqlengths,
+                                 unsigned long numofentries,
+                                 const GtUchar *raw,
+                                 unsigned long rawlength);
+
+/* Deliver an upper bound for the number of bytes of workspace required
+   to encode, if <encode> is true, or to decode a section of <rawlength>
+   bytes with the given <codec> and <flags>. The raw and the coded data
+   are not included. */
+
+unsigned long fastq_archive_section_memory(FastqArchiveCodec codec,
+                                           GtUchar flags,
+                                           unsigned long rawlength,
+                                           bool encode);
+
+/* Deliver an upper bound for the number of bytes of memory required to
+   decode the sections of <block> one after the other, including the
+   coded and the decoded sections. */
+
+unsigned long fastq_archive_block_memory(const FastqArchiveBlock *block);
+
+/* The classes to write and to read an archive */
+
+typedef struct FastqArchiveReader FastqArchiveReader;
+
+typedef struct FastqArchiveWriter FastqArchiveWriter;
+
+/* Append a record with the given <tag> and the <length> bytes of
+   <payload> to the extra data <extra>, which stores <*extralength>
+   bytes and is enlarged as required. The new extra data is returned. */
+
+GtUchar *fastq_archive_extra_add(GtUchar *extra, unsigned long *extralength,
+                                 FastqArchiveExtra tag,
+                                 const GtUchar *payload,
+                                 unsigned long length);
+
+/* Create a writer for the archive written to <fp>, which is not
+   required to be seekable. The file header with the <extralength>
+   bytes of <extra> is written immediately. */
+
+FastqArchiveWriter *fastq_archive_writer_new(FILE *fp,
+                                             unsigned long blocksize,
+                                             const GtUchar *extra,
+                                             unsigned long extralength);
+
+/* Create a writer which appends blocks to the archive read by <reader>,
+   whose index must have been read. The file of <reader> must be opened
+   for reading and writing. The new blocks follow the last trailer, the
+   index of all blocks and the new trailer are written by
+   fastq_archive_writer_delete. Until the new trailer is written, the
+   archive is not changed, so an interrupted append keeps the previous
+   entries. The file header including the extra data is not changed, so
+   the blocksize of the archive is kept. */
+
+FastqArchiveWriter *fastq_archive_writer_append(FastqArchiveReader *reader);
+
+/* Deliver the blocksize of the archive written by <writer>. */
+
+unsigned long fastq_archive_writer_blocksize(const FastqArchiveWriter *writer);
+
+/* Deliver the number of entries of the archive written by <writer>,
+   including the entries of the blocks preceding an append. */
+
+unsigned long fastq_archive_writer_numofentries(
+                                          const FastqArchiveWriter *writer);
+
+/* Append the <block> whose sections are stored in <coded> to the
+   archive. The offsets in <block> are set by this function. The first
+   entry of <block> must be the number of entries written so far. */
+
+void fastq_archive_writer_add(FastqArchiveWriter *writer,
+                              FastqArchiveBlock *block,
+                              GtUchar * const *coded);
+
+/* Write the index and the trailer and delete the writer. The file itself
+   is not closed. After an append, the blocks of an interrupted append
+   following the new trailer are removed. */
+
+void fastq_archive_writer_delete(FastqArchiveWriter *writer);
+
+
+/* Create a reader for the archive read from <fp>. Only the file header
+   is read. If the archive is corrupted, the function reports this and
+   exits with an exit code different from 0. */
+
+FastqArchiveReader *fastq_archive_reader_new(FILE *fp);
+
+/* Deliver the blocksize of the archive. */
+
+unsigned long fastq_archive_reader_blocksize(const FastqArchiveReader *reader);
+
+/* Deliver the payload of the record with the given <tag> in the extra
+   data of the archive and store its length in <length>. Returns NULL if
+   there is no such record. */
+
+const GtUchar *fastq_archive_reader_extra(const FastqArchiveReader *reader,
+                                          FastqArchiveExtra tag,
+                                          unsigned long *length);
+
+/* Read the next block of the archive sequentially, i.e. without seeking.
+   The descriptor is stored in <block>, the coded sections are stored in
+   <coded> and must be freed by the user. Returns false if there is no
+   further block. If the index has been read, the blocks of an
+   interrupted append are not delivered. */
+
+bool fastq_archive_reader_next(FastqArchiveReader *reader,
+                               FastqArchiveBlock *block,
+                               GtUchar **coded);
+
+/* Read the index of the archive, which is referred to by the last valid
+   trailer. This requires that the archive can be seeked. The position
+   of the sequential reading is not changed. Returns the number of
+   blocks. */
+
+unsigned long fastq_archive_reader_index(FastqArchiveReader *reader);
+
+/* Deliver the total number of entries in the archive. Requires that the
+   index has been read. */
+
+unsigned long fastq_archive_reader_numofentries(
+                                          const FastqArchiveReader *reader);
+
+/* Deliver the descriptor of the block with index <blocknum>. Requires
+   that the index has been read. */
+
+const FastqArchiveBlock *fastq_archive_reader_block(
+                                          const FastqArchiveReader *reader,
+                                          unsigned long blocknum);
+
+/* Deliver the index of the block which contains the entry with index
+   <entry>. Requires that the index has been read. */
+
+unsigned long fastq_archive_reader_findblock(const FastqArchiveReader *reader,
+                                             unsigned long entry);
+
+/* Read the coded data of <section> of the block with index <blocknum>
+   by seeking to its offset. The user is responsible to free the returned
+   memory. */
+
+GtUchar *fastq_archive_reader_section(FastqArchiveReader *reader,
+                                      unsigned long blocknum,
+                                      FastqArchiveSection section);
+
+/* Delete the reader. The file itself is not closed. */
+
+void fastq_archive_reader_delete(FastqArchiveReader *reader);
+
+#endif
@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+
+#include "qualbin.h"
+
+#define QUALBIN_MAXCHAR '~'
+
+static const char *qualbin_illumina8 =
+    "0:0,2:6,10:15,20:22,25:27,30:33,35:37,40:40";
+
+/* The following function parses the binning scheme given by <spec> and
+ stores it with the given <offset> in <scheme>. If <spec> is not a
+ valid scheme, then an error is reported to stderr and false is
+ returned. */
+
+bool qualbin_scheme_parse(QualbinScheme *scheme, const char *spec,
+    GtUchar offset) {
+
+  const char * ptr = strcmp(spec, "illumina8") == 0 ? qualbin_illumina8
+      : spec;
+  bool valid = true;
+
+  scheme->offset = offset;
+  scheme->numofbins = 0;
+  while (valid && *ptr != '\0') {
+    char * end = NULL;
+    unsigned long lower, value = 0;
+
+    lower = strtoul(ptr, &end, 10);
+    valid = end != ptr && *end == ':';
+    if (valid) {
+      ptr = end + 1;
+      value = strtoul(ptr, &end, 10);
+      valid = end != ptr && (*end == ',' || *end == '\0')
+          && scheme->numofbins < QUALBIN_MAXBINS
+          && (scheme->numofbins > 0
+              ? lower > scheme->lower[scheme->numofbins - 1] : lower == 0)
+          && lower + offset <= UCHAR_MAX && value + offset <= QUALBIN_MAXCHAR;
+    }
+    if (valid) {
+      scheme->lower[scheme->numofbins] = (GtUchar) lower;
+      scheme->value[scheme->numofbins] = (GtUchar) value;
+      scheme->numofbins++;
+      ptr = *end == ',' ? end + 1 : end;
+    }
+  }
+  if (!valid || scheme->numofbins == 0) {
+    fprintf(stderr, "Illegal binning scheme %s: expected illumina8 or at "
+        "most %lu pairs <lower>:<value> with increasing lower bounds "
+        "starting at 0\n", spec, QUALBIN_MAXBINS);
+    return false;
+  }
+  return true;
+}
+
+/* The following function checks that none of the <length> quality
+ characters in <qual> is below the ASCII <offset>. */
+
+bool qualbin_offset_valid(const GtUchar *qual, unsigned long length,
+    GtUchar offset) {
+  unsigned long idx;
+
+  for (idx = 0; idx < length; idx++) {
+    if (qual[idx] < offset) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Portable version: a table with
+ * one entry per character
+ */
+static void qualbin_apply_table(const QualbinScheme *scheme, GtUchar *qual,
+    unsigned long length) {
+
+  GtUchar map[UCHAR_MAX + 1];
+  unsigned long idx, bin = 0;
+
+  for (idx = 0; idx <= UCHAR_MAX; idx++) {
+    while (bin + 1 < scheme->numofbins
+        && idx >= (unsigned long) scheme->lower[bin + 1] + scheme->offset) {
+      bin++;
+    }
+    map[idx] = (GtUchar) (scheme->value[bin] + scheme->offset);
+  }
+  for (idx = 0; idx < length; idx++) {
+    qual[idx] = map[qual[idx]];
+  }
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define QUALBIN_AVX2
+
+/**
+ * The bin of a character is the number of lower bounds
+ * it reaches, which selects the representative from a
+ * 16 byte table by a shuffle
+ */
+__attribute__((target("avx2")))
+static unsigned long qualbin_apply_avx2(const QualbinScheme *scheme,
+    GtUchar *qual, unsigned long length) {
+
+  __m256i bounds[QUALBIN_MAXBINS], table;
+  GtUchar values[QUALBIN_MAXBINS] = { 0 };
+  unsigned long idx, bin;
+
+  for (bin = 0; bin < scheme->numofbins; bin++) {
+    values[bin] = (GtUchar) (scheme->value[bin] + scheme->offset);
+    bounds[bin] = _mm256_set1_epi8((char) (scheme->lower[bin]
+        + scheme->offset));
+  }
+  table = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *) values));
+
+  for (idx = 0; idx + 32 <= length; idx += 32) {
+    const __m256i chars = _mm256_loadu_si256((const __m256i *) (qual + idx));
+    __m256i count = _mm256_setzero_si256();
+
+    for (bin = 1; bin < scheme->numofbins; bin++) {
+      /* chars >= bound as unsigned bytes, the mask is -1 */
+      count = _mm256_sub_epi8(count, _mm256_cmpeq_epi8(
+          _mm256_max_epu8(chars, bounds[bin]), chars));
+    }
+    _mm256_storeu_si256((__m256i *) (qual + idx),
+        _mm256_shuffle_epi8(table, count));
+  }
+  return idx;
+}
+#endif
+
+/* The following function replaces each of the <length> quality
+ characters in <qual> by the representative of its bin. The bins are
+ determined by comparisons with the lower bounds and a table lookup,
+ which process 32 characters at once if the processor supports AVX2.
+ Characters below the offset are mapped to the first bin. */
+
+void qualbin_apply(const QualbinScheme *scheme, GtUchar *qual,
+    unsigned long length) {
+
+  unsigned long done = 0;
+
+  assert(scheme->numofbins > 0 && scheme->numofbins <= QUALBIN_MAXBINS);
+#ifdef QUALBIN_AVX2
+  if (__builtin_cpu_supports("avx2")) {
+    done = qualbin_apply_avx2(scheme, qual, length);
+  }
+#endif
+  qualbin_apply_table(scheme, qual + done, length - done);
+}
+
+/* The following function stores <scheme> in <dest>, which provides
+ space for QUALBIN_SERIALSIZE bytes, and returns the number of bytes
+ used. */
+
+unsigned long qualbin_scheme_serialize(GtUchar *dest,
+    const QualbinScheme *scheme) {
+
+  unsigned long bin, pos = 0;
+
+  dest[pos++] = scheme->offset;
+  dest[pos++] = (GtUchar) scheme->numofbins;
+  for (bin = 0; bin < scheme->numofbins; bin++) {
+    dest[pos++] = scheme->lower[bin];
+    dest[pos++] = scheme->value[bin];
+  }
+  return pos;
+}
+
+/* The following function reads a scheme of <length> bytes stored by
+ qualbin_scheme_serialize from <src>. Returns false if <src> is not a
+ valid scheme. */
+
+bool qualbin_scheme_deserialize(QualbinScheme *scheme, const GtUchar *src,
+    unsigned long length) {
+
+  unsigned long bin;
+
+  if (length < 2UL || src[1] == 0 || src[1] > QUALBIN_MAXBINS
+      || length != 2UL + 2UL * src[1]) {
+    return false;
+  }
+  scheme->offset = src[0];
+  scheme->numofbins = src[1];
+  for (bin = 0; bin < scheme->numofbins; bin++) {
+    scheme->lower[bin] = src[2 + 2 * bin];
+    scheme->value[bin] = src[3 + 2 * bin];
+  }
+  return true;
+}
+
+/* Show the <scheme> as list of pairs in the syntax accepted by
+ qualbin_scheme_parse on <fp>. */
+
+void qualbin_scheme_show(FILE *fp, const QualbinScheme *scheme) {
+  unsigned long bin;
+
+  for (bin = 0; bin < scheme->numofbins; bin++) {
+    fprintf(fp, "%s%u:%u", bin == 0 ? "" : ",",
+        (unsigned int) scheme->lower[bin], (unsigned int) scheme->value[bin]);
+  }
+}
@@ -0,0 +1,76 @@
+#ifndef QUALBIN_H
+#define QUALBIN_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "../bwt-compress/gt-defs.h"
+
+/* A binning scheme maps the quality values to a few levels, which is a
+   lossy transformation. The Phred values are divided into bins by the
+   lower bounds <lower[0]> = 0 < <lower[1]> < ... and each value in bin
+   i is replaced by <value[i]>. The quality characters are the Phred
+   values plus the ASCII <offset> of the file, which is either 33 or
+   64. The scheme "illumina8" is the 8 level binning of Illumina:
+
+     Phred  0..1  2..9  10..19  20..24  25..29  30..34  35..39  >= 40
+     bin       0     6      15      22      27      33      37     40
+
+   Other schemes are given as a comma separated list of pairs
+   <lower>:<value>, e.g. "0:0,2:6,10:15,20:22,25:27,30:33,35:37,40:40"
+   for the scheme above. */
+
+#define QUALBIN_MAXBINS       16UL
+#define QUALBIN_SERIALSIZE    (2UL + 2UL * QUALBIN_MAXBINS)
+
+typedef struct {
+  unsigned long numofbins;
+  GtUchar offset,
+          lower[QUALBIN_MAXBINS], /* smallest Phred value of the bin */
+          value[QUALBIN_MAXBINS]; /* Phred value representing the bin */
+} QualbinScheme;
+
+/* The following function parses the binning scheme given by <spec> and
+   stores it with the given <offset> in <scheme>. If <spec> is not a
+   valid scheme, then an error is reported to stderr and false is
+   returned. */
+
+bool qualbin_scheme_parse(QualbinScheme *scheme, const char *spec,
+                          GtUchar offset);
+
+/* The following function checks that none of the <length> quality
+   characters in <qual> is below the ASCII <offset>. The offset is not
+   guessed from the characters, since Phred+33 values of at least 26
+   are also valid Phred+64 values and the binning is lossy. */
+
+bool qualbin_offset_valid(const GtUchar *qual, unsigned long length,
+                          GtUchar offset);
+
+/* The following function replaces each of the <length> quality
+   characters in <qual> by the representative of its bin. The bins are
+   determined by comparisons with the lower bounds and a table lookup,
+   which process 32 characters at once if the processor supports AVX2.
+   Characters below the offset are mapped to the first bin. */
+
+void qualbin_apply(const QualbinScheme *scheme, GtUchar *qual,
+                   unsigned long length);
+
+/* The following function stores <scheme> in <dest>, which provides
+   space for QUALBIN_SERIALSIZE bytes, and returns the number of bytes
+   used. */
+
+unsigned long qualbin_scheme_serialize(GtUchar *dest,
+                                       const QualbinScheme *scheme);
+
+/* The following function reads a scheme of <length> bytes stored by
+   qualbin_scheme_serialize from <src>. Returns false if <src> is not a
+   valid scheme. */
+
+bool qualbin_scheme_deserialize(QualbinScheme *scheme, const GtUchar *src,
+                                unsigned long length);
+
+/* Show the <scheme> as list of pairs in the syntax accepted by
+   qualbin_scheme_parse on <fp>. */
+
+void qualbin_scheme_show(FILE *fp, const QualbinScheme *scheme);
+
+#endif
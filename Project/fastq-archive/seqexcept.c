@@ -0,0 +1,132 @@
+#include <string.h>
+#include <limits.h>
+
+#include "../bwt-compress/gt-alloc.h"
+#include "../bwt-compress/varint.h"
+#include "seqexcept.h"
+
+#define SEQEXCEPT_ISBASE(C)\
+        ((C) == 'A' || (C) == 'C' || (C) == 'G' || (C) == 'T')
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+/**
+ * Copy the prefix of <sequence> consisting of 16 byte
+ * chunks of bases to <dest>, returns its length
+ */
+static unsigned long seqexcept_copybases(GtUchar *dest,
+    const GtUchar *sequence, unsigned long length) {
+
+  const __m128i a = _mm_set1_epi8('A'), c = _mm_set1_epi8('C'),
+      g = _mm_set1_epi8('G'), t = _mm_set1_epi8('T');
+  unsigned long idx;
+
+  for (idx = 0; idx + 16 <= length; idx += 16) {
+    const __m128i chars = _mm_loadu_si128((const __m128i *) (sequence + idx));
+    const __m128i isbase = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chars, a), _mm_cmpeq_epi8(chars, c)),
+        _mm_or_si128(_mm_cmpeq_epi8(chars, g), _mm_cmpeq_epi8(chars, t)));
+
+    if (_mm_movemask_epi8(isbase) != 0xFFFF) {
+      break;
+    }
+    _mm_storeu_si128((__m128i *) (dest + idx), chars);
+  }
+  return idx;
+}
+#else
+static unsigned long seqexcept_copybases(GT_UNUSED GtUchar *dest,
+    GT_UNUSED const GtUchar *sequence, GT_UNUSED unsigned long length) {
+  return 0;
+}
+#endif
+
+/* The following function copies the <length> characters of <sequence>
+ to <dest>, replacing each character other than A, C, G and T by
+ SEQEXCEPT_PLACEHOLDER. The list of the replaced runs is returned, its
+ length is stored in <listlength> and the number of runs in
+ <numofruns>. The user is responsible to free the returned memory. */
+
+GtUchar *seqexcept_extract(unsigned long *listlength,
+    unsigned long *numofruns, GtUchar *dest, const GtUchar *sequence,
+    unsigned long length) {
+
+  GtUchar * runs = NULL, * list = NULL;
+  unsigned long idx = 0, runslength = 0, allocated = 0, previousend = 0;
+
+  *numofruns = 0;
+  while (idx < length) {
+    unsigned long runstart;
+
+    /* most of the sequence consists of bases, skip them in chunks */
+    idx += seqexcept_copybases(dest + idx, sequence + idx, length - idx);
+    while (idx < length && SEQEXCEPT_ISBASE(sequence[idx])) {
+      dest[idx] = sequence[idx];
+      idx++;
+    }
+    if (idx == length) {
+      break;
+    }
+    runstart = idx;
+    while (idx < length && sequence[idx] == sequence[runstart]) {
+      dest[idx++] = SEQEXCEPT_PLACEHOLDER;
+    }
+    if (runslength + 2 * VARINT_MAXBYTES + 1 > allocated) {
+      allocated = allocated * 2 + 2 * VARINT_MAXBYTES + 1;
+      runs = gt_realloc(runs, (size_t) allocated);
+    }
+    runslength += varint_put(runs + runslength, runstart - previousend);
+    runs[runslength++] = sequence[runstart];
+    runslength += varint_put(runs + runslength, idx - runstart);
+    previousend = idx;
+    (*numofruns)++;
+  }
+
+  list = gt_malloc((size_t) VARINT_MAXBYTES + runslength);
+  *listlength = varint_put(list, *numofruns);
+  if (runslength > 0) {
+    memcpy(list + *listlength, runs, (size_t) runslength);
+  }
+  *listlength += runslength;
+  gt_free(runs);
+  return list;
+}
+
+/* The following function restores the exceptions of the list of
+ <listlength> bytes stored in <list> in the <length> characters of
+ <sequence>, which are the characters at the positions
+ <start>..<start>+<length>-1 of the sequence for which the list was
+ created. Returns false if the list is corrupted. */
+
+bool seqexcept_restore(GtUchar *sequence, unsigned long start,
+    unsigned long length, const GtUchar *list, unsigned long listlength) {
+
+  const GtUchar * end = list + listlength;
+  unsigned long run, numofruns, position = 0;
+
+  if (!varint_get(&list, end, &numofruns)) {
+    return false;
+  }
+  for (run = 0; run < numofruns && position < start + length; run++) {
+    unsigned long gap, runlength, idx;
+    GtUchar symbol;
+
+    if (!varint_get(&list, end, &gap) || list == end) {
+      return false;
+    }
+    symbol = *list++;
+    if (!varint_get(&list, end, &runlength) || runlength == 0
+        || gap > ULONG_MAX - position - runlength) {
+      return false;
+    }
+    position += gap;
+    /* the part of the run inside the window */
+    for (idx = position > start ? position : start;
+        idx < position + runlength && idx < start + length; idx++) {
+      sequence[idx - start] = symbol;
+    }
+    position += runlength;
+  }
+  return run == numofruns ? list == end : true;
+}
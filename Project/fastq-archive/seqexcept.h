@@ -0,0 +1,40 @@
+#ifndef SEQEXCEPT_H
+#define SEQEXCEPT_H
+
+#include <stdbool.h>
+#include "../bwt-compress/gt-defs.h"
+
+/* The sequences of Fastq-files consist mainly of the bases A, C, G and
+   T. All other characters, e.g. runs of the wildcard N, are moved to a
+   list of exceptions and replaced by SEQEXCEPT_PLACEHOLDER, so that the
+   remaining sequence is over the alphabet ACGT. Each exception is a run
+   of the same character. The list is stored as the number of runs
+   followed by a triple for each run: the distance from the end of the
+   previous run (as varint), the character (1 byte) and the length of
+   the run (as varint). */
+
+#define SEQEXCEPT_PLACEHOLDER 'A'
+
+/* The following function copies the <length> characters of <sequence>
+   to <dest>, replacing each character other than A, C, G and T by
+   SEQEXCEPT_PLACEHOLDER. The list of the replaced runs is returned, its
+   length is stored in <listlength> and the number of runs in
+   <numofruns>. The user is responsible to free the returned memory. */
+
+GtUchar *seqexcept_extract(unsigned long *listlength,
+                           unsigned long *numofruns,
+                           GtUchar *dest,
+                           const GtUchar *sequence,
+                           unsigned long length);
+
+/* The following function restores the exceptions of the list of
+   <listlength> bytes stored in <list> in the <length> characters of
+   <sequence>, which are the characters at the positions
+   <start>..<start>+<length>-1 of the sequence for which the list was
+   created. Returns false if the list is corrupted. */
+
+bool seqexcept_restore(GtUchar *sequence, unsigned long start,
+                       unsigned long length, const GtUchar *list,
+                       unsigned long listlength);
+
+#endif
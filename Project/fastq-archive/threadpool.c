@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../bwt-compress/gt-alloc.h"
+#include "threadpool.h"
+
+/* A submitted job, the jobs of a worker form a double ended queue */
+typedef struct ThreadpoolJob {
+  ThreadpoolFunc func;
+  void * data;
+  struct ThreadpoolJob * prev, * next;
+} ThreadpoolJob;
+
+/* The queue of a worker thread, protected by its own mutex */
+typedef struct {
+  pthread_mutex_t mutex;
+  ThreadpoolJob * first, * last;
+  Threadpool * pool;
+  unsigned long idx;
+} ThreadpoolWorker;
+
+struct Threadpool {
+  pthread_mutex_t mutex;
+  pthread_cond_t available;
+  pthread_t * threads;
+  ThreadpoolWorker * workers;
+  unsigned long numofthreads,
+                pending,    /* jobs in the queues not claimed by a worker */
+                nextworker, /* queue of the next job submitted from outside */
+                numofsteals;
+  bool shutdown;
+};
+
+/* The worker executed by the current thread, NULL outside of a pool */
+static __thread ThreadpoolWorker *threadpool_self = NULL;
+
+/**
+ * Append <job> to the end of the queue
+ * of <worker>
+ */
+static void threadpool_push(ThreadpoolWorker *worker, ThreadpoolJob *job) {
+  pthread_mutex_lock(&worker->mutex);
+  job->next = NULL;
+  job->prev = worker->last;
+  if (worker->last == NULL) {
+    worker->first = job;
+  } else {
+    worker->last->next = job;
+  }
+  worker->last = job;
+  pthread_mutex_unlock(&worker->mutex);
+}
+
+/**
+ * Remove the first job of the queue of <worker>
+ * or the last one if <steal> is true. Returns
+ * NULL if the queue is empty
+ */
+static ThreadpoolJob *threadpool_pop(ThreadpoolWorker *worker, bool steal) {
+  ThreadpoolJob * job = NULL;
+
+  pthread_mutex_lock(&worker->mutex);
+  job = steal ? worker->last : worker->first;
+  if (job != NULL) {
+    if (job->prev == NULL) {
+      worker->first = job->next;
+    } else {
+      job->prev->next = job->next;
+    }
+    if (job->next == NULL) {
+      worker->last = job->prev;
+    } else {
+      job->next->prev = job->prev;
+    }
+  }
+  pthread_mutex_unlock(&worker->mutex);
+  return job;
+}
+
+/**
+ * Worker thread: claim a pending job, take it from the
+ * front of the own queue or steal it from the end of
+ * the queue of another worker, and execute it until the
+ * pool is shut down and all queues are empty
+ */
+static void *threadpool_worker(void *arg) {
+  ThreadpoolWorker * self = arg;
+  Threadpool * pool = self->pool;
+
+  threadpool_self = self;
+  while (true) {
+    ThreadpoolJob * job = NULL;
+    unsigned long idx;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->pending == 0 && !pool->shutdown) {
+      pthread_cond_wait(&pool->available, &pool->mutex);
+    }
+    if (pool->pending == 0) {
+      pthread_mutex_unlock(&pool->mutex);
+      break;
+    }
+    pool->pending--;
+    pthread_mutex_unlock(&pool->mutex);
+
+    /* the claim guarantees that one of the queues holds a job for us */
+    job = threadpool_pop(self, false);
+    for (idx = 1; job == NULL; idx++) {
+      job = threadpool_pop(pool->workers
+          + (self->idx + idx) % pool->numofthreads, true);
+      if (job != NULL) {
+        pthread_mutex_lock(&pool->mutex);
+        pool->numofsteals++;
+        pthread_mutex_unlock(&pool->mutex);
+      }
+    }
+    job->func(job->data);
+    gt_free(job);
+  }
+  return NULL;
+}
+
+/* Create a pool with <numofthreads> worker threads, at least one
+ thread is created. */
+
+Threadpool *threadpool_new(unsigned long numofthreads) {
+  Threadpool * pool = gt_malloc(sizeof *pool);
+  unsigned long idx;
+
+  pool->numofthreads = numofthreads > 0 ? numofthreads : 1UL;
+  pool->threads = gt_malloc(pool->numofthreads * sizeof *pool->threads);
+  pool->workers = gt_malloc(pool->numofthreads * sizeof *pool->workers);
+  pool->pending = pool->nextworker = pool->numofsteals = 0;
+  pool->shutdown = false;
+  pthread_mutex_init(&pool->mutex, NULL);
+  pthread_cond_init(&pool->available, NULL);
+  for (idx = 0; idx < pool->numofthreads; idx++) {
+    pthread_mutex_init(&pool->workers[idx].mutex, NULL);
+    pool->workers[idx].first = pool->workers[idx].last = NULL;
+    pool->workers[idx].pool = pool;
+    pool->workers[idx].idx = idx;
+  }
+  for (idx = 0; idx < pool->numofthreads; idx++) {
+    if (pthread_create(pool->threads + idx, NULL, threadpool_worker,
+        pool->workers + idx) != 0) {
+      fprintf(stderr, "%s: can not create thread\n", __func__);
+      exit(EXIT_FAILURE);
+    }
+  }
+  return pool;
+}
+
+/* Deliver the number of worker threads of the <pool>. */
+
+unsigned long threadpool_numofthreads(const Threadpool *pool) {
+  return pool->numofthreads;
+}
+
+/* Submit the job <func> applied to <data> to the <pool>. A job
+ submitted by a worker of the <pool> is appended to the queue of this
+ worker, otherwise the queues are filled round robin. */
+
+void threadpool_submit(Threadpool *pool, ThreadpoolFunc func, void *data) {
+  ThreadpoolJob * job = gt_malloc(sizeof *job);
+  ThreadpoolWorker * worker = threadpool_self;
+
+  job->func = func;
+  job->data = data;
+  if (worker == NULL || worker->pool != pool) {
+    pthread_mutex_lock(&pool->mutex);
+    worker = pool->workers + pool->nextworker;
+    pool->nextworker = (pool->nextworker + 1) % pool->numofthreads;
+    pthread_mutex_unlock(&pool->mutex);
+  }
+  threadpool_push(worker, job);
+  pthread_mutex_lock(&pool->mutex);
+  pool->pending++;
+  pthread_cond_signal(&pool->available);
+  pthread_mutex_unlock(&pool->mutex);
+}
+
+/* Deliver the number of jobs which were executed by another worker
+ than the one they were submitted to. */
+
+unsigned long threadpool_numofsteals(Threadpool *pool) {
+  unsigned long numofsteals;
+
+  pthread_mutex_lock(&pool->mutex);
+  numofsteals = pool->numofsteals;
+  pthread_mutex_unlock(&pool->mutex);
+  return numofsteals;
+}
+
+/* Wait until all submitted jobs are finished, terminate the worker
+ threads and delete the <pool>. */
+
+void threadpool_delete(Threadpool *pool) {
+  unsigned long idx;
+
+  if (pool == NULL) {
+    return;
+  }
+  pthread_mutex_lock(&pool->mutex);
+  pool->shutdown = true;
+  pthread_cond_broadcast(&pool->available);
+  pthread_mutex_unlock(&pool->mutex);
+  for (idx = 0; idx < pool->numofthreads; idx++) {
+    pthread_join(pool->threads[idx], NULL);
+  }
+  for (idx = 0; idx < pool->numofthreads; idx++) {
+    pthread_mutex_destroy(&pool->workers[idx].mutex);
+  }
+  pthread_cond_destroy(&pool->available);
+  pthread_mutex_destroy(&pool->mutex);
+  gt_free(pool->workers);
+  gt_free(pool->threads);
+  gt_free(pool);
+}
+
+/* Deliver the number of processors which are online, at least 1. */
+
+unsigned long threadpool_numofprocessors(void) {
+  const long numofprocessors = sysconf(_SC_NPROCESSORS_ONLN);
+
+  return numofprocessors > 0 ? (unsigned long) numofprocessors : 1UL;
+}
@@ -0,0 +1,45 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+/* A pool of worker threads which execute jobs. A job is a function
+   applied to a pointer to its data. Each worker has its own queue and
+   executes the jobs from its front in the order in which they are
+   submitted. A worker whose queue is empty steals the job at the end of
+   the queue of another worker, i.e. the job which was submitted last
+   and whose result is needed last. The pool does not bound the number
+   of waiting jobs, this is the responsibility of the user. */
+
+typedef struct Threadpool Threadpool;
+
+typedef void (*ThreadpoolFunc)(void *data);
+
+/* Create a pool with <numofthreads> worker threads, at least one
+   thread is created. */
+
+Threadpool *threadpool_new(unsigned long numofthreads);
+
+/* Deliver the number of worker threads of the <pool>. */
+
+unsigned long threadpool_numofthreads(const Threadpool *pool);
+
+/* Submit the job <func> applied to <data> to the <pool>. A job
+   submitted by a worker of the <pool> is appended to the queue of this
+   worker, otherwise the queues are filled round robin. */
+
+void threadpool_submit(Threadpool *pool, ThreadpoolFunc func, void *data);
+
+/* Deliver the number of jobs which were executed by another worker
+   than the one they were submitted to. */
+
+unsigned long threadpool_numofsteals(Threadpool *pool);
+
+/* Wait until all submitted jobs are finished, terminate the worker
+   threads and delete the <pool>. */
+
+void threadpool_delete(Threadpool *pool);
+
+/* Deliver the number of processors which are online, at least 1. */
+
+unsigned long threadpool_numofprocessors(void);
+
+#endif
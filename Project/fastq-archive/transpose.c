@@ -0,0 +1,97 @@
+#include "transpose.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+/**
+ * Transpose a block of 16 x 16 bytes by four perfect
+ * shuffles of the rows, each interleaving the bytes of
+ * row i and row i+8
+ */
+static void transpose_block16(GtUchar *dest, unsigned long deststride,
+    const GtUchar *src, unsigned long srcstride) {
+
+  __m128i rows[16], shuffled[16];
+  unsigned long idx, stage;
+
+  for (idx = 0; idx < 16; idx++) {
+    rows[idx] = _mm_loadu_si128((const __m128i *) (src + idx * srcstride));
+  }
+  for (stage = 0; stage < 4; stage++) {
+    for (idx = 0; idx < 8; idx++) {
+      shuffled[2 * idx] = _mm_unpacklo_epi8(rows[idx], rows[idx + 8]);
+      shuffled[2 * idx + 1] = _mm_unpackhi_epi8(rows[idx], rows[idx + 8]);
+    }
+    for (idx = 0; idx < 16; idx++) {
+      rows[idx] = shuffled[idx];
+    }
+  }
+  for (idx = 0; idx < 16; idx++) {
+    _mm_storeu_si128((__m128i *) (dest + idx * deststride), rows[idx]);
+  }
+}
+#define TRANSPOSE_BLOCKSIZE 16UL
+#else
+#define TRANSPOSE_BLOCKSIZE 1UL
+#endif
+
+/**
+ * Transpose the tile of the rows <firstrow>..<lastrow>-1 and
+ * the columns <firstcolumn>..<lastcolumn>-1
+ */
+static void transpose_tile(GtUchar *dest, const GtUchar *src,
+    unsigned long rows, unsigned long columns, unsigned long firstrow,
+    unsigned long lastrow, unsigned long firstcolumn,
+    unsigned long lastcolumn) {
+
+  unsigned long r = firstrow, c;
+
+#ifdef __SSE2__
+  for (/* Nothing */; r + TRANSPOSE_BLOCKSIZE <= lastrow;
+      r += TRANSPOSE_BLOCKSIZE) {
+    for (c = firstcolumn; c + TRANSPOSE_BLOCKSIZE <= lastcolumn;
+        c += TRANSPOSE_BLOCKSIZE) {
+      transpose_block16(dest + c * rows + r, rows, src + r * columns + c,
+          columns);
+    }
+    /* the columns right of the last block */
+    for (/* Nothing */; c < lastcolumn; c++) {
+      unsigned long i;
+
+      for (i = r; i < r + TRANSPOSE_BLOCKSIZE; i++) {
+        dest[c * rows + i] = src[i * columns + c];
+      }
+    }
+  }
+#endif
+  for (/* Nothing */; r < lastrow; r++) {
+    for (c = firstcolumn; c < lastcolumn; c++) {
+      dest[c * rows + r] = src[r * columns + c];
+    }
+  }
+}
+
+/* The following function transposes the matrix of <rows> x <columns>
+ bytes stored row by row in <src> and stores it row by row in <dest>,
+ i.e. dest[c * rows + r] = src[r * columns + c]. The matrix is
+ processed in tiles of TRANSPOSE_TILESIZE x TRANSPOSE_TILESIZE bytes,
+ which fit into the L1 cache, each tile in blocks of 16 x 16 bytes
+ with SSE2. Transposing the result with <rows> and <columns> swapped
+ restores the original matrix. <dest> and <src> must not overlap. */
+
+void transpose_bytes(GtUchar *dest, const GtUchar *src, unsigned long rows,
+    unsigned long columns) {
+
+  unsigned long r, c;
+
+  for (r = 0; r < rows; r += TRANSPOSE_TILESIZE) {
+    const unsigned long lastrow = r + TRANSPOSE_TILESIZE < rows
+        ? r + TRANSPOSE_TILESIZE : rows;
+
+    for (c = 0; c < columns; c += TRANSPOSE_TILESIZE) {
+      transpose_tile(dest, src, rows, columns, r, lastrow, c,
+          c + TRANSPOSE_TILESIZE < columns ? c + TRANSPOSE_TILESIZE
+              : columns);
+    }
+  }
+}
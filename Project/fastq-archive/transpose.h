@@ -0,0 +1,24 @@
+#ifndef TRANSPOSE_H
+#define TRANSPOSE_H
+
+#include "../bwt-compress/gt-defs.h"
+
+/* For reads of a fixed length, the quality values of the same cycle
+   are correlated across the reads. Transposing the quality values of a
+   block, i.e. viewing them as a matrix with one row per read and one
+   column per cycle, stores the values cycle by cycle. */
+
+#define TRANSPOSE_TILESIZE 64UL
+
+/* The following function transposes the matrix of <rows> x <columns>
+   bytes stored row by row in <src> and stores it row by row in <dest>,
+   i.e. dest[c * rows + r] = src[r * columns + c]. The matrix is
+   processed in tiles of TRANSPOSE_TILESIZE x TRANSPOSE_TILESIZE bytes,
+   which fit into the L1 cache, each tile in blocks of 16 x 16 bytes
+   with SSE2. Transposing the result with <rows> and <columns> swapped
+   restores the original matrix. <dest> and <src> must not overlap. */
+
+void transpose_bytes(GtUchar *dest, const GtUchar *src, unsigned long rows,
+                     unsigned long columns);
+
+#endif
@@ -14,12 +14,38 @@
 #include <string.h>
 #include <assert.h>
 #include <limits.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/stat.h>
+#include <pthread.h>
 #include "fastq-concat/fastq-parse/fastq-parse.h"
 #include "fastq-concat/fastq-concat.h"
 #include "bwt-compress/gt-alloc.h"
 #include "bwt-compress/sk-sain.h"
 #include "bwt-compress/sktimer.h"
 #include "bwt-compress/bwt-compress.h"
+#include "bwt-compress/varint.h"
+#include "bwt-compress/runstats.h"
+#include "fastq-concat/fastq-assert.h"
+#include "fastq-archive/fastq-archive.h"
+#include "fastq-archive/qualbin.h"
+#include "fastq-archive/threadpool.h"
+
+#define FASTQ_COMPRESS_DEFAULTMEMORY (4UL << 30)
+#define FASTQ_COMPRESS_JOBSPERTHREAD 2UL
+#define FASTQ_COMPRESS_SPOTCHECKS    4UL
+
+/* How the sections are checked after they are encoded: not at all, by
+ walking a few ranges of entries of the sampled sections and decoding
+ the other sections, or by decoding all sections and, in addition, the
+ round trip of the BWT of all sequences before the blocks are
+ compressed. The checksums of the sections are always stored and
+ verified by the decoder. */
+typedef enum {
+  FASTQ_COMPRESS_VERIFY_NONE,
+  FASTQ_COMPRESS_VERIFY_SAMPLE,
+  FASTQ_COMPRESS_VERIFY_FULL
+} FastqCompressVerify;
 
 void process_entry(const char * header, const char * sequence,
     const char *quality, unsigned long length) {
@@ -27,57 +53,760 @@ void process_entry(const char * header, const char * sequence,
       sequence, quality, length);
 }
 
+/**
+ * Parse a size with an optional suffix K, M
+ * or G for the given <what>, which must not
+ * exceed <maxsize>
+ */
+unsigned long fastq_compress_parsesize(const char *arg, const char *what,
+    unsigned long maxsize) {
+  char * end = NULL;
+  unsigned long size = strtoul(arg, &end, 10);
+
+  switch (*end) {
+  case 'G':
+    size <<= 10;
+    /* fall through */
+  case 'M':
+    size <<= 10;
+    /* fall through */
+  case 'K':
+    size <<= 10;
+    end++;
+    break;
+  }
+  if (end == arg || *end != '\0' || size == 0 || size > maxsize) {
+    fprintf(stderr, "Illegal %s %s, must be in the range 1..%lu\n", what, arg,
+        maxsize);
+    exit(EXIT_FAILURE);
+  }
+  return size;
+}
+
+/**
+ * Determine the number of entries of the block
+ * starting with entry <firstentry>, such that the
+ * sequences and the header lines of the block do
+ * not exceed the <blocksize> (unless the block
+ * consists of a single entry).
+ */
+unsigned long fastq_compress_blockentries(const FastqConcat *sq,
+    unsigned long firstentry, unsigned long blocksize) {
+
+  const unsigned long numofentries = fastq_concat_numofentries(sq);
+  unsigned long idx, headerstart, seqstart;
+
+  fastq_concat_entryoffsets(sq, firstentry, &headerstart, &seqstart);
+  for (idx = firstentry + 1; idx < numofentries; idx++) {
+    unsigned long headeroffset, seqoffset;
+
+    fastq_concat_entryoffsets(sq, idx + 1, &headeroffset, &seqoffset);
+    if (seqoffset - seqstart > blocksize
+        || headeroffset - headerstart > blocksize) {
+      break;
+    }
+  }
+  return idx - firstentry;
+}
+
+/**
+ * Report the time used by a <stage> for
+ * a section to <logfp>
+ */
+void fastq_compress_showtime(FILE *logfp, GtSKtimer *sktimer,
+    const char *stage, unsigned long section, unsigned long length) {
+  if (logfp != NULL) {
+    double elapsed = gt_SKtimer_elapsed(sktimer);
+
+    fprintf(logfp, "# TIME %s %s %.2f (%.2f MB/s)\n", stage,
+        fastq_archive_section_name(section), elapsed,
+        elapsed > 0.0 ? length / (elapsed * 1000000.0) : 0.0);
+  }
+}
+
+/* A section of a block, which is compressed by a thread of the pool */
+typedef struct {
+  struct FastqCompressJob * job;
+  unsigned long section;
+} FastqCompressTask;
+
+/* The compression of a single block */
+typedef struct FastqCompressJob {
+  unsigned long firstentry, numofentries, numoffinished;
+  FastqArchiveBlock block;
+  const GtUchar * raw[FASTQ_ARCHIVE_NUMOFSECTIONS];
+  unsigned long rawlength[FASTQ_ARCHIVE_NUMOFSECTIONS],
+                memory[FASTQ_ARCHIVE_NUMOFSECTIONS];
+  GtUchar * coded[FASTQ_ARCHIVE_NUMOFSECTIONS];
+  GtUchar * lengths;
+  unsigned long * headerlengths, * seqlengths;
+  bool submitted[FASTQ_ARCHIVE_NUMOFSECTIONS];
+  FastqCompressTask task[FASTQ_ARCHIVE_NUMOFSECTIONS];
+  struct FastqCompressor * compressor;
+} FastqCompressJob;
+
+/* The sections of the blocks are compressed concurrently by the threads
+ of the pool. A section is only submitted if the number of threads
+ compressing this section stays below its share of the threads, which
+ is proportional to the total size of the section, and if the estimated
+ memory of all sections in flight stays below the memory limit. A
+ section exceeding the limit on its own is submitted when no other
+ section is in flight. The blocks are appended to the archive in their
+ original order: a block which is finished before its predecessors
+ waits in the window of blocks in flight. */
+typedef struct FastqCompressor {
+  pthread_mutex_t mutex;
+  pthread_cond_t finished;
+  FastqCompressJob ** window;
+  unsigned long windowsize, nextread, nextwrite, samplerate, memory,
+      memorylimit, peakmemory;
+  FastqCompressVerify verify;
+  unsigned long running[FASTQ_ARCHIVE_NUMOFSECTIONS],
+                maxrunning[FASTQ_ARCHIVE_NUMOFSECTIONS],
+                order[FASTQ_ARCHIVE_NUMOFSECTIONS]; /* largest first */
+  FastqArchiveWriter * writer;
+  Threadpool * pool;
+  FILE * logfp;
+  const FastqConcat * sq;
+  const FastqArchiveCodec * codecs;
+  const GtUchar * flags;
+} FastqCompressor;
+
+/**
+ * Determine the share of the <numofthreads> threads of
+ * each section from the total sizes of the sections,
+ * each section gets at least one thread, and the order
+ * in which the sections of a block are submitted
+ */
+void fastq_compress_shares(FastqCompressor *compressor,
+    unsigned long numofthreads) {
+
+  const FastqConcat * sq = compressor->sq;
+  unsigned long size[FASTQ_ARCHIVE_NUMOFSECTIONS], total = 0, section, idx;
+
+  fastq_concat_entryoffsets(sq, fastq_concat_numofentries(sq),
+      size + FASTQ_ARCHIVE_HEADER, size + FASTQ_ARCHIVE_SEQUENCE);
+  size[FASTQ_ARCHIVE_QUALITY] = size[FASTQ_ARCHIVE_SEQUENCE];
+  size[FASTQ_ARCHIVE_LENGTHS] = 2 * fastq_concat_numofentries(sq);
+  for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+    total += size[section];
+  }
+  for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+    compressor->maxrunning[section] = total > 0
+        ? (unsigned long) ((double) numofthreads * size[section] / total + 0.5)
+        : 1UL;
+    if (compressor->maxrunning[section] == 0) {
+      compressor->maxrunning[section] = 1UL;
+    }
+    compressor->running[section] = 0;
+
+    /* insertion sort by decreasing size */
+    for (idx = section; idx > 0
+        && size[compressor->order[idx - 1]] < size[section]; idx--) {
+      compressor->order[idx] = compressor->order[idx - 1];
+    }
+    compressor->order[idx] = section;
+  }
+}
+
+/**
+ * Collect the sections of the entries of a block
+ * and estimate the memory required to compress
+ * and check each of them
+ */
+void fastq_compress_prepare(FastqCompressJob *job) {
+
+  const FastqConcat * sq = job->compressor->sq;
+  const unsigned long firstentry = job->firstentry,
+      numofentries = job->numofentries;
+  unsigned long idx, section, headerstart, headerend, seqstart, seqend;
+
+  /* the lengths of the header lines and sequences of the entries */
+  job->lengths = gt_malloc((size_t) 2 * numofentries * VARINT_MAXBYTES);
+  job->headerlengths = gt_malloc((size_t) numofentries
+      * sizeof *job->headerlengths);
+  job->seqlengths = gt_malloc((size_t) numofentries
+      * sizeof *job->seqlengths);
+  job->rawlength[FASTQ_ARCHIVE_LENGTHS] = 0;
+  for (idx = firstentry; idx < firstentry + numofentries; idx++) {
+    unsigned long headerlength, seqlength;
+
+    fastq_concat_entrylengths(sq, idx, &headerlength, &seqlength);
+    job->headerlengths[idx - firstentry] = headerlength;
+    job->seqlengths[idx - firstentry] = seqlength;
+    job->rawlength[FASTQ_ARCHIVE_LENGTHS] += varint_put(
+        job->lengths + job->rawlength[FASTQ_ARCHIVE_LENGTHS], headerlength);
+    job->rawlength[FASTQ_ARCHIVE_LENGTHS] += varint_put(
+        job->lengths + job->rawlength[FASTQ_ARCHIVE_LENGTHS], seqlength);
+  }
+  job->raw[FASTQ_ARCHIVE_LENGTHS] = job->lengths;
+
+  /* the other sections are substrings of the concatenations */
+  fastq_concat_entryoffsets(sq, firstentry, &headerstart, &seqstart);
+  fastq_concat_entryoffsets(sq, firstentry + numofentries, &headerend,
+      &seqend);
+  job->raw[FASTQ_ARCHIVE_HEADER] = fastq_concat_header(sq) + headerstart;
+  job->rawlength[FASTQ_ARCHIVE_HEADER] = headerend - headerstart;
+  job->raw[FASTQ_ARCHIVE_SEQUENCE] = fastq_concat_seq(sq) + seqstart;
+  job->rawlength[FASTQ_ARCHIVE_SEQUENCE] = seqend - seqstart;
+  job->raw[FASTQ_ARCHIVE_QUALITY] = fastq_concat_qual(sq) + seqstart;
+  job->rawlength[FASTQ_ARCHIVE_QUALITY] = seqend - seqstart;
+
+  job->block.numofentries = numofentries;
+  job->numoffinished = 0;
+  for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+    const FastqArchiveCodec codec = job->compressor->codecs[section];
+    const GtUchar flags = job->compressor->flags[section];
+    const unsigned long encode = fastq_archive_section_memory(codec, flags,
+        job->rawlength[section], true),
+        decode = fastq_archive_section_memory(codec, flags,
+        job->rawlength[section], false);
+
+    /* the workspace of the encoder is freed before the check, the code
+     is at most as long as the section */
+    job->memory[section] = 2 * job->rawlength[section]
+        + (encode > decode ? encode : decode);
+    job->coded[section] = NULL;
+    job->submitted[section] = false;
+    job->task[section].job = job;
+    job->task[section].section = section;
+  }
+}
+
+/**
+ * Compress a section of a block with the given codec,
+ * flags and samplerate and check it with the decoder
+ * as requested, executed by the threads of the pool
+ */
+void fastq_compress_section(void *data) {
+
+  FastqCompressTask * task = data;
+  FastqCompressJob * job = task->job;
+  FastqCompressor * compressor = job->compressor;
+  FILE * logfp = compressor->logfp;
+  const unsigned long section = task->section,
+      numofentries = job->numofentries;
+  const unsigned long *entrylengths = section == FASTQ_ARCHIVE_HEADER
+      ? job->headerlengths : job->seqlengths;
+  GtSKtimer * sktimer = gt_SKtimer_new();
+  RunstatsMark mark;
+  bool equal = true;
+
+  GT_SKTRACE_BEGIN(fastq_archive_section_name(section),
+      job->rawlength[section]);
+  job->block.section[section].flags = compressor->flags[section];
+  job->coded[section] = fastq_archive_section_encode(logfp,
+      job->block.section + section, (FastqArchiveSection) section,
+      compressor->codecs[section], job->raw[section],
+      job->rawlength[section], entrylengths, numofentries,
+      compressor->samplerate);
+  gt_SKtimer_start(sktimer);
+  GT_SKTRACE_BEGIN("verify", job->rawlength[section]);
+  runstats_mark(&mark);
+  if (compressor->verify == FASTQ_COMPRESS_VERIFY_FULL) {
+    GtUchar * decoded = fastq_archive_section_decode(job->block.section
+        + section, job->coded[section], entrylengths, numofentries);
+
+    equal = memcmp(job->raw[section], decoded, job->rawlength[section]) == 0;
+    gt_free(decoded);
+    fastq_compress_showtime(logfp, sktimer, "decode", section,
+        job->rawlength[section]);
+  } else if (compressor->verify == FASTQ_COMPRESS_VERIFY_SAMPLE) {
+    equal = fastq_archive_section_spotcheck(job->block.section + section,
+        job->coded[section], job->raw[section], job->rawlength[section],
+        entrylengths, numofentries, FASTQ_COMPRESS_SPOTCHECKS,
+        job->firstentry * FASTQ_ARCHIVE_NUMOFSECTIONS + section);
+    fastq_compress_showtime(logfp, sktimer, "spotcheck", section,
+        job->rawlength[section]);
+  }
+  if (compressor->verify != FASTQ_COMPRESS_VERIFY_NONE) {
+    runstats_end(RUNSTATS_VERIFY, &mark, job->rawlength[section]);
+  }
+  GT_SKTRACE_END;
+  if (!equal) {
+    fprintf(stderr, "%s: decoded %s section differs from the input\n",
+        __func__, fastq_archive_section_name(section));
+    exit(EXIT_FAILURE);
+  }
+  if (logfp != NULL) {
+    fprintf(logfp, "# SIZE %s %lu -> %lu\n",
+        fastq_archive_section_name(section), job->rawlength[section],
+        (unsigned long) job->block.section[section].codedlength);
+  }
+  gt_SKtimer_delete(sktimer);
+  GT_SKTRACE_END;
+
+  pthread_mutex_lock(&compressor->mutex);
+  job->numoffinished++;
+  compressor->running[section]--;
+  compressor->memory -= job->memory[section];
+  pthread_cond_broadcast(&compressor->finished);
+  pthread_mutex_unlock(&compressor->mutex);
+}
+
+/**
+ * Submit the sections of the blocks in the window which
+ * are admitted by the share of the threads and the memory
+ * limit, the blocks in their order and the sections of a
+ * block largest first. The mutex must be locked.
+ */
+void fastq_compress_submit(FastqCompressor *compressor) {
+  unsigned long idx, order;
+
+  for (idx = compressor->nextwrite; idx < compressor->nextread; idx++) {
+    FastqCompressJob * job = compressor->window[idx
+        % compressor->windowsize];
+
+    for (order = 0; order < FASTQ_ARCHIVE_NUMOFSECTIONS; order++) {
+      const unsigned long section = compressor->order[order];
+
+      if (job->submitted[section]
+          || compressor->running[section] >= compressor->maxrunning[section]
+          || (compressor->memory > 0 && compressor->memory
+              + job->memory[section] > compressor->memorylimit)) {
+        continue;
+      }
+      job->submitted[section] = true;
+      compressor->running[section]++;
+      compressor->memory += job->memory[section];
+      if (compressor->memory > compressor->peakmemory) {
+        compressor->peakmemory = compressor->memory;
+      }
+      threadpool_submit(compressor->pool, fastq_compress_section,
+          job->task + section);
+    }
+  }
+}
+
+/**
+ * Append the finished blocks at the front of the window
+ * to the archive. If <wait> is true, wait for the next
+ * block to be finished first. The mutex must be locked.
+ */
+void fastq_compress_write(FastqCompressor *compressor, bool wait) {
+
+  while (compressor->nextwrite < compressor->nextread) {
+    FastqCompressJob * job = compressor->window[compressor->nextwrite
+        % compressor->windowsize];
+    unsigned long section;
+
+    if (job->numoffinished < FASTQ_ARCHIVE_NUMOFSECTIONS) {
+      if (!wait) {
+        break;
+      }
+      pthread_cond_wait(&compressor->finished, &compressor->mutex);
+      fastq_compress_submit(compressor);
+      continue;
+    }
+    wait = false;
+
+    /* the order of the blocks is fixed, so the mutex is not needed */
+    pthread_mutex_unlock(&compressor->mutex);
+    GT_SKTRACE_BEGIN("write", job->block.section[FASTQ_ARCHIVE_LENGTHS]
+        .codedlength + job->block.section[FASTQ_ARCHIVE_HEADER].codedlength
+        + job->block.section[FASTQ_ARCHIVE_SEQUENCE].codedlength
+        + job->block.section[FASTQ_ARCHIVE_QUALITY].codedlength);
+    job->block.firstentry = fastq_archive_writer_numofentries(
+        compressor->writer);
+    fastq_archive_writer_add(compressor->writer, &job->block, job->coded);
+    GT_SKTRACE_END;
+    for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+      gt_free(job->coded[section]);
+    }
+    gt_free(job->lengths);
+    gt_free(job->headerlengths);
+    gt_free(job->seqlengths);
+    pthread_mutex_lock(&compressor->mutex);
+
+    compressor->window[compressor->nextwrite % compressor->windowsize] = NULL;
+    compressor->nextwrite++;
+    gt_free(job);
+  }
+}
+
+/**
+ * Cut the entries into blocks of at most <blocksize>
+ * bytes per section and compress their sections in
+ * parallel, at most the window size of blocks are in
+ * flight
+ */
+void fastq_compress(FastqCompressor *compressor, unsigned long blocksize) {
+
+  const unsigned long numofentries = fastq_concat_numofentries(
+      compressor->sq);
+  unsigned long firstentry;
+
+  for (firstentry = 0; firstentry < numofentries; /* Nothing */) {
+    FastqCompressJob * job = gt_malloc(sizeof *job);
+
+    job->firstentry = firstentry;
+    job->numofentries = fastq_compress_blockentries(compressor->sq,
+        firstentry, blocksize);
+    job->compressor = compressor;
+    fastq_compress_prepare(job);
+    firstentry += job->numofentries;
+
+    /* wait for a slot in the window */
+    pthread_mutex_lock(&compressor->mutex);
+    fastq_compress_write(compressor, false);
+    while (compressor->nextread - compressor->nextwrite
+        == compressor->windowsize) {
+      fastq_compress_write(compressor, true);
+    }
+    compressor->window[compressor->nextread % compressor->windowsize] = job;
+    compressor->nextread++;
+    fastq_compress_submit(compressor);
+    pthread_mutex_unlock(&compressor->mutex);
+  }
+
+  pthread_mutex_lock(&compressor->mutex);
+  while (compressor->nextwrite < compressor->nextread) {
+    fastq_compress_write(compressor, true);
+  }
+  pthread_mutex_unlock(&compressor->mutex);
+}
+
+void fastq_compress_usage(const char *progname) {
+  fprintf(stderr, "Usage: %s [-v] [-b <blocksize>[K|M|G]] [-q bwt|rans|cm] "
+      "[-Q illumina8|<lower>:<value>,...] [-P 33|64] [-N] [-T] [-s <samplerate>] "
+      "[-t <threads>] [-m <memory>[K|M|G]] [-V full|sample|none] "
+      "[--stats[=<file>]] [--trace <file>] [-o <outfile>|-a <archive>] "
+      "<file>\n", progname);
+  fprintf(stderr, "-b sets the size of the blocks, whose sections are "
+      "compressed concurrently by -t threads\n");
+  fprintf(stderr, "-m limits the estimated memory of the sections in "
+      "flight\n");
+  fprintf(stderr, "--stats reports the time, throughput and memory of "
+      "each stage as JSON to <file> or stderr\n");
+  fprintf(stderr, "--trace writes a timeline of the stages of each thread "
+      "in the Chrome trace event format to <file>\n");
+  fprintf(stderr, "-V checks the code of each section: sample walks a few "
+      "ranges of the sampled sections (default), full decodes all sections "
+      "and checks the BWT of all sequences, none relies on the checksums "
+      "verified by the decoder\n");
+  fprintf(stderr, "-P sets the ASCII offset of the quality values binned "
+      "by -Q, 33 by default\n");
+  fprintf(stderr, "-N keeps the bases other than ACGT in the sequences "
+      "instead of storing them in a list of exceptions\n");
+  fprintf(stderr, "-T stores the quality values of reads of the same length "
+      "cycle by cycle\n");
+  fprintf(stderr, "-a appends the entries to an existing archive, whose "
+      "blocksize and binning are kept\n");
+}
+
 int main(int argc, char * argv[]) {
 
   unsigned long numofchars = UCHAR_MAX + 1;
 
   size_t sequence_len;
   unsigned char * sequence;
-  Uint * sequence_sa;
+  BwtContext * context = NULL;
+
+  FILE * outfp = stdout;
+  FILE * logfp = NULL;
+  unsigned long blocksize = FASTQ_ARCHIVE_DEFAULTBLOCKSIZE;
+  unsigned long samplerate = FASTQ_ARCHIVE_DEFAULTSAMPLERATE;
+  unsigned long numofthreads = threadpool_numofprocessors();
+  unsigned long memorylimit = FASTQ_COMPRESS_DEFAULTMEMORY, section;
+  FastqCompressVerify verify = FASTQ_COMPRESS_VERIFY_SAMPLE;
+  FILE * statsfp = NULL;
+#ifdef GT_SKTRACE
+  FILE * tracefp = NULL;
+#endif
+  static const struct option options[] = {
+      { "stats", optional_argument, NULL, 'S' },
+      { "trace", required_argument, NULL, 'R' },
+      { NULL, 0, NULL, 0 } };
+  FastqArchiveWriter * writer = NULL;
+  FastqCompressor compressor;
+  Threadpool * pool = NULL;
+  FastqArchiveCodec codecs[FASTQ_ARCHIVE_NUMOFSECTIONS] = {
+      FASTQ_ARCHIVE_CODEC_BWT, FASTQ_ARCHIVE_CODEC_BWT,
+      FASTQ_ARCHIVE_CODEC_BWT, FASTQ_ARCHIVE_CODEC_BWT };
+  GtUchar flags[FASTQ_ARCHIVE_NUMOFSECTIONS] = {
+      0, 0, FASTQ_ARCHIVE_FLAG_EXCEPTIONS, 0 };
+  GtUchar * extra = NULL;
+  unsigned long extralength = 0;
+  const char * binning = NULL;
+  GtUchar qualoffset = 33;
+  bool qualoffsetset = false;
+  const char * archive = NULL;
+  FILE * archivefp = NULL;
+  FastqArchiveReader * reader = NULL;
+  bool blocksizeset = false;
+  int opt;
+
+  while ((opt = getopt_long(argc, argv, "a:b:m:No:P:q:Q:s:t:TvV:", options,
+      NULL)) != -1) {
+    switch (opt) {
+    case 'S':
+      if (optarg != NULL) {
+        fopen_or_exit(statsfp, optarg, "w");
+      } else {
+        statsfp = stderr;
+      }
+      runstats_enable();
+      break;
+    case 'R':
+#ifdef GT_SKTRACE
+      fopen_or_exit(tracefp, optarg, "w");
+      gt_SKtrace_enable();
+#else
+      fprintf(stderr, "Option --trace needs a build with -DGT_SKTRACE\n");
+      exit(EXIT_FAILURE);
+#endif
+      break;
+    case 'a':
+      archive = optarg;
+      break;
+    case 'b':
+      blocksize = fastq_compress_parsesize(optarg, "blocksize",
+          FASTQ_ARCHIVE_MAXBLOCKSIZE);
+      blocksizeset = true;
+      break;
+    case 'm':
+      memorylimit = fastq_compress_parsesize(optarg, "memory limit",
+          ULONG_MAX);
+      break;
+    case 'q':
+      if (!fastq_archive_codec_parse(codecs + FASTQ_ARCHIVE_QUALITY, optarg)) {
+        fprintf(stderr, "Unknown codec %s for the quality values\n", optarg);
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'Q':
+      binning = optarg;
+      break;
+    case 'P':
+      if (strcmp(optarg, "33") == 0 || strcmp(optarg, "64") == 0) {
+        qualoffset = (GtUchar) atoi(optarg);
+        qualoffsetset = true;
+      } else {
+        fprintf(stderr, "Illegal offset %s of the quality values, expected "
+            "33 or 64\n", optarg);
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'N':
+      flags[FASTQ_ARCHIVE_SEQUENCE] &= ~FASTQ_ARCHIVE_FLAG_EXCEPTIONS;
+      break;
+    case 'T':
+      flags[FASTQ_ARCHIVE_QUALITY] |= FASTQ_ARCHIVE_FLAG_TRANSPOSED;
+      break;
+    case 's':
+      {
+        char * end = NULL;
 
-  size_t quality_len;
-  unsigned char * quality;
-  Uint * quality_sa;
+        samplerate = strtoul(optarg, &end, 10);
+        if (end == optarg || *end != '\0') {
+          fprintf(stderr, "Illegal samplerate %s, 0 disables sampling\n",
+              optarg);
+          exit(EXIT_FAILURE);
+        }
+      }
+      break;
+    case 't':
+      {
+        char * end = NULL;
 
-  if (argc != 2) {
-    fprintf(stderr, "Usage: %s <file>\n", argv[0]);
+        numofthreads = strtoul(optarg, &end, 10);
+        if (end == optarg || *end != '\0' || numofthreads == 0) {
+          fprintf(stderr, "Illegal number of threads %s\n", optarg);
+          exit(EXIT_FAILURE);
+        }
+      }
+      break;
+    case 'o':
+      fopen_or_exit(outfp, optarg, "wb");
+      break;
+    case 'v':
+      logfp = stderr;
+      break;
+    case 'V':
+      if (strcmp(optarg, "none") == 0) {
+        verify = FASTQ_COMPRESS_VERIFY_NONE;
+      } else if (strcmp(optarg, "sample") == 0) {
+        verify = FASTQ_COMPRESS_VERIFY_SAMPLE;
+      } else if (strcmp(optarg, "full") == 0) {
+        verify = FASTQ_COMPRESS_VERIFY_FULL;
+      } else {
+        fprintf(stderr, "Unknown verification %s\n", optarg);
+        exit(EXIT_FAILURE);
+      }
+      break;
+    default:
+      fastq_compress_usage(argv[0]);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  if (optind != argc - 1) {
+    fastq_compress_usage(argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  if (archive != NULL && (blocksizeset || binning != NULL
+      || qualoffsetset || outfp != stdout)) {
+    fprintf(stderr, "Option -a can not be combined with -b, -Q, -P or -o\n");
+    exit(EXIT_FAILURE);
+  }
+  if (qualoffsetset && binning == NULL) {
+    fprintf(stderr, "Option -P requires -Q\n");
     exit(EXIT_FAILURE);
   }
 
-  FastqConcat * sq = fastq_concat_new(argv[0], argv[1]);
+  FastqConcat * sq = fastq_concat_new(argv[0], argv[optind]);
 //  fastq_concat_show((const FastqConcat *) sq);
 
   sequence = fastq_concat_seq(sq);
-  sequence_len = strlen((const char *) sequence);
+  sequence_len = fastq_concat_totallength(sq);
+
+  /* check sequence with bwt encode/decode, the suffix array, the bwt
+   and its move-to-front encoding are computed once for all checks */
+  if (verify == FASTQ_COMPRESS_VERIFY_FULL) {
+    RunstatsMark mark;
+
+    context = bwt_context_new((const GtUchar *) sequence, sequence_len,
+        numofchars, NULL);
+    runstats_mark(&mark);
+    bwt_context_check(context);
+    runstats_end(RUNSTATS_VERIFY, &mark, sequence_len);
+    if (logfp != NULL) {
+      bwt_context_show(logfp, context);
+    }
+    bwt_context_delete(context);
+  }
 
-  quality = fastq_concat_qual(sq);
-  quality_len = strlen((const char *) sequence);
+  /* an archive is extended by new blocks, the blocks of the archive are
+   not changed and their suffix arrays are not recomputed */
+  if (archive != NULL) {
+    const GtUchar * serialized = NULL;
+    unsigned long length;
 
-  sequence_sa = gt_sain_sorted_suffixes_new((const GtUchar *) sequence,
-      sequence_len, numofchars);
+    fopen_or_exit(archivefp, archive, "r+b");
+    reader = fastq_archive_reader_new(archivefp);
+    fastq_archive_reader_index(reader);
+    serialized = fastq_archive_reader_extra(reader,
+        FASTQ_ARCHIVE_EXTRA_BINNING, &length);
+    if (serialized != NULL) {
+      QualbinScheme scheme;
 
-  /* check sequence with bwt encode/decode */
-  bwt_check((const Uint *) sequence_sa, (const GtUchar *) sequence,
-      sequence_len, numofchars);
+      if (!qualbin_scheme_deserialize(&scheme, serialized, length)) {
+        fprintf(stderr, "Archive %s is corrupted: invalid binning scheme\n",
+            archive);
+        exit(EXIT_FAILURE);
+      }
+      /* the appended entries are binned with the offset of the archive */
+      if (!qualbin_offset_valid(fastq_concat_qual(sq), sequence_len,
+          scheme.offset)) {
+        fprintf(stderr, "The quality values of %s are not Phred+%u, "
+            "the offset of the archive %s\n", argv[optind],
+            scheme.offset, archive);
+        exit(EXIT_FAILURE);
+      }
+      qualbin_apply(&scheme, fastq_concat_qual(sq), sequence_len);
+      flags[FASTQ_ARCHIVE_QUALITY] |= FASTQ_ARCHIVE_FLAG_BINNED;
+    }
+    writer = fastq_archive_writer_append(reader);
+  }
+
+  /* the lossy binning precedes all stages coding the quality values */
+  if (binning != NULL) {
+    GtUchar * qual = fastq_concat_qual(sq);
+    GtUchar serialized[QUALBIN_SERIALSIZE];
+    QualbinScheme scheme;
+    GtSKtimer * sktimer = gt_SKtimer_new();
 
-  bwt_mtf_check(false, true, sequence_sa, (const GtUchar *) sequence,
-      sequence_len, numofchars);
+    if (!qualbin_scheme_parse(&scheme, binning, qualoffset)) {
+      exit(EXIT_FAILURE);
+    }
+    if (!qualbin_offset_valid(qual, sequence_len, qualoffset)) {
+      fprintf(stderr, "The quality values of %s are not Phred+%u, "
+          "use -P to set the offset\n", argv[optind], qualoffset);
+      exit(EXIT_FAILURE);
+    }
+    gt_SKtimer_start(sktimer);
+    qualbin_apply(&scheme, qual, sequence_len);
+    fastq_compress_showtime(logfp, sktimer, "binning", FASTQ_ARCHIVE_QUALITY,
+        sequence_len);
+    gt_SKtimer_delete(sktimer);
+    extra = fastq_archive_extra_add(extra, &extralength,
+        FASTQ_ARCHIVE_EXTRA_BINNING, serialized,
+        qualbin_scheme_serialize(serialized, &scheme));
+    flags[FASTQ_ARCHIVE_QUALITY] |= FASTQ_ARCHIVE_FLAG_BINNED;
+  }
 
-  quality_sa = gt_sain_sorted_suffixes_new((const GtUchar *) quality,
-      quality_len, numofchars);
+  if (writer == NULL) {
+    writer = fastq_archive_writer_new(outfp, blocksize, extra, extralength);
+  }
+  blocksize = fastq_archive_writer_blocksize(writer);
+  gt_free(extra);
 
-//  /* check quality with bwt encode/decode */
-//  bwt_check((const Uint *) quality_sa, (const GtUchar *) quality, quality_len,
-//      numofchars);
+  pthread_mutex_init(&compressor.mutex, NULL);
+  pthread_cond_init(&compressor.finished, NULL);
+  compressor.windowsize = FASTQ_COMPRESS_JOBSPERTHREAD * numofthreads;
+  compressor.window = gt_calloc((size_t) compressor.windowsize,
+      sizeof *compressor.window);
+  compressor.nextread = compressor.nextwrite = 0;
+  compressor.memory = compressor.peakmemory = 0;
+  compressor.memorylimit = memorylimit;
+  compressor.samplerate = samplerate;
+  compressor.verify = verify;
+  compressor.writer = writer;
+  compressor.logfp = logfp;
+  compressor.sq = sq;
+  compressor.codecs = codecs;
+  compressor.flags = flags;
 
-//  bwt_mtf_check(false, true, quality_sa, (const GtUchar *) quality, quality_len,
-//      numofchars);
+  fastq_compress_shares(&compressor, numofthreads);
 
-  free(quality_sa);
-  free(sequence_sa);
+  pool = threadpool_new(numofthreads);
+  compressor.pool = pool;
+  fastq_compress(&compressor, blocksize);
+  if (logfp != NULL) {
+    fprintf(logfp, "# %lu blocks compressed with %lu threads (share of "
+        "the sections", compressor.nextread, numofthreads);
+    for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+      fprintf(logfp, " %s %lu", fastq_archive_section_name(section),
+          compressor.maxrunning[section]);
+    }
+    fprintf(logfp, "), %lu sections stolen, peak memory of sections in "
+        "flight %lu bytes (limit %lu)\n", threadpool_numofsteals(pool),
+        compressor.peakmemory, compressor.memorylimit);
+  }
+  threadpool_delete(pool);
+
+  pthread_cond_destroy(&compressor.finished);
+  pthread_mutex_destroy(&compressor.mutex);
+  gt_free(compressor.window);
+  fastq_archive_writer_delete(writer);
+  if (archive != NULL) {
+    fastq_archive_reader_delete(reader);
+    fclose(archivefp);
+  }
+
+  if (outfp != stdout) {
+    fclose(outfp);
+  }
 
 //  fastq_concat_show(sq);
   fastq_concat_delete(sq);
 
+  if (statsfp != NULL) {
+    struct stat st;
+
+    runstats_show(statsfp, argv[optind],
+        stat(argv[optind], &st) == 0 ? (unsigned long) st.st_size : 0,
+        numofthreads);
+    if (statsfp != stderr) {
+      fclose(statsfp);
+    }
+  }
+#ifdef GT_SKTRACE
+  if (tracefp != NULL) {
+    gt_SKtrace_dump(tracefp);
+    fclose(tracefp);
+  }
+#endif
+
   exit(EXIT_SUCCESS);
 }
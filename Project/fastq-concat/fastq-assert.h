@@ -42,7 +42,7 @@
   assert_with_message((fastqentry->description != NULL), "Description string should not be empty");\
   assert_with_message((fastqentry->quality != NULL), "Quality string should length are different");\
   assert_with_message((fastqentry->parser != NULL), "Parser object should not be empty");\
-  assert_with_message((strlen(fastqentry->sequence) == strlen(fastqentry->quality)), "Sequence and Quality length are different");
+  assert_with_message((fastqentry->seqlength == fastqentry->quallength), "Sequence and Quality length are different");
 
 /* validate fasq-concatenation object */
 #define validate_fastqconcat(object)\
@@ -6,6 +6,9 @@
 #include <string.h>
 #include "fastq-assert.h"
 #include "fastq-parse/fastq-parse.h"
+#include "../bwt-compress/gt-alloc.h"
+#include "../bwt-compress/sktimer.h"
+#include "../bwt-compress/runstats.h"
 
 /* The following type is used to store the concatenation of
  a set of sequences stored in Fastq-format. Actually,
@@ -17,15 +20,8 @@
  newlines. The concatenation of the header lines contains newlines and
  is \0-terminated. */
 
-#define fastq_concat_string_copy(destination, source)\
-    if (destination == NULL) {\
-      destination = (unsigned char*)strdup(source);\
-    } else {\
-      realloc_or_exit(destination,\
-          sizeof(destination) * (strlen((const char *)destination) + strlen(source)),\
-          "Can not allocate memory for generation space");\
-      strcat((char *)destination, source);\
-    }
+/* the initial capacity of the concatenations, doubled when exhausted */
+#define FASTQ_CONCAT_MINCAPACITY 4096UL
 
 /* Store debug information here */
 typedef struct FastqConcatDebug {
@@ -34,9 +30,13 @@ typedef struct FastqConcatDebug {
   unsigned long * vector_sequence;
 } FastqConcatDebug;
 
-/* Main concat structure */
+/* Main concat structure, the sequences and the quality values have
+ the same length and capacity */
 typedef struct FastqConcat {
   FastqConcatDebug * debug;
+  unsigned long numofentries;
+  unsigned long headerlength, headercapacity;
+  unsigned long seqlength, seqcapacity;
   unsigned char * header;
   unsigned char * sequence;
   unsigned char * quality;
@@ -45,38 +45,28 @@ typedef struct FastqConcat {
 /* Initialize debug object */
 FastqConcatDebug *fastq_concat_debug_new(const unsigned long length) {
 
-  FastqConcatDebug * debug = NULL;
-  realloc_or_exit(debug, sizeof(*debug),
-      "Can not allocation memory for sequence-concatenation debug object");
+  FastqConcatDebug * debug = gt_malloc(sizeof(*debug));
 
   debug->vector_length = length;
-
-  debug->vector_header = NULL;
-  realloc_or_exit(debug->vector_header,
-      sizeof(*debug->vector_header) * debug->vector_length,
-      "Can not allocation memory for sequence-concatenation debug object");
-
-  debug->vector_sequence = NULL;
-  realloc_or_exit(debug->vector_sequence,
-      sizeof(*debug->vector_sequence) * debug->vector_length,
-      "Can not allocation memory for sequence-concatenation debug object");
+  debug->vector_header = gt_malloc(sizeof(*debug->vector_header)
+      * debug->vector_length);
+  debug->vector_sequence = gt_malloc(sizeof(*debug->vector_sequence)
+      * debug->vector_length);
 
   return debug;
 }
 
-/* resize a buffer object */
+/* resize a buffer object, the length is doubled such that the number
+ of copies is logarithmic in the number of entries */
 void fastq_concat_debug_increase(FastqConcatDebug *debug) {
 
-  const unsigned long vector_length = debug->vector_length
-      + (debug->vector_length * 0.2);
+  const unsigned long vector_length = 2 * debug->vector_length;
 
   const unsigned long vector_size = sizeof(*debug->vector_header)
       * vector_length;
 
-  realloc_or_exit(debug->vector_header, vector_size,
-      "Can not allocation memory for sequence-concatenation debug object");
-  realloc_or_exit(debug->vector_sequence, vector_size,
-      "Can not allocation memory for sequence-concatenation debug object");
+  debug->vector_header = gt_realloc(debug->vector_header, vector_size);
+  debug->vector_sequence = gt_realloc(debug->vector_sequence, vector_size);
 
   debug->vector_length = vector_length;
 }
@@ -101,42 +91,119 @@ void fastq_concat_debug_position(FastqConcatDebug *debug, unsigned long index,
   debug->vector_sequence[index] = length_sequence + previous_sequence;
 }
 
+/**
+ * Provide space for <length> more bytes and the \0 in
+ * the concatenation <bytes> of <capacity> bytes, of which
+ * <used> are used. The capacity is doubled and large
+ * concatenations are allocated by gt_malloc_large
+ */
+static unsigned char *fastq_concat_reserve(unsigned char *bytes,
+    unsigned long *capacity, unsigned long used, unsigned long length) {
+
+  unsigned long newcapacity = *capacity > 0 ? *capacity
+      : FASTQ_CONCAT_MINCAPACITY;
+  unsigned char * newbytes;
+
+  if (used + length < *capacity) {
+    return bytes;
+  }
+  while (used + length >= newcapacity) {
+    newcapacity *= 2;
+  }
+  newbytes = gt_malloc_large(newcapacity);
+  if (bytes != NULL) {
+    memcpy(newbytes, bytes, used);
+    gt_free(bytes);
+  }
+  *capacity = newcapacity;
+  return newbytes;
+}
+
+/**
+ * Append the <length> bytes of <source> to the
+ * concatenation <bytes> of which <used> bytes
+ * are used
+ */
+static void fastq_concat_append(unsigned char *bytes, unsigned long used,
+    const char *source, unsigned long length) {
+  memcpy(bytes + used, source, length);
+  bytes[used + length] = '\0';
+}
+
 /* This is the constructor to deliver a sequence concatenation for
  the given <inputfilename>. Additionally, the name of the program
  which calls the function must be supplied. */
 
 FastqConcat *fastq_concat_new(const char *progname, const char *inputfilename) {
 
-  FastqConcat * sq = NULL;
-
-  realloc_or_exit(sq, sizeof(*sq), "Can not allocation memory");
+  FastqConcat * sq = gt_malloc(sizeof(*sq));
 
+  sq->headerlength = sq->headercapacity = 0;
+  sq->seqlength = sq->seqcapacity = 0;
   sq->header = NULL;
   sq->quality = NULL;
   sq->sequence = NULL;
+  sq->numofentries = 0;
   sq->debug = fastq_concat_debug_new(10UL);
 
   FastQentry *fastqentry = fastqentry_new(progname, inputfilename);
 
   unsigned long i = 0;
+  RunstatsMark mark;
 
+  GT_SKTRACE_BEGIN("parse", 0);
+  runstats_mark(&mark);
   while (fastqentry_next(fastqentry)) {
 
     const char * header = fastqentry_headerline(fastqentry);
     const char * sequence = fastqentry_sequenceline(fastqentry);
     const char * quality = fastqentry_qualityline(fastqentry);
+    const unsigned long headerlength = strlen(header),
+        seqlength = fastqentry_linelength(fastqentry);
+
+    /* the third line is not stored, so only + can be restored */
+    if (strcmp(fastqentry_descriptionline(fastqentry), "+") != 0) {
+      fprintf(stderr, "%s: line %lu of %s is not \"+\", the third line of "
+          "an entry can not be stored\n", progname,
+          fastqentry_linenum(fastqentry) + 2, inputfilename);
+      exit(EXIT_FAILURE);
+    }
+
+    runstats_end(RUNSTATS_PARSE, &mark, headerlength + 2 * seqlength);
+    runstats_mark(&mark);
 
-    fastq_concat_string_copy(sq->header, header);
-    fastq_concat_string_copy(sq->sequence, sequence);
-    fastq_concat_string_copy(sq->quality, quality);
+    sq->header = fastq_concat_reserve(sq->header, &sq->headercapacity,
+        sq->headerlength, headerlength);
+    fastq_concat_append(sq->header, sq->headerlength, header, headerlength);
+    sq->headerlength += headerlength;
+    if (seqlength >= sq->seqcapacity - sq->seqlength) {
+      unsigned long capacity = sq->seqcapacity;
 
-    fastq_concat_debug_position(sq->debug, i++, strlen(header),
-        strlen(sequence));
+      sq->sequence = fastq_concat_reserve(sq->sequence, &sq->seqcapacity,
+          sq->seqlength, seqlength);
+      sq->quality = fastq_concat_reserve(sq->quality, &capacity,
+          sq->seqlength, seqlength);
+    }
+    fastq_concat_append(sq->sequence, sq->seqlength, sequence, seqlength);
+    fastq_concat_append(sq->quality, sq->seqlength, quality, seqlength);
+    sq->seqlength += seqlength;
+
+    fastq_concat_debug_position(sq->debug, i++, headerlength, seqlength);
 
     fastqentry_clear(fastqentry);
+    runstats_end(RUNSTATS_CONCAT, &mark, headerlength + 2 * seqlength);
+    runstats_mark(&mark);
   }
 
+  if (runstats_enabled()) {
+    GtArenaStats stats;
+
+    fastqentry_arenastats(fastqentry, &stats);
+    runstats_arena(&stats);
+  }
   fastqentry_delete(fastqentry);
+  sq->numofentries = i;
+  GT_SKTRACE_END;
 
   return sq;
 }
@@ -146,14 +213,14 @@ FastqConcat *fastq_concat_new(const char *progname, const char *inputfilename) {
 void fastq_concat_delete(FastqConcat *sq) {
   if (sq) {
     if (sq->debug) {
-      free(sq->debug->vector_header);
-      free(sq->debug->vector_sequence);
-      free(sq->debug);
+      gt_free(sq->debug->vector_header);
+      gt_free(sq->debug->vector_sequence);
+      gt_free(sq->debug);
     }
-    free(sq->header);
-    free(sq->quality);
-    free(sq->sequence);
-    free(sq);
+    gt_free(sq->header);
+    gt_free(sq->quality);
+    gt_free(sq->sequence);
+    gt_free(sq);
   }
 }
 
@@ -162,7 +229,43 @@ void fastq_concat_delete(FastqConcat *sq) {
 
 unsigned long fastq_concat_totallength(const FastqConcat *sq) {
   validate_fastqconcat(sq);
-  return strlen((const char *) sq->sequence);
+  return sq->seqlength;
+}
+
+/* Deliver the number of entries in the concatenation. */
+
+unsigned long fastq_concat_numofentries(const FastqConcat *sq) {
+  validate_fastqconcat(sq);
+  return sq->numofentries;
+}
+
+/* Deliver the length of the header line and the length of the sequence
+ of the entry with index <idx>. */
+
+void fastq_concat_entrylengths(const FastqConcat *sq, unsigned long idx,
+    unsigned long *headerlength, unsigned long *seqlength) {
+  validate_fastqconcat(sq);
+  assert(idx < sq->numofentries);
+
+  *headerlength = sq->debug->vector_header[idx];
+  *seqlength = sq->debug->vector_sequence[idx];
+  if (idx > 0) {
+    *headerlength -= sq->debug->vector_header[idx - 1];
+    *seqlength -= sq->debug->vector_sequence[idx - 1];
+  }
+}
+
+/* Deliver the offset of the header line and the offset of the sequence
+ of the entry with index <idx> in the corresponding concatenation. The
+ offset of the sequence is also the offset of the quality values. */
+
+void fastq_concat_entryoffsets(const FastqConcat *sq, unsigned long idx,
+    unsigned long *headeroffset, unsigned long *seqoffset) {
+  validate_fastqconcat(sq);
+  assert(idx <= sq->numofentries);
+
+  *headeroffset = (idx > 0) ? sq->debug->vector_header[idx - 1] : 0;
+  *seqoffset = (idx > 0) ? sq->debug->vector_sequence[idx - 1] : 0;
 }
 
 /* Deliver the concatenation of the nucleotide sequences. The user can modify
@@ -9,7 +9,8 @@
    - the concatenation of the header lines.
    The first two concatenations are of the same length and does not include
    newlines. The concatenation of the header lines contains newlines and
-   is \0-terminated. */
+   is \0-terminated. The third line of each entry is not stored, so
+   it must consist of a single +. */
 
 typedef struct FastqConcat FastqConcat;
 
@@ -29,6 +30,27 @@ void fastq_concat_delete(FastqConcat *sq);
 
 unsigned long fastq_concat_totallength(const FastqConcat *sq);
 
+/* Deliver the number of entries in the concatenation. */
+
+unsigned long fastq_concat_numofentries(const FastqConcat *sq);
+
+/* Deliver the length of the header line and the length of the sequence
+   of the entry with index <idx>. */
+
+void fastq_concat_entrylengths(const FastqConcat *sq,unsigned long idx,
+                               unsigned long *headerlength,
+                               unsigned long *seqlength);
+
+/* Deliver the offset of the header line and the offset of the sequence
+   of the entry with index <idx> in the corresponding concatenation. The
+   offset of the sequence is also the offset of the quality values. For
+   <idx> equal to the number of entries, the total lengths are
+   delivered. */
+
+void fastq_concat_entryoffsets(const FastqConcat *sq,unsigned long idx,
+                               unsigned long *headeroffset,
+                               unsigned long *seqoffset);
+
 /* Deliver the concatenation of the nucleotide sequences. The user can modify
    the content of the sequence but is not responsible to free its memory. */
 
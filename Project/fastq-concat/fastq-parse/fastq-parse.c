@@ -5,42 +5,37 @@
 #include <assert.h>
 #include <string.h>
 #include "../fastq-assert.h"
+#include "../../bwt-compress/gt-alloc.h"
+#include "../../bwt-compress/gt-arena.h"
 
-/**
- * Duplicate string, or just a copy string
- * resize if string size not equals
- */
-#define string_copy(destination, source)\
-    if (destination == NULL) {\
-      destination = strdup(source);\
-    } else {\
-      if (strlen(source) > strlen(destination)) {\
-        realloc_or_exit(destination,\
-            sizeof(destination) * strlen(source),\
-            "Can not allocate memory for generation space");\
-        strcpy(destination, source);\
-      }\
-    }\
+/* the number of bytes read from the file at once */
+#define FASTQ_PARSE_BLOCKSIZE (64UL << 10)
 
 /**
  * Class to represent line parser properties
- * like max length, current line, file
- * and current read buffer other
+ * like the current line, file and the block
+ * of the file read last, of which the bytes
+ * from start to end are not parsed yet
  */
 typedef struct FastQentryLineParser {
   unsigned long line;
-  unsigned long length;
+  unsigned long start;
+  unsigned long end;
   FILE * file;
   char * buffer;
 } FastQentryLineParser;
 
-/* class to represent a single <FastQentry> */
+/* class to represent a single <FastQentry>, the lines are
+ stored in its own arena, which is reset for each entry */
 typedef struct FastQentry {
   unsigned long line;
+  unsigned long seqlength;
+  unsigned long quallength;
   char * header;
   char * sequence;
   char * description;
   char * quality;
+  GtArena * arena;
   FastQentryLineParser * parser;
 } FastQentry;
 
@@ -48,87 +43,98 @@ typedef struct FastQentry {
  error message, the name of the program must be provided as first argument */
 FastQentry *fastqentry_new(__attribute__((unused))const char *progname, const char *filename) {
 
-  FastQentry * fastqentry = NULL;
-
-  realloc_or_exit(fastqentry, sizeof(*fastqentry),
-      "Can not allocate memory for generation space");
+  FastQentry * fastqentry = gt_malloc(sizeof(*fastqentry));
 
   fastqentry->line = 0UL;
+  fastqentry->seqlength = fastqentry->quallength = 0UL;
   fastqentry->header = NULL;
   fastqentry->quality = NULL;
   fastqentry->sequence = NULL;
   fastqentry->description = NULL;
+  fastqentry->arena = gt_arena_new(FASTQ_PARSE_BLOCKSIZE);
 
-  fastqentry->parser = NULL;
-  realloc_or_exit(fastqentry->parser, sizeof(*fastqentry->parser),
-      "Can not allocate memory for generation space");
+  fastqentry->parser = gt_malloc(sizeof(*fastqentry->parser));
 
   fastqentry->parser->file = NULL;
   fopen_or_exit(fastqentry->parser->file, filename, "r");
 
-  fastqentry->parser->buffer = NULL;
-  fastqentry->parser->length = 50UL;
+  fastqentry->parser->buffer = gt_malloc(FASTQ_PARSE_BLOCKSIZE);
+  fastqentry->parser->start = fastqentry->parser->end = 0;
   fastqentry->parser->line = fastqentry->line;
 
   return fastqentry;
 }
 
 /**
- * Custom line parser,
- * return a line without \n or a NULL
- * use a dynamic buffer size
+ * Custom line parser, return a line without \n
+ * stored in the <arena> or NULL at the end of
+ * the file. The length is stored in <length>
  */
-char * fastqentry_parse_line(FastQentryLineParser *fastqentryparser) {
+char * fastqentry_parse_line(FastQentryLineParser *fastqentryparser,
+    GtArena *arena, unsigned long *length) {
 
-  char character;
+  char * line = NULL;
   unsigned long i = 0;
 
-  if (fastqentryparser->buffer == NULL) {
-    realloc_or_exit(fastqentryparser->buffer,
-        sizeof(fastqentryparser->buffer) * fastqentryparser->length,
-        "Can not allocate memory for generation space");
-  }
-
-  while ((character = fgetc(fastqentryparser->file)) != EOF) {
-
-    if (fastqentryparser->length <= i) {
-      fastqentryparser->length *= 2;
-
-      realloc_or_exit(fastqentryparser->buffer,
-          sizeof(fastqentryparser->buffer) * fastqentryparser->length,
-          "Can not allocate memory for generation space");
+  while (true) {
+    const char * start, * newline;
+    unsigned long part;
+
+    if (fastqentryparser->start == fastqentryparser->end) {
+      fastqentryparser->start = 0;
+      fastqentryparser->end = fread(fastqentryparser->buffer, 1,
+          FASTQ_PARSE_BLOCKSIZE, fastqentryparser->file);
+      /* a last line without \n is a line, too */
+      if (fastqentryparser->end == 0) {
+        if (line == NULL) {
+          return NULL;
+        }
+        fastqentryparser->line++;
+        break;
+      }
     }
-
-    if (character == '\n') {
+    start = fastqentryparser->buffer + fastqentryparser->start;
+    newline = memchr(start, '\n',
+        fastqentryparser->end - fastqentryparser->start);
+    part = newline != NULL ? (unsigned long) (newline - start)
+        : fastqentryparser->end - fastqentryparser->start;
+
+    /* a line continued in the next block extends the same memory */
+    line = gt_arena_extend(arena, line, i, i + part + 1);
+    memcpy(line + i, start, part);
+    i += part;
+    fastqentryparser->start += part;
+    if (newline != NULL) {
+      fastqentryparser->start++;
       fastqentryparser->line++;
-      fastqentryparser->buffer[i] = '\0';
-      return fastqentryparser->buffer;
+      break;
     }
-
-    fastqentryparser->buffer[i++] = character;
   }
-
-  return NULL;
+  line[i] = '\0';
+  *length = i;
+  return line;
 }
 
 /* Ask for next <FastQentry>. Returns <false>, if there is no more
  <FastQentry>. Return <true> if there is one which is referred to
- by <fastqentry>. */
+ by <fastqentry>. The lines of the previous <FastQentry> are released. */
 bool fastqentry_next(FastQentry *fastqentry) {
 
-  char * buffer;
+  FastQentryLineParser * parser = fastqentry->parser;
+  unsigned long length;
 
-  if ((buffer = fastqentry_parse_line(fastqentry->parser))) {
-    string_copy(fastqentry->header, buffer);
-    fastqentry->line = fastqentry->parser->line;
-    if ((buffer = fastqentry_parse_line(fastqentry->parser))) {
-      string_copy(fastqentry->sequence, buffer);
-      /* ignore this line 3 with + something unknown*/
-      if ((buffer = fastqentry_parse_line(fastqentry->parser))) {
-        string_copy(fastqentry->description, buffer);
+  gt_arena_reset(fastqentry->arena);
+  if ((fastqentry->header = fastqentry_parse_line(parser, fastqentry->arena,
+      &length))) {
+    fastqentry->line = parser->line;
+    if ((fastqentry->sequence = fastqentry_parse_line(parser,
+        fastqentry->arena, &fastqentry->seqlength))) {
+      /* line 3 with + something unknown*/
+      if ((fastqentry->description = fastqentry_parse_line(parser,
+          fastqentry->arena, &length))) {
         /* line 4 is a quality string*/
-        if ((buffer = fastqentry_parse_line(fastqentry->parser))) {
-          string_copy(fastqentry->quality, buffer);
+        if ((fastqentry->quality = fastqentry_parse_line(parser,
+            fastqentry->arena, &fastqentry->quallength))) {
 
           validate_fastqentry(fastqentry);
           return true;
@@ -136,20 +142,19 @@ bool fastqentry_next(FastQentry *fastqentry) {
       }
     }
   }
+  fastqentry->header = fastqentry->sequence = NULL;
+  fastqentry->description = fastqentry->quality = NULL;
   return false;
 }
 
-/* TODO: clear strings without free function, */
-/* clear the contents of a <FastQentry>. */
+/* clear the contents of a <FastQentry>. The lines are released
+ without calls of free. */
 void fastqentry_clear(FastQentry *fastqentry) {
   validate_fastqentry(fastqentry);
-  free(fastqentry->header);
+  gt_arena_reset(fastqentry->arena);
   fastqentry->header = NULL;
-  free(fastqentry->quality);
   fastqentry->quality = NULL;
-  free(fastqentry->sequence);
   fastqentry->sequence = NULL;
-  free(fastqentry->description);
   fastqentry->description = NULL;
 }
 
@@ -158,17 +163,21 @@ void fastqentry_delete(FastQentry *fastqentry) {
   if (fastqentry) {
     if (fastqentry->parser) {
       fclose(fastqentry->parser->file);
-      free(fastqentry->parser->buffer);
+      gt_free(fastqentry->parser->buffer);
     }
-    free(fastqentry->parser);
-    free(fastqentry->header);
-    free(fastqentry->quality);
-    free(fastqentry->sequence);
-    free(fastqentry->description);
-    free(fastqentry);
+    gt_arena_delete(fastqentry->arena);
+    gt_free(fastqentry->parser);
+    gt_free(fastqentry);
   }
 }
 
+/* store the counters of the arena holding the lines of the
+ <FastQentry>-object in <stats>. */
+void fastqentry_arenastats(const FastQentry *fastqentry,
+    GtArenaStats *stats) {
+  gt_arena_stats(fastqentry->arena, stats);
+}
+
 /* show <FastQentry>-object. This is used mainly for testing. */
 void fastqentry_show(const FastQentry *fastqentry) {
   validate_fastqentry(fastqentry);
@@ -194,11 +203,17 @@ const char *fastqentry_qualityline(const FastQentry *fastqentry) {
   return fastqentry->quality;
 }
 
+/* return the third line, starting with +, from given <FastQentry>-object.*/
+const char *fastqentry_descriptionline(const FastQentry *fastqentry) {
+  validate_fastqentry(fastqentry);
+  return fastqentry->description;
+}
+
 /* deliver length of line of sequenceline and qualityline of
  <FastQentry>-object.*/
 unsigned long fastqentry_linelength(const FastQentry *fastqentry) {
   validate_fastqentry(fastqentry);
-  return strlen(fastqentry->sequence);
+  return fastqentry->seqlength;
 }
 
 /* deliver the line number of the input file at which the current
@@ -1,6 +1,7 @@
 #ifndef FASTQ_PARSE_H
 #define FASTQ_PARSE_H
 #include <stdbool.h>
+#include "../../bwt-compress/gt-arena.h"
 
 /* class to represent a single <FastQentry> */
 
@@ -21,6 +22,11 @@ void fastqentry_clear(FastQentry *fastqentry);
 /* delete <FastQentry>-object. */
 void fastqentry_delete(FastQentry *fastqentry);
 
+/* store the counters of the arena holding the lines of the
+   <FastQentry>-object in <stats>. */
+void fastqentry_arenastats(const FastQentry *fastqentry,
+                           GtArenaStats *stats);
+
 /* show <FastQentry>-object. This is used mainly for testing. */
 void fastqentry_show(const FastQentry *fastqentry);
 
@@ -38,6 +44,9 @@ const char *fastqentry_sequenceline(const FastQentry *fastqentry);
 /* return quality value line from given <FastQentry>-object.*/
 const char *fastqentry_qualityline(const FastQentry *fastqentry);
 
+/* return the third line, starting with +, from given <FastQentry>-object.*/
+const char *fastqentry_descriptionline(const FastQentry *fastqentry);
+
 /* deliver length of line of sequenceline and qualityline of
    <FastQentry>-object.*/
 unsigned long fastqentry_linelength(const FastQentry *fastqentry);
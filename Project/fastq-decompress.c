@@ -0,0 +1,498 @@
+/*
+ ============================================================================
+ Name        : fastq-decompress.c
+ Description : Decode an archive written by fastq-compress
+ ============================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "bwt-compress/gt-alloc.h"
+#include "bwt-compress/sktimer.h"
+#include "fastq-concat/fastq-assert.h"
+#include "fastq-archive/fastq-archive.h"
+#include "fastq-archive/qualbin.h"
+#include "fastq-archive/threadpool.h"
+
+#define FASTQ_DECOMPRESS_DEFAULTMEMORY (1UL << 30)
+#define FASTQ_DECOMPRESS_JOBSPERTHREAD 4UL
+
+/* The decoding of a single block */
+typedef struct {
+  FastqArchiveBlock block;
+  GtUchar * coded[FASTQ_ARCHIVE_NUMOFSECTIONS];
+  GtUchar * text;
+  unsigned long textlength, memory;
+  bool finished;
+  struct FastqDecompressor * decompressor;
+} FastqDecompressJob;
+
+/* The blocks are decoded by the threads of the pool. The decoded blocks
+ are written in their original order: a block which is finished before
+ its predecessors waits in the window of blocks in flight. A block is
+ only read if the estimated memory of all blocks in flight stays below
+ the limit and the window is not full. */
+typedef struct FastqDecompressor {
+  pthread_mutex_t mutex;
+  pthread_cond_t finished;
+  FastqDecompressJob ** window;
+  unsigned long windowsize, nextread, nextwrite, memory, memorylimit,
+      peakmemory;
+  FILE * outfp;
+} FastqDecompressor;
+
+/**
+ * Parse a size with an optional
+ * suffix K, M or G
+ */
+static unsigned long fastq_decompress_parsesize(const char *arg) {
+  char * end = NULL;
+  unsigned long size = strtoul(arg, &end, 10);
+
+  switch (*end) {
+  case 'G':
+    size <<= 10;
+    /* fall through */
+  case 'M':
+    size <<= 10;
+    /* fall through */
+  case 'K':
+    size <<= 10;
+    end++;
+    break;
+  }
+  if (end == arg || *end != '\0' || size == 0) {
+    fprintf(stderr, "Illegal size %s\n", arg);
+    exit(EXIT_FAILURE);
+  }
+  return size;
+}
+
+/**
+ * Format the <numofentries> entries whose header lines,
+ * sequences and quality values are stored one after the
+ * other in <raw> in Fastq format. Returns the text and
+ * stores its length in <textlength>
+ */
+static GtUchar *fastq_decompress_format(unsigned long *textlength,
+    GtUchar * const *raw, const unsigned long *rawlength,
+    const unsigned long *headerlengths, const unsigned long *seqlengths,
+    unsigned long numofentries) {
+
+  unsigned long idx, headerpos = 0, seqpos = 0;
+  GtUchar * text = NULL, * ptr;
+
+  /* each entry consists of 4 lines, the third is only a '+' */
+  if (rawlength[FASTQ_ARCHIVE_SEQUENCE] != rawlength[FASTQ_ARCHIVE_QUALITY]) {
+    fprintf(stderr, "Archive is corrupted: sequences and quality values "
+        "differ in length\n");
+    exit(EXIT_FAILURE);
+  }
+  *textlength = rawlength[FASTQ_ARCHIVE_HEADER]
+      + 2 * rawlength[FASTQ_ARCHIVE_SEQUENCE] + 5 * numofentries;
+  text = ptr = gt_malloc((size_t) *textlength + 1);
+  for (idx = 0; idx < numofentries; idx++) {
+    if (headerpos + headerlengths[idx] > rawlength[FASTQ_ARCHIVE_HEADER]
+        || seqpos + seqlengths[idx] > rawlength[FASTQ_ARCHIVE_SEQUENCE]) {
+      fprintf(stderr, "Archive is corrupted: lengths exceed the sections\n");
+      exit(EXIT_FAILURE);
+    }
+    memcpy(ptr, raw[FASTQ_ARCHIVE_HEADER] + headerpos, headerlengths[idx]);
+    ptr += headerlengths[idx];
+    *ptr++ = '\n';
+    memcpy(ptr, raw[FASTQ_ARCHIVE_SEQUENCE] + seqpos, seqlengths[idx]);
+    ptr += seqlengths[idx];
+    memcpy(ptr, "\n+\n", 3);
+    ptr += 3;
+    memcpy(ptr, raw[FASTQ_ARCHIVE_QUALITY] + seqpos, seqlengths[idx]);
+    ptr += seqlengths[idx];
+    *ptr++ = '\n';
+    headerpos += headerlengths[idx];
+    seqpos += seqlengths[idx];
+  }
+  assert(ptr == text + *textlength);
+  return text;
+}
+
+/**
+ * Decode the lengths section of a block with
+ * <numofentries> entries into <headerlengths>
+ * and <seqlengths>
+ */
+static void fastq_decompress_lengths(unsigned long *headerlengths,
+    unsigned long *seqlengths, const FastqArchiveBlock *block,
+    const GtUchar *coded) {
+
+  GtUchar * raw = fastq_archive_section_decode(
+      block->section + FASTQ_ARCHIVE_LENGTHS, coded, NULL, 0);
+
+  if (!fastq_archive_lengths_parse(headerlengths, seqlengths,
+      block->numofentries, raw,
+      block->section[FASTQ_ARCHIVE_LENGTHS].rawlength)) {
+    fprintf(stderr, "Archive is corrupted: invalid lengths in block with "
+        "first entry %lu\n", (unsigned long) block->firstentry);
+    exit(EXIT_FAILURE);
+  }
+  gt_free(raw);
+}
+
+/**
+ * Decode the sections of a block and format the
+ * entries in Fastq format, executed by the
+ * threads of the pool
+ */
+static void fastq_decompress_block(void *data) {
+  FastqDecompressJob * job = data;
+  FastqDecompressor * decompressor = job->decompressor;
+  const unsigned long numofentries = job->block.numofentries;
+  GtUchar * raw[FASTQ_ARCHIVE_NUMOFSECTIONS] = { NULL };
+  unsigned long rawlength[FASTQ_ARCHIVE_NUMOFSECTIONS];
+  unsigned long * headerlengths = gt_malloc(
+      (size_t) (numofentries + 1) * sizeof *headerlengths);
+  unsigned long * seqlengths = gt_malloc(
+      (size_t) (numofentries + 1) * sizeof *seqlengths);
+  unsigned long section;
+
+  /* the lengths are required by the other sections */
+  fastq_decompress_lengths(headerlengths, seqlengths, &job->block,
+      job->coded[FASTQ_ARCHIVE_LENGTHS]);
+  for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+    if (section != FASTQ_ARCHIVE_LENGTHS) {
+      raw[section] = fastq_archive_section_decode(job->block.section + section,
+          job->coded[section], section == FASTQ_ARCHIVE_HEADER
+              ? headerlengths : seqlengths, numofentries);
+    }
+    rawlength[section] = job->block.section[section].rawlength;
+    gt_free(job->coded[section]);
+    job->coded[section] = NULL;
+  }
+
+  job->text = fastq_decompress_format(&job->textlength, raw, rawlength,
+      headerlengths, seqlengths, numofentries);
+
+  for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+    gt_free(raw[section]);
+  }
+  gt_free(headerlengths);
+  gt_free(seqlengths);
+
+  pthread_mutex_lock(&decompressor->mutex);
+  job->finished = true;
+  pthread_cond_broadcast(&decompressor->finished);
+  pthread_mutex_unlock(&decompressor->mutex);
+}
+
+/**
+ * Write the finished blocks at the front of the window.
+ * If <wait> is true, wait for the next block to be
+ * finished first. The mutex must be locked.
+ */
+static void fastq_decompress_write(FastqDecompressor *decompressor,
+    bool wait) {
+
+  while (decompressor->nextwrite < decompressor->nextread) {
+    FastqDecompressJob * job = decompressor->window[decompressor->nextwrite
+        % decompressor->windowsize];
+
+    if (!job->finished) {
+      if (!wait) {
+        break;
+      }
+      pthread_cond_wait(&decompressor->finished, &decompressor->mutex);
+      continue;
+    }
+    wait = false;
+
+    /* the order of the output is fixed, so the mutex is not needed */
+    pthread_mutex_unlock(&decompressor->mutex);
+    if (fwrite(job->text, 1, (size_t) job->textlength, decompressor->outfp)
+        != job->textlength) {
+      fprintf(stderr, "Can not write the decoded entries\n");
+      exit(EXIT_FAILURE);
+    }
+    gt_free(job->text);
+    pthread_mutex_lock(&decompressor->mutex);
+
+    decompressor->memory -= job->memory;
+    decompressor->window[decompressor->nextwrite % decompressor->windowsize] =
+        NULL;
+    decompressor->nextwrite++;
+    gt_free(job);
+  }
+}
+
+/**
+ * Read the blocks of the archive in order and decode
+ * them in parallel, the memory is bounded by the
+ * memory limit of the <decompressor> unless a single
+ * block exceeds it
+ */
+static void fastq_decompress(FastqDecompressor *decompressor,
+    FastqArchiveReader *reader, Threadpool *pool) {
+
+  while (true) {
+    FastqDecompressJob * job = gt_malloc(sizeof *job);
+
+    if (!fastq_archive_reader_next(reader, &job->block, job->coded)) {
+      gt_free(job);
+      break;
+    }
+    job->text = NULL;
+    job->textlength = 0;
+    job->finished = false;
+    job->decompressor = decompressor;
+    job->memory = fastq_archive_block_memory(&job->block)
+        + job->block.section[FASTQ_ARCHIVE_HEADER].rawlength
+        + 2 * job->block.section[FASTQ_ARCHIVE_SEQUENCE].rawlength
+        + 5 * job->block.numofentries;
+
+    /* wait for a slot in the window and enough memory */
+    pthread_mutex_lock(&decompressor->mutex);
+    fastq_decompress_write(decompressor, false);
+    while (decompressor->nextread - decompressor->nextwrite
+        == decompressor->windowsize
+        || (decompressor->nextread > decompressor->nextwrite
+            && decompressor->memory + job->memory
+                > decompressor->memorylimit)) {
+      fastq_decompress_write(decompressor, true);
+    }
+    decompressor->window[decompressor->nextread % decompressor->windowsize] =
+        job;
+    decompressor->nextread++;
+    decompressor->memory += job->memory;
+    if (decompressor->memory > decompressor->peakmemory) {
+      decompressor->peakmemory = decompressor->memory;
+    }
+    pthread_mutex_unlock(&decompressor->mutex);
+
+    threadpool_submit(pool, fastq_decompress_block, job);
+  }
+
+  pthread_mutex_lock(&decompressor->mutex);
+  while (decompressor->nextwrite < decompressor->nextread) {
+    fastq_decompress_write(decompressor, true);
+  }
+  pthread_mutex_unlock(&decompressor->mutex);
+}
+
+/**
+ * Write the entries <firstentry> to <endentry>-1 of the
+ * archive read by <reader> to <outfp>. Only the blocks
+ * containing the entries are read and the sampled sections
+ * are decoded only around the entries. This requires that
+ * the archive can be seeked
+ */
+static void fastq_decompress_extract(FILE *outfp, FastqArchiveReader *reader,
+    unsigned long firstentry, unsigned long endentry) {
+
+  const unsigned long numofblocks = fastq_archive_reader_index(reader);
+  unsigned long blocknum;
+
+  if (endentry > fastq_archive_reader_numofentries(reader)) {
+    fprintf(stderr, "Illegal range %lu-%lu of entries, the archive stores "
+        "%lu entries\n", firstentry + 1, endentry,
+        fastq_archive_reader_numofentries(reader));
+    exit(EXIT_FAILURE);
+  }
+  for (blocknum = fastq_archive_reader_findblock(reader, firstentry);
+      blocknum < numofblocks; blocknum++) {
+    const FastqArchiveBlock *block = fastq_archive_reader_block(reader,
+        blocknum);
+    GtUchar * raw[FASTQ_ARCHIVE_NUMOFSECTIONS] = { NULL };
+    unsigned long rawlength[FASTQ_ARCHIVE_NUMOFSECTIONS] = { 0 };
+    unsigned long * headerlengths = NULL, * seqlengths = NULL;
+    unsigned long section, from, to, textlength;
+    GtUchar * coded = NULL, * text = NULL;
+
+    if (block->firstentry >= endentry) {
+      break;
+    }
+    headerlengths = gt_malloc(
+        (size_t) (block->numofentries + 1) * sizeof *headerlengths);
+    seqlengths = gt_malloc(
+        (size_t) (block->numofentries + 1) * sizeof *seqlengths);
+    coded = fastq_archive_reader_section(reader, blocknum,
+        FASTQ_ARCHIVE_LENGTHS);
+    fastq_decompress_lengths(headerlengths, seqlengths, block, coded);
+    gt_free(coded);
+
+    /* the entries of the range in this block */
+    from = firstentry > block->firstentry ? firstentry - block->firstentry
+        : 0;
+    to = endentry - block->firstentry < block->numofentries
+        ? endentry - block->firstentry : block->numofentries;
+    for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+      if (section != FASTQ_ARCHIVE_LENGTHS) {
+        coded = fastq_archive_reader_section(reader, blocknum, section);
+        raw[section] = fastq_archive_section_extract(rawlength + section,
+            block->section + section, coded, section == FASTQ_ARCHIVE_HEADER
+                ? headerlengths : seqlengths, block->numofentries, from,
+            to - from);
+        gt_free(coded);
+      }
+    }
+
+    text = fastq_decompress_format(&textlength, raw, rawlength,
+        headerlengths + from, seqlengths + from, to - from);
+    if (fwrite(text, 1, (size_t) textlength, outfp) != textlength) {
+      fprintf(stderr, "Can not write the decoded entries\n");
+      exit(EXIT_FAILURE);
+    }
+    gt_free(text);
+    for (section = 0; section < FASTQ_ARCHIVE_NUMOFSECTIONS; section++) {
+      gt_free(raw[section]);
+    }
+    gt_free(headerlengths);
+    gt_free(seqlengths);
+  }
+}
+
+static void fastq_decompress_usage(const char *progname) {
+  fprintf(stderr, "Usage: %s [-v] [-t <threads>] [-m <memory>[K|M|G]] "
+      "[-r <first>[-<last>]] [-o <outfile>] [<archive>|-]\n", progname);
+  fprintf(stderr, "-r extracts the entries <first> to <last> (counted from "
+      "1) of a seekable archive\n");
+}
+
+int main(int argc, char * argv[]) {
+
+  FILE * infp = stdin;
+  FILE * logfp = NULL;
+  FastqDecompressor decompressor;
+  FastqArchiveReader * reader = NULL;
+  Threadpool * pool = NULL;
+  unsigned long numofthreads = threadpool_numofprocessors(), length;
+  unsigned long firstentry = 0, endentry = 0;
+  bool extract = false;
+  const GtUchar * binning = NULL;
+  int opt;
+
+  decompressor.outfp = stdout;
+  decompressor.memorylimit = FASTQ_DECOMPRESS_DEFAULTMEMORY;
+  while ((opt = getopt(argc, argv, "m:o:r:t:v")) != -1) {
+    switch (opt) {
+    case 'm':
+      decompressor.memorylimit = fastq_decompress_parsesize(optarg);
+      break;
+    case 'o':
+      fopen_or_exit(decompressor.outfp, optarg, "wb");
+      break;
+    case 'r':
+      {
+        char * end = NULL;
+
+        firstentry = strtoul(optarg, &end, 10);
+        endentry = firstentry;
+        if (end != optarg && *end == '-') {
+          const char * last = end + 1;
+
+          endentry = strtoul(last, &end, 10);
+          if (end == last) {
+            end = (char *) optarg;
+          }
+        }
+        if (end == optarg || *end != '\0' || firstentry == 0
+            || endentry < firstentry) {
+          fprintf(stderr, "Illegal range %s of entries\n", optarg);
+          exit(EXIT_FAILURE);
+        }
+        firstentry--;
+        extract = true;
+      }
+      break;
+    case 't':
+      {
+        char * end = NULL;
+
+        numofthreads = strtoul(optarg, &end, 10);
+        if (end == optarg || *end != '\0' || numofthreads == 0) {
+          fprintf(stderr, "Illegal number of threads %s\n", optarg);
+          exit(EXIT_FAILURE);
+        }
+      }
+      break;
+    case 'v':
+      logfp = stderr;
+      break;
+    default:
+      fastq_decompress_usage(argv[0]);
+      exit(EXIT_FAILURE);
+    }
+  }
+  if (optind + 1 < argc) {
+    fastq_decompress_usage(argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  if (optind < argc && strcmp(argv[optind], "-") != 0) {
+    fopen_or_exit(infp, argv[optind], "rb");
+  }
+
+  reader = fastq_archive_reader_new(infp);
+  /* the index of a seekable archive excludes an interrupted append */
+  if (!extract && fseek(infp, 0L, SEEK_CUR) == 0) {
+    fastq_archive_reader_index(reader);
+  }
+  binning = fastq_archive_reader_extra(reader, FASTQ_ARCHIVE_EXTRA_BINNING,
+      &length);
+  if (logfp != NULL && binning != NULL) {
+    QualbinScheme scheme;
+
+    if (qualbin_scheme_deserialize(&scheme, binning, length)) {
+      fprintf(logfp, "# quality values are binned with scheme ");
+      qualbin_scheme_show(logfp, &scheme);
+      fprintf(logfp, "\n");
+    }
+  }
+
+  if (extract) {
+    GtSKtimer * sktimer = gt_SKtimer_new();
+
+    gt_SKtimer_start(sktimer);
+    fastq_decompress_extract(decompressor.outfp, reader, firstentry,
+        endentry);
+    if (logfp != NULL) {
+      fprintf(logfp, "# TIME extract %lu entries %.4f\n",
+          endentry - firstentry, gt_SKtimer_elapsed(sktimer));
+    }
+    gt_SKtimer_delete(sktimer);
+  } else {
+    pthread_mutex_init(&decompressor.mutex, NULL);
+    pthread_cond_init(&decompressor.finished, NULL);
+    decompressor.windowsize = FASTQ_DECOMPRESS_JOBSPERTHREAD * numofthreads;
+    decompressor.window = gt_calloc((size_t) decompressor.windowsize,
+        sizeof *decompressor.window);
+    decompressor.nextread = decompressor.nextwrite = 0;
+    decompressor.memory = decompressor.peakmemory = 0;
+
+    pool = threadpool_new(numofthreads);
+    fastq_decompress(&decompressor, reader, pool);
+    threadpool_delete(pool);
+
+    if (logfp != NULL) {
+      fprintf(logfp, "# %lu blocks decoded with %lu threads, peak memory of "
+          "blocks in flight %lu bytes (limit %lu)\n", decompressor.nextread,
+          numofthreads, decompressor.peakmemory, decompressor.memorylimit);
+    }
+
+    pthread_cond_destroy(&decompressor.finished);
+    pthread_mutex_destroy(&decompressor.mutex);
+    gt_free(decompressor.window);
+  }
+  fastq_archive_reader_delete(reader);
+  if (fflush(decompressor.outfp) != 0) {
+    fprintf(stderr, "Can not write the decoded entries\n");
+    exit(EXIT_FAILURE);
+  }
+  if (decompressor.outfp != stdout) {
+    fclose(decompressor.outfp);
+  }
+  if (infp != stdin) {
+    fclose(infp);
+  }
+
+  exit(EXIT_SUCCESS);
+}
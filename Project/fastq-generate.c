@@ -0,0 +1,299 @@
+/*
+ ============================================================================
+ Name        : fastq-generate.c
+ Description : Generate reproducible synthetic Fastq files for benchmarks
+ ============================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include "bwt-compress/gt-defs.h"
+#include "bwt-compress/gt-alloc.h"
+#include "fastq-concat/fastq-assert.h"
+
+#define FASTQ_GENERATE_OFFSET       33
+#define FASTQ_GENERATE_MAXQUAL      41
+/* number of reads remembered as candidates for duplicates */
+#define FASTQ_GENERATE_RECENT       1024UL
+
+typedef enum {
+  FASTQ_GENERATE_FLAT,
+  FASTQ_GENERATE_ILLUMINA,
+  FASTQ_GENERATE_BINNED
+} FastqGenerateProfile;
+
+/* The parameters of the generated reads */
+typedef struct {
+  unsigned long size, readlength, coverage, seed;
+  double errorrate, duplication;
+  FastqGenerateProfile profile;
+} FastqGenerateOptions;
+
+/**
+ * Pseudo random numbers by xorshift64*, the
+ * same seed delivers the same file on all
+ * platforms
+ */
+static unsigned long fastq_generate_random(unsigned long *state) {
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return (*state * 2685821657736338717UL) >> 11;
+}
+
+/**
+ * A pseudo random number in the
+ * interval [0,1)
+ */
+static double fastq_generate_uniform(unsigned long *state) {
+  return fastq_generate_random(state) / 9007199254740992.0;
+}
+
+/**
+ * Parse a size with an optional
+ * suffix K, M or G
+ */
+static unsigned long fastq_generate_parsesize(const char *arg) {
+  char * end = NULL;
+  unsigned long size = strtoul(arg, &end, 10);
+
+  switch (*end) {
+  case 'G':
+    size <<= 10;
+    /* fall through */
+  case 'M':
+    size <<= 10;
+    /* fall through */
+  case 'K':
+    size <<= 10;
+    end++;
+    break;
+  }
+  if (end == arg || *end != '\0' || size == 0) {
+    fprintf(stderr, "Illegal size %s\n", arg);
+    exit(EXIT_FAILURE);
+  }
+  return size;
+}
+
+/**
+ * Parse a rate in the
+ * interval [0,1]
+ */
+static double fastq_generate_parserate(const char *arg, const char *what) {
+  char * end = NULL;
+  const double rate = strtod(arg, &end);
+
+  if (end == arg || *end != '\0' || rate < 0.0 || rate > 1.0) {
+    fprintf(stderr, "Illegal %s %s, must be in the range 0..1\n", what, arg);
+    exit(EXIT_FAILURE);
+  }
+  return rate;
+}
+
+/**
+ * The quality value of position <pos> of a read
+ * of length <readlength>: uniform for the flat
+ * profile, otherwise decreasing towards the end
+ * of the read with occasional drops, reduced to
+ * the bins of illumina8 for the binned profile
+ */
+static int fastq_generate_quality(const FastqGenerateOptions *options,
+    unsigned long pos, unsigned long *state) {
+
+  static const int bins[][2] = { { 2, 6 }, { 10, 15 }, { 20, 22 },
+      { 25, 27 }, { 30, 33 }, { 35, 37 }, { 40, 40 } };
+  unsigned long bin;
+  int qual;
+
+  if (options->profile == FASTQ_GENERATE_FLAT) {
+    return 2 + (int) (fastq_generate_random(state)
+        % (FASTQ_GENERATE_MAXQUAL - 1));
+  }
+  qual = 38 - (int) (13 * pos / options->readlength)
+      + (int) (fastq_generate_random(state) % 7) - 3;
+  if (fastq_generate_uniform(state) < 0.02) {
+    qual = 2 + (int) (fastq_generate_random(state) % 10);
+  }
+  qual = qual < 2 ? 2 : (qual > FASTQ_GENERATE_MAXQUAL
+      ? FASTQ_GENERATE_MAXQUAL : qual);
+  if (options->profile == FASTQ_GENERATE_BINNED) {
+    for (bin = 0; bin + 1 < sizeof bins / sizeof bins[0]
+        && qual >= bins[bin + 1][0]; bin++) {
+      /* Nothing */
+    }
+    qual = bins[bin][1];
+  }
+  return qual;
+}
+
+/**
+ * Write reads sampled from a random genome to <fp> until
+ * at least options->size bytes are written. A read is a
+ * duplicate of a recent read with the given probability,
+ * it is reverse complemented with probability 1/2 and
+ * each base is substituted with the error rate
+ */
+static void fastq_generate(FILE *fp, const FastqGenerateOptions *options) {
+  const char * bases = "ACGT";
+  const unsigned long readlength = options->readlength;
+  /* the bytes of a read in the Fastq format, about 40 for the header */
+  const unsigned long numofreads = options->size / (2 * readlength + 44) + 1,
+      genomelength = numofreads * readlength / options->coverage
+          + readlength;
+  unsigned long state = options->seed * 2 + 1, recent[FASTQ_GENERATE_RECENT];
+  unsigned long idx, written = 0, numofrecent = 0;
+  GtUchar * genome = gt_malloc((size_t) genomelength);
+  char * seq = gt_malloc((size_t) readlength + 1),
+      * qual = gt_malloc((size_t) readlength + 1);
+
+  for (idx = 0; idx < 16; idx++) {
+    (void) fastq_generate_random(&state);
+  }
+  for (idx = 0; idx < genomelength; idx++) {
+    genome[idx] = (GtUchar) (fastq_generate_random(&state) & 3);
+  }
+  seq[readlength] = qual[readlength] = '\0';
+  for (idx = 0; written < options->size; idx++) {
+    unsigned long start, pos;
+    bool reverse;
+    int length;
+
+    if (numofrecent > 0
+        && fastq_generate_uniform(&state) < options->duplication) {
+      start = recent[fastq_generate_random(&state)
+          % (numofrecent < FASTQ_GENERATE_RECENT
+              ? numofrecent : FASTQ_GENERATE_RECENT)];
+    } else {
+      start = fastq_generate_random(&state)
+          % (genomelength - readlength + 1) * 2
+          + (fastq_generate_random(&state) & 1);
+      recent[numofrecent++ % FASTQ_GENERATE_RECENT] = start;
+    }
+    reverse = (start & 1) != 0;
+    start >>= 1;
+    for (pos = 0; pos < readlength; pos++) {
+      /* the complement of a base is 3 - base */
+      unsigned long base = reverse
+          ? 3UL - genome[start + readlength - 1 - pos] : genome[start + pos];
+
+      if (fastq_generate_uniform(&state) < options->errorrate) {
+        base = (base + 1 + fastq_generate_random(&state) % 3) & 3;
+      }
+      seq[pos] = bases[base];
+      qual[pos] = (char) (FASTQ_GENERATE_OFFSET
+          + fastq_generate_quality(options, pos, &state));
+      /* bases of the lowest quality are not called */
+      if (qual[pos] == FASTQ_GENERATE_OFFSET + 2
+          && fastq_generate_uniform(&state) < 0.5) {
+        seq[pos] = 'N';
+      }
+    }
+    length = fprintf(fp, "@synthetic.%lu %lu%c length=%lu\n%s\n+\n%s\n",
+        idx, start, reverse ? '-' : '+', readlength, seq, qual);
+    if (length < 0) {
+      fprintf(stderr, "Can not write the reads\n");
+      exit(EXIT_FAILURE);
+    }
+    written += (unsigned long) length;
+  }
+  gt_free(genome);
+  gt_free(seq);
+  gt_free(qual);
+}
+
+static void fastq_generate_usage(const char *progname) {
+  fprintf(stderr, "Usage: %s [-s <size>[K|M|G]] [-l <readlength>] "
+      "[-e <errorrate>] [-d <duplication>] [-c <coverage>] "
+      "[-p flat|illumina|binned] [-r <seed>] [-o <outfile>]\n", progname);
+  fprintf(stderr, "-s sets the size of the file in bytes (default 10M)\n");
+  fprintf(stderr, "-e sets the rate of substituted bases, -d the rate of "
+      "reads duplicating a recent read\n");
+  fprintf(stderr, "-c sets the coverage of the random genome the reads are "
+      "sampled from\n");
+  fprintf(stderr, "-p sets the profile of the quality values, binned uses the "
+      "bins of illumina8\n");
+  fprintf(stderr, "-r sets the seed, the same options deliver the same "
+      "file\n");
+}
+
+int main(int argc, char * argv[]) {
+
+  FILE * outfp = stdout;
+  FastqGenerateOptions options;
+  int opt;
+
+  options.size = 10UL << 20;
+  options.readlength = 100;
+  options.coverage = 30;
+  options.seed = 1;
+  options.errorrate = 0.001;
+  options.duplication = 0.05;
+  options.profile = FASTQ_GENERATE_ILLUMINA;
+  while ((opt = getopt(argc, argv, "c:d:e:l:o:p:r:s:")) != -1) {
+    switch (opt) {
+    case 'c':
+    case 'l':
+    case 'r':
+      {
+        char * end = NULL;
+        const unsigned long value = strtoul(optarg, &end, 10);
+
+        if (end == optarg || *end != '\0' || (value == 0 && opt != 'r')) {
+          fprintf(stderr, "Illegal %s %s\n", opt == 'c' ? "coverage"
+              : (opt == 'l' ? "read length" : "seed"), optarg);
+          exit(EXIT_FAILURE);
+        }
+        if (opt == 'c') {
+          options.coverage = value;
+        } else if (opt == 'l') {
+          options.readlength = value;
+        } else {
+          options.seed = value;
+        }
+      }
+      break;
+    case 'd':
+      options.duplication = fastq_generate_parserate(optarg, "duplication");
+      break;
+    case 'e':
+      options.errorrate = fastq_generate_parserate(optarg, "error rate");
+      break;
+    case 'o':
+      fopen_or_exit(outfp, optarg, "w");
+      break;
+    case 'p':
+      if (strcmp(optarg, "flat") == 0) {
+        options.profile = FASTQ_GENERATE_FLAT;
+      } else if (strcmp(optarg, "illumina") == 0) {
+        options.profile = FASTQ_GENERATE_ILLUMINA;
+      } else if (strcmp(optarg, "binned") == 0) {
+        options.profile = FASTQ_GENERATE_BINNED;
+      } else {
+        fprintf(stderr, "Unknown profile %s\n", optarg);
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 's':
+      options.size = fastq_generate_parsesize(optarg);
+      break;
+    default:
+      fastq_generate_usage(argv[0]);
+      exit(EXIT_FAILURE);
+    }
+  }
+  if (optind != argc) {
+    fastq_generate_usage(argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  fastq_generate(outfp, &options);
+  if (outfp != stdout && fclose(outfp) != 0) {
+    fprintf(stderr, "Can not write the reads\n");
+    exit(EXIT_FAILURE);
+  }
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,426 @@
+/*
+ ============================================================================
+ Name        : sain-bench.c
+ Description : Time the suffix sorting methods on a fixed corpus
+ ============================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "bwt-compress/gt-defs.h"
+#include "bwt-compress/gt-alloc.h"
+#include "bwt-compress/sk-sain.h"
+#include "fastq-concat/fastq-assert.h"
+
+#define SAIN_BENCH_DEFAULTLENGTH (4UL << 20)
+/* length of the unit of the repetitive text */
+#define SAIN_BENCH_UNITLENGTH    1000UL
+
+/* A text of the corpus, with its 2-bit encoding if
+ it only consists of A, C, G and T */
+typedef struct {
+  const char * name;
+  GtUchar * text;
+  GtTwobitencoding * twobitseq;
+  unsigned long length;
+} SainBenchInput;
+
+/* A method of suffix sorting, with or without huge pages for the
+ suffix array, of the text or of its 2-bit encoding */
+typedef struct {
+  const char * name;
+  GtSainMethod method;
+  bool hugepages, twobit;
+} SainBenchVariant;
+
+static const SainBenchVariant sain_bench_variants[] = {
+  { "decide", GT_SAIN_METHOD_DECIDE, true, false },
+  { "fast", GT_SAIN_METHOD_FAST, true, false },
+  { "space", GT_SAIN_METHOD_SPACE, true, false },
+  { "decide-smallpages", GT_SAIN_METHOD_DECIDE, false, false },
+  { "twobit", GT_SAIN_METHOD_DECIDE, true, true }
+};
+
+#define SAIN_BENCH_NUMOFVARIANTS\
+        (sizeof sain_bench_variants / sizeof sain_bench_variants[0])
+
+/* The hardware events counted during the sorting */
+static const struct {
+  const char * name;
+  unsigned int type;
+  unsigned long config;
+} sain_bench_events[] = {
+  { "cachereferences", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+  { "cachemisses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+  { "l1dmisses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+      | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+      | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+  { "dtlbmisses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB
+      | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+      | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) }
+};
+
+#define SAIN_BENCH_NUMOFEVENTS\
+        (sizeof sain_bench_events / sizeof sain_bench_events[0])
+
+/**
+ * Pseudo random numbers by xorshift64*,
+ * the corpus is the same in each run
+ */
+static unsigned long sain_bench_random(unsigned long *state) {
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return (*state * 2685821657736338717UL) >> 11;
+}
+
+/**
+ * Generate the text <name> of the corpus
+ * of the given <length>: dna, quality,
+ * repetitive or random
+ */
+static GtUchar *sain_bench_generate(const char *name, unsigned long length) {
+  GtUchar * text = gt_malloc((size_t) length + 1);
+  unsigned long idx, state = 0x9e3779b97f4a7c15UL;
+
+  if (strcmp(name, "dna") == 0) {
+    /* reads of 100 bases sampled from a genome with 10-fold coverage */
+    const unsigned long genomelength = length / 10 + 100;
+    GtUchar * genome = gt_malloc((size_t) genomelength);
+
+    for (idx = 0; idx < genomelength; idx++) {
+      genome[idx] = (GtUchar) "ACGT"[sain_bench_random(&state) & 3];
+    }
+    for (idx = 0; idx < length; idx += 100) {
+      const unsigned long start = sain_bench_random(&state)
+          % (genomelength - 100);
+
+      memcpy(text + idx, genome + start,
+          (size_t) (length - idx < 100 ? length - idx : 100));
+    }
+    gt_free(genome);
+  } else if (strcmp(name, "quality") == 0) {
+    /* quality values decreasing along reads of length 100 */
+    for (idx = 0; idx < length; idx++) {
+      const long qual = 38 - (long) (13 * (idx % 100) / 100)
+          + (long) (sain_bench_random(&state) % 7) - 3;
+
+      text[idx] = (GtUchar) (33 + (qual < 2 ? 2 : qual));
+    }
+  } else if (strcmp(name, "repetitive") == 0) {
+    /* copies of a random unit with a mutation per 10000 characters */
+    for (idx = 0; idx < length; idx++) {
+      text[idx] = idx < SAIN_BENCH_UNITLENGTH
+          ? (GtUchar) "ACGT"[sain_bench_random(&state) & 3]
+          : text[idx - SAIN_BENCH_UNITLENGTH];
+      if (idx >= SAIN_BENCH_UNITLENGTH
+          && sain_bench_random(&state) % 10000 == 0) {
+        text[idx] = (GtUchar) "ACGT"[sain_bench_random(&state) & 3];
+      }
+    }
+  } else {
+    for (idx = 0; idx < length; idx++) {
+      text[idx] = (GtUchar) sain_bench_random(&state);
+    }
+  }
+  return text;
+}
+
+/**
+ * Read the file <filename>
+ * completely
+ */
+static GtUchar *sain_bench_read(const char *filename, unsigned long *length) {
+  FILE * fp = NULL;
+  GtUchar * text = NULL;
+  long size;
+
+  fopen_or_exit(fp, filename, "rb");
+  if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) <= 0
+      || fseek(fp, 0, SEEK_SET) != 0) {
+    fprintf(stderr, "Can not determine the size of %s\n", filename);
+    exit(EXIT_FAILURE);
+  }
+  text = gt_malloc((size_t) size + 1);
+  if (fread(text, 1, (size_t) size, fp) != (size_t) size) {
+    fprintf(stderr, "Can not read %s\n", filename);
+    exit(EXIT_FAILURE);
+  }
+  fclose(fp);
+  *length = (unsigned long) size;
+  return text;
+}
+
+/**
+ * Check in linear time that <sa> is the suffix array of <text>,
+ * the suffix at <length> is the largest one. Two neighbours are
+ * in order if their first characters are or if they have the
+ * same first character and the suffixes following them are in
+ * order, i.e. by the ranks of the inverse suffix array
+ */
+static bool sain_bench_check(const GtUchar *text, unsigned long length,
+    const Uint *sa) {
+
+  Uint * rank = gt_malloc((size_t) (length + 1) * sizeof *rank);
+  unsigned long idx;
+  bool correct = sa[length] == length;
+
+  for (idx = 0; idx <= length; idx++) {
+    rank[idx] = (Uint) (length + 1);
+  }
+  for (idx = 0; correct && idx <= length; idx++) {
+    correct = sa[idx] <= length && rank[sa[idx]] == (Uint) (length + 1);
+    if (correct) {
+      rank[sa[idx]] = (Uint) idx;
+    }
+  }
+  for (idx = 0; correct && idx + 1 < length; idx++) {
+    const Uint first = sa[idx], second = sa[idx + 1];
+
+    correct = text[first] < text[second]
+        || (text[first] == text[second]
+            && rank[first + 1] < rank[second + 1]);
+  }
+  gt_free(rank);
+  return correct;
+}
+
+/**
+ * The bytes of the process in transparent
+ * huge pages, -1 if they are not reported
+ */
+static long sain_bench_hugepagebytes(void) {
+  FILE * fp = fopen("/proc/self/smaps_rollup", "r");
+  char line[256];
+  long kilobytes = -1;
+
+  if (fp == NULL) {
+    return -1;
+  }
+  while (fgets(line, (int) sizeof line, fp) != NULL) {
+    if (sscanf(line, "AnonHugePages: %ld kB", &kilobytes) == 1) {
+      break;
+    }
+  }
+  fclose(fp);
+  return kilobytes < 0 ? -1 : kilobytes * 1024;
+}
+
+/**
+ * Open the counter of the event <event> for the current
+ * thread, returns -1 if the counter is not available,
+ * e.g. due to the setting of perf_event_paranoid
+ */
+static int sain_bench_counter(unsigned long event) {
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof attr);
+  attr.size = sizeof attr;
+  attr.type = sain_bench_events[event].type;
+  attr.config = sain_bench_events[event].config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/**
+ * Sort the suffixes of <input> with <variant> in a child
+ * process, whose peak resident set size only depends on
+ * the sorting, and show the best time of <repeat> runs,
+ * the peak memory, the hardware events of the last run
+ * and the result of the check. Returns false if the
+ * check fails
+ */
+static bool sain_bench_run(const SainBenchInput *input,
+    const SainBenchVariant *variant, unsigned long repeat) {
+
+  pid_t pid;
+  int status;
+
+  fflush(stdout);
+  pid = fork();
+  if (pid < 0) {
+    fprintf(stderr, "Can not fork the benchmark\n");
+    exit(EXIT_FAILURE);
+  }
+  if (pid == 0) {
+    int counters[SAIN_BENCH_NUMOFEVENTS];
+    long long values[SAIN_BENCH_NUMOFEVENTS];
+    struct rusage usage;
+    long baseline;
+    double best = 0.0;
+    unsigned long run, event;
+    long hugepagebytes;
+    Uint * sa = NULL;
+    bool correct;
+
+    gt_alloc_hugepages(variant->hugepages);
+    for (event = 0; event < SAIN_BENCH_NUMOFEVENTS; event++) {
+      counters[event] = sain_bench_counter(event);
+      values[event] = -1;
+    }
+    (void) getrusage(RUSAGE_SELF, &usage);
+    baseline = usage.ru_maxrss;
+    for (run = 0; run < repeat; run++) {
+      struct timespec start, end;
+      double seconds;
+
+      gt_free(sa);
+      for (event = 0; event < SAIN_BENCH_NUMOFEVENTS; event++) {
+        if (counters[event] >= 0) {
+          (void) ioctl(counters[event], PERF_EVENT_IOC_RESET, 0);
+          (void) ioctl(counters[event], PERF_EVENT_IOC_ENABLE, 0);
+        }
+      }
+      (void) clock_gettime(CLOCK_MONOTONIC, &start);
+      sa = variant->twobit
+          ? gt_sain_twobit_sorted_suffixes_new(input->twobitseq,
+              input->length, variant->method)
+          : gt_sain_sorted_suffixes_method_new(input->text, input->length,
+              UCHAR_MAX + 1, variant->method);
+      (void) clock_gettime(CLOCK_MONOTONIC, &end);
+      for (event = 0; event < SAIN_BENCH_NUMOFEVENTS; event++) {
+        if (counters[event] >= 0) {
+          (void) ioctl(counters[event], PERF_EVENT_IOC_DISABLE, 0);
+          if (read(counters[event], values + event, sizeof values[event])
+              != (ssize_t) sizeof values[event]) {
+            values[event] = -1;
+          }
+        }
+      }
+      seconds = end.tv_sec - start.tv_sec
+          + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+      if (run == 0 || seconds < best) {
+        best = seconds;
+      }
+    }
+    (void) getrusage(RUSAGE_SELF, &usage);
+    hugepagebytes = sain_bench_hugepagebytes();
+    correct = sain_bench_check(input->text, input->length, sa);
+    gt_free(sa);
+
+    /* Linux reports the peak in kilobytes */
+    printf("%s,%s,%lu,%.2f,%.2f", input->name, variant->name, input->length,
+        best * 1000000000.0 / input->length,
+        (usage.ru_maxrss - baseline) * 1024.0 / input->length);
+    for (event = 0; event < SAIN_BENCH_NUMOFEVENTS; event++) {
+      if (values[event] >= 0) {
+        printf(",%.4f", (double) values[event] / input->length);
+      } else {
+        printf(",NA");
+      }
+    }
+    if (hugepagebytes >= 0) {
+      printf(",%ld", hugepagebytes);
+    } else {
+      printf(",NA");
+    }
+    printf(",%s\n", correct ? "ok" : "FAILED");
+    fflush(stdout);
+    _exit(correct ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+  if (waitpid(pid, &status, 0) != pid) {
+    fprintf(stderr, "Can not wait for the benchmark\n");
+    exit(EXIT_FAILURE);
+  }
+  return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+}
+
+static void sain_bench_usage(const char *progname) {
+  fprintf(stderr, "Usage: %s [-n <length>] [-r <repeat>] [<file> ...]\n",
+      progname);
+  fprintf(stderr, "sorts the suffixes of the generated texts dna, quality, "
+      "repetitive and random of\n<length> characters (default %lu) or of "
+      "the given files with each method\n", SAIN_BENCH_DEFAULTLENGTH);
+  fprintf(stderr, "-r sets the number of runs, the best time is shown\n");
+  fprintf(stderr, "the variant twobit sorts the 2-bit encoding of the "
+      "texts over A, C, G and T\n");
+}
+
+int main(int argc, char * argv[]) {
+
+  static const char *corpus[] = { "dna", "quality", "repetitive", "random" };
+  unsigned long length = SAIN_BENCH_DEFAULTLENGTH, repeat = 3;
+  unsigned long numofinputs, idx, variant, event;
+  SainBenchInput * inputs = NULL;
+  bool correct = true;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:r:")) != -1) {
+    switch (opt) {
+    case 'n':
+    case 'r':
+      {
+        char * end = NULL;
+        const unsigned long value = strtoul(optarg, &end, 10);
+
+        if (end == optarg || *end != '\0' || value == 0
+            || (opt == 'n' && value >= (unsigned long) GT_FIRSTTWOBITS)) {
+          fprintf(stderr, "Illegal %s %s\n", opt == 'n' ? "length"
+              : "number of runs", optarg);
+          exit(EXIT_FAILURE);
+        }
+        if (opt == 'n') {
+          length = value;
+        } else {
+          repeat = value;
+        }
+      }
+      break;
+    default:
+      sain_bench_usage(argv[0]);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  numofinputs = optind < argc ? (unsigned long) (argc - optind)
+      : sizeof corpus / sizeof corpus[0];
+  inputs = gt_malloc((size_t) numofinputs * sizeof *inputs);
+  for (idx = 0; idx < numofinputs; idx++) {
+    if (optind < argc) {
+      inputs[idx].name = argv[optind + idx];
+      inputs[idx].text = sain_bench_read(inputs[idx].name,
+          &inputs[idx].length);
+    } else {
+      inputs[idx].name = corpus[idx];
+      inputs[idx].length = length;
+      inputs[idx].text = sain_bench_generate(corpus[idx], length);
+    }
+    inputs[idx].twobitseq = gt_sain_twobitencoding_new(inputs[idx].text,
+        inputs[idx].length);
+  }
+
+  printf("input,variant,length,nsperchar,peakbytesperchar");
+  for (event = 0; event < SAIN_BENCH_NUMOFEVENTS; event++) {
+    printf(",%sperchar", sain_bench_events[event].name);
+  }
+  printf(",hugepagebytes,check\n");
+  for (idx = 0; idx < numofinputs; idx++) {
+    for (variant = 0; variant < SAIN_BENCH_NUMOFVARIANTS; variant++) {
+      if (sain_bench_variants[variant].twobit
+          && inputs[idx].twobitseq == NULL) {
+        continue;
+      }
+      if (!sain_bench_run(inputs + idx, sain_bench_variants + variant,
+          repeat)) {
+        correct = false;
+      }
+    }
+    gt_free(inputs[idx].twobitseq);
+    gt_free(inputs[idx].text);
+  }
+  gt_free(inputs);
+  exit(correct ? EXIT_SUCCESS : EXIT_FAILURE);
+}